@@ -0,0 +1,321 @@
+#include "AudioAnalyzer.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+namespace
+{
+
+//the queue between write() and the analysis thread, enough for about a second of 48 kHz stereo
+const qint64 ciBufferSize = 256 * 1024;
+
+//buffers are queued in chunks of at most this size, in bytes
+const int ciMaxChunk = 16 * 1024;
+
+//the number of samples per spectrum, about 12 ms at 44.1 kHz
+const int ciSpectrumSize = 512;
+
+//the number of measurements per second
+const int ciSpectraPerSecond = 30;
+
+//the lowest level reported, in dB
+const double cdFloor = -90.0;
+
+//the lower edge of the first spectrum band, in Hz
+const double cdLowestBand = 60.0;
+
+//the upper edge of the last spectrum band, in Hz
+const double cdHighestBand = 16000.0;
+
+//the interval the load is measured over, in milliseconds
+const qint64 ciLoadInterval = 1000;
+
+/**
+ * @brief Decibel Convert a power ratio to decibel
+ * @param power The power ratio
+ * @return The ratio in dB, not below cdFloor
+ */
+double Decibel(double power)
+{
+	return (0.0 < power) ? qMax(cdFloor, 10.0 * std::log10(power)) : cdFloor;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+AudioAnalyzer::AudioAnalyzer(QObject* parent)
+	: QThread(parent)
+	, m_Buffer(ciBufferSize)
+	, m_Wakeup()
+	, m_bWaiting(false)
+	, m_bStopped(false)
+	, m_uDropped(0)
+	, m_Header()
+	, m_baChunk(ciMaxChunk, '\0')
+	, m_Mono(ciMaxChunk / static_cast<int>(sizeof(qint16)))
+	, m_History(ciSpectrumSize)
+	, m_iHistoryPosition(0)
+	, m_Frame(ciSpectrumSize)
+	, m_Power(ciSpectrumSize / 2)
+	, m_Spectrum(ciSpectrumSize)
+	, m_iSampleRate(0)
+	, m_BandLimits()
+	, m_iUntilSpectrum(0)
+	, m_dSumOfSquares(0.0)
+	, m_dPeak(0.0)
+	, m_iSamples(0)
+	, m_Mutex()
+	, m_Levels()
+	, m_dLoad(0.0)
+{
+	setObjectName("AudioAnalyzer");
+	start(QThread::LowPriority);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+AudioAnalyzer::~AudioAnalyzer()
+{
+	m_bStopped = true;
+	m_Wakeup.release();
+
+	wait();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+AudioAnalyzer::Levels AudioAnalyzer::levels() const
+{
+	QMutexLocker lock(&m_Mutex);
+	return m_Levels;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+double AudioAnalyzer::load() const
+{
+	QMutexLocker lock(&m_Mutex);
+	return m_dLoad;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 AudioAnalyzer::dropped() const
+{
+	return m_uDropped;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void AudioAnalyzer::write(const QAudioBuffer &buffer)
+{
+	const auto format = buffer.format();
+
+	const auto isFloat = (QAudioFormat::Float == format.sampleType()) && (32 == format.sampleSize());
+	const auto isInteger = (QAudioFormat::SignedInt == format.sampleType()) && (16 == format.sampleSize());
+
+	if(((false == isFloat) && (false == isInteger)) || (0 >= format.channelCount()) || (0 >= format.sampleRate())) return;
+
+	const auto frameSize = format.channelCount() * format.sampleSize() / 8;
+	if(ciMaxChunk < frameSize) return;
+
+	ChunkHeader header;
+	header.m_iChannels = static_cast<qint16>(format.channelCount());
+	header.m_iFloat = (true == isFloat) ? 1 : 0;
+	header.m_iSampleRate = format.sampleRate();
+
+	const auto data = static_cast<const char*>(buffer.constData());
+	const auto bytes = buffer.byteCount() - (buffer.byteCount() % frameSize);
+
+	for(auto offset = 0; offset < bytes; offset += header.m_iBytes)
+	{
+		header.m_iBytes = qMin(bytes - offset, ciMaxChunk - (ciMaxChunk % frameSize));
+
+		//the header is only written together with its samples
+		if(m_Buffer.free() < static_cast<qint64>(sizeof(header)) + header.m_iBytes)
+		{
+			++m_uDropped;
+			break;
+		}
+
+		m_Buffer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		m_Buffer.write(data + offset, header.m_iBytes);
+	}
+
+	if(true == m_bWaiting.exchange(false)) m_Wakeup.release();
+
+	emit audioQueued();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void AudioAnalyzer::run()
+{
+	QElapsedTimer window;
+	window.start();
+
+	qint64 busy = 0;
+	auto load = 0.0;
+
+	while(false == m_bStopped)
+	{
+		busy += process();
+
+		const auto elapsed = window.nsecsElapsed();
+		if(ciLoadInterval * 1000000 <= elapsed)
+		{
+			load = static_cast<double>(busy) / elapsed;
+			busy = 0;
+			window.restart();
+
+			QMutexLocker lock(&m_Mutex);
+			m_dLoad = load;
+		}
+
+		//write() releases the semaphore once it sees the flag, the buffer is checked again to not miss a write which came
+		//before the flag was set
+		m_bWaiting = true;
+		if((0 < m_Buffer.size()) && (true == m_bWaiting.exchange(false))) continue;
+
+		if((0 == busy) && (0.0 == load))
+		{
+			//nothing is playing, sleep until audio arrives
+			m_Wakeup.acquire();
+			window.restart();
+		}
+		else if(false == m_Wakeup.tryAcquire(1, static_cast<int>(qMax(0ll, ciLoadInterval - window.elapsed()))))
+		{
+			//woken to update the load, a release of write() racing with the timeout only causes another pass
+			m_bWaiting = false;
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 AudioAnalyzer::process()
+{
+	QElapsedTimer clock;
+	clock.start();
+
+	while(true)
+	{
+		if(0 == m_Header.m_iBytes)
+		{
+			if(static_cast<qint64>(sizeof(m_Header)) > m_Buffer.size()) break;
+			m_Buffer.read(reinterpret_cast<char*>(&m_Header), sizeof(m_Header));
+		}
+
+		//write() adds the samples right after the header
+		if(m_Header.m_iBytes > m_Buffer.size()) break;
+		m_Buffer.read(m_baChunk.data(), m_Header.m_iBytes);
+
+		if(0 != m_Header.m_iFloat)
+		{
+			const auto frames = m_Header.m_iBytes / (m_Header.m_iChannels * static_cast<int>(sizeof(float)));
+			AudioKernels::mixDown(reinterpret_cast<const float*>(m_baChunk.constData()), m_Header.m_iChannels, frames,
+														m_Mono.data());
+			analyze(m_Mono.constData(), frames, m_Header.m_iSampleRate);
+		}
+		else
+		{
+			const auto frames = m_Header.m_iBytes / (m_Header.m_iChannels * static_cast<int>(sizeof(qint16)));
+			AudioKernels::mixDown(reinterpret_cast<const qint16*>(m_baChunk.constData()), m_Header.m_iChannels, frames,
+														m_Mono.data());
+			analyze(m_Mono.constData(), frames, m_Header.m_iSampleRate);
+		}
+
+		m_Header = ChunkHeader();
+	}
+
+	return clock.nsecsElapsed();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void AudioAnalyzer::analyze(const float* samples, int count, int sampleRate)
+{
+	if(sampleRate != m_iSampleRate)
+	{
+		m_iSampleRate = sampleRate;
+		m_iUntilSpectrum = qMax(1, sampleRate / ciSpectraPerSecond);
+
+		const auto bins = ciSpectrumSize / 2;
+		const auto binWidth = static_cast<double>(sampleRate) / ciSpectrumSize;
+
+		//each band is at least one bin wide, bands above the nyquist frequency stay empty
+		for(auto band = 0; band <= BandCount; ++band)
+		{
+			const auto edge = cdLowestBand * std::pow(cdHighestBand / cdLowestBand, static_cast<double>(band) / BandCount);
+			auto bin = qMax(1, static_cast<int>(std::lround(edge / binWidth)));
+			if(0 < band) bin = qMax(bin, m_BandLimits[band - 1] + 1);
+
+			m_BandLimits[band] = qMin(bin, bins);
+		}
+	}
+
+	while(0 < count)
+	{
+		const auto length = qMin(count, m_iUntilSpectrum);
+
+		auto sumOfSquares = 0.0f;
+		auto peak = 0.0f;
+		AudioKernels::levels(samples, length, sumOfSquares, peak);
+
+		m_dSumOfSquares += sumOfSquares;
+		m_dPeak = qMax(m_dPeak, static_cast<double>(peak));
+		m_iSamples += length;
+
+		//only the most recent samples are kept for the spectrum
+		const auto keep = qMin(length, ciSpectrumSize);
+		auto source = samples + length - keep;
+		auto remaining = keep;
+
+		while(0 < remaining)
+		{
+			const auto part = qMin(remaining, ciSpectrumSize - m_iHistoryPosition);
+			std::memcpy(m_History.data() + m_iHistoryPosition, source, sizeof(float) * static_cast<size_t>(part));
+
+			m_iHistoryPosition = (m_iHistoryPosition + part) % ciSpectrumSize;
+			source += part;
+			remaining -= part;
+		}
+
+		samples += length;
+		count -= length;
+		m_iUntilSpectrum -= length;
+
+		if(0 == m_iUntilSpectrum)
+		{
+			publish();
+			m_iUntilSpectrum = qMax(1, m_iSampleRate / ciSpectraPerSecond);
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void AudioAnalyzer::publish()
+{
+	//the oldest sample is at the write position
+	const auto older = ciSpectrumSize - m_iHistoryPosition;
+	std::memcpy(m_Frame.data(), m_History.constData() + m_iHistoryPosition, sizeof(float) * static_cast<size_t>(older));
+	std::memcpy(m_Frame.data() + older, m_History.constData(), sizeof(float) * static_cast<size_t>(m_iHistoryPosition));
+
+	m_Spectrum.power(m_Frame.constData(), m_Power.data());
+
+	Levels levels;
+	levels.m_dRms = (0 < m_iSamples) ? Decibel(m_dSumOfSquares / m_iSamples) : cdFloor;
+	levels.m_dPeak = Decibel(m_dPeak * m_dPeak);
+
+	for(auto band = 0; band < BandCount; ++band)
+	{
+		auto power = 0.0;
+		for(auto bin = m_BandLimits[band]; bin < m_BandLimits[band + 1]; ++bin) power += m_Power.at(bin);
+
+		levels.m_Bands[band] = Decibel(power);
+	}
+
+	m_dSumOfSquares = 0.0;
+	m_dPeak = 0.0;
+	m_iSamples = 0;
+
+	QMutexLocker lock(&m_Mutex);
+	levels.m_uUpdate = m_Levels.m_uUpdate + 1;
+	m_Levels = levels;
+}
+//----------------------------------------------------------------------------------------------------------------------
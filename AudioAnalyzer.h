@@ -0,0 +1,253 @@
+#pragma once
+
+#include <atomic>
+
+#include <QAudioBuffer>
+#include <QByteArray>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QVector>
+
+#include "AudioKernels.h"
+#include "RingBuffer.h"
+
+/**
+ * @brief The AudioAnalyzer class measures the level and the coarse spectrum of the decoded audio on its own thread
+ *
+ * The decoded buffers are copied into a lock-free ring buffer by write(), which is the only work done on the calling
+ * thread. The analysis thread mixes them down to mono, measures the level and computes a spectrum about 30 times per
+ * second. The results are read with levels().
+ *
+ * All buffers are allocated by the constructor, neither side allocates per audio buffer. Audio which does not fit into
+ * the ring buffer is dropped, the meter simply skips it.
+ */
+class AudioAnalyzer : public QThread
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief BandCount The number of spectrum bands, spaced logarithmically from 60 Hz to 16 kHz
+	 */
+	static const int BandCount = 16;
+
+	/**
+	 * @brief The Levels struct holds the most recent measurement
+	 */
+	struct Levels
+	{
+		//! The root mean square level in dBFS
+		double m_dRms = -90.0;
+
+		//! The peak level in dBFS
+		double m_dPeak = -90.0;
+
+		//! The power of each spectrum band in dB, a full scale sine results in 0 dB. Only valid once m_uUpdate is set.
+		double m_Bands[BandCount] = {};
+
+		//! Incremented with every measurement, so a reader can tell whether audio is still arriving
+		quint64 m_uUpdate = 0;
+	};
+
+	/**
+	 * @brief AudioAnalyzer Default constructor, the analysis thread is started
+	 * @param parent
+	 */
+	explicit AudioAnalyzer(QObject* parent = nullptr);
+
+	/**
+	 * @brief ~AudioAnalyzer Default destructor, the analysis thread is stopped
+	 */
+	virtual ~AudioAnalyzer();
+
+	/**
+	 * @brief levels The most recent measurement
+	 * @return The levels
+	 */
+	Levels levels() const;
+
+	/**
+	 * @brief load The time spent analyzing during the last second
+	 * @return The fraction of one core used by the analysis thread
+	 */
+	double load() const;
+
+	/**
+	 * @brief dropped The number of audio buffers skipped because the analysis fell behind
+	 * @return The number of buffers
+	 */
+	quint64 dropped() const;
+
+signals:
+
+	/**
+	 * @brief audioQueued Emitted by write() when audio was queued for analysis
+	 */
+	void audioQueued();
+
+public slots:
+
+	/**
+	 * @brief write Queue a decoded buffer for analysis, signed 16 bit and float samples are supported
+	 * @param buffer The buffer, e.g. from QAudioProbe::audioBufferProbed()
+	 */
+	void write(const QAudioBuffer &buffer);
+
+protected:
+
+	/**
+	 * @brief run Analyze the queued audio until the analyzer is destroyed
+	 */
+	void run() override;
+
+private:
+
+	/**
+	 * @brief The ChunkHeader struct precedes each chunk of audio in the ring buffer
+	 */
+	struct ChunkHeader
+	{
+		//! The number of bytes following the header
+		qint32 m_iBytes = 0;
+
+		//! The number of interleaved channels
+		qint16 m_iChannels = 0;
+
+		//! Non-zero if the samples are floats, signed 16 bit integers otherwise
+		qint16 m_iFloat = 0;
+
+		//! The sample rate in Hz
+		qint32 m_iSampleRate = 0;
+	};
+
+	/**
+	 * @brief process Analyze the queued chunks
+	 * @return The number of nanoseconds spent
+	 */
+	qint64 process();
+
+	/**
+	 * @brief analyze Measure a block of mono samples and publish the levels once a spectrum is due
+	 * @param samples The samples
+	 * @param count The number of samples
+	 * @param sampleRate The sample rate in Hz
+	 */
+	void analyze(const float* samples, int count, int sampleRate);
+
+	/**
+	 * @brief publish Compute the spectrum of the most recent samples and publish it with the levels
+	 */
+	void publish();
+
+	/**
+	 * @brief m_Buffer The queued chunks, written by write() and read by the analysis thread
+	 */
+	RingBuffer m_Buffer;
+
+	/**
+	 * @brief m_Wakeup Released by write() when the analysis thread is waiting for audio
+	 */
+	QSemaphore m_Wakeup;
+
+	/**
+	 * @brief m_bWaiting True while the analysis thread is waiting, so write() releases m_Wakeup once per wait
+	 */
+	std::atomic<bool> m_bWaiting;
+
+	/**
+	 * @brief m_bStopped Set by the destructor to end the analysis thread
+	 */
+	std::atomic<bool> m_bStopped;
+
+	/**
+	 * @brief m_uDropped The number of buffers skipped
+	 */
+	std::atomic<quint64> m_uDropped;
+
+	/**
+	 * @brief m_Header The header of the chunk being read, analysis thread only
+	 */
+	ChunkHeader m_Header;
+
+	/**
+	 * @brief m_baChunk The samples of the chunk being read, analysis thread only
+	 */
+	QByteArray m_baChunk;
+
+	/**
+	 * @brief m_Mono The chunk mixed down to mono, analysis thread only
+	 */
+	QVector<float> m_Mono;
+
+	/**
+	 * @brief m_History The most recent mono samples, the spectrum is computed from them. Analysis thread only.
+	 */
+	QVector<float> m_History;
+
+	/**
+	 * @brief m_iHistoryPosition Where the next sample is stored in m_History
+	 */
+	int m_iHistoryPosition;
+
+	/**
+	 * @brief m_Frame The samples of m_History in order, analysis thread only
+	 */
+	QVector<float> m_Frame;
+
+	/**
+	 * @brief m_Power The power spectrum of m_Frame, analysis thread only
+	 */
+	QVector<float> m_Power;
+
+	/**
+	 * @brief m_Spectrum Computes m_Power
+	 */
+	Spectrum m_Spectrum;
+
+	/**
+	 * @brief m_iSampleRate The sample rate the band limits were computed for
+	 */
+	int m_iSampleRate;
+
+	/**
+	 * @brief m_BandLimits The first bin of each band, the last entry ends the last band
+	 */
+	int m_BandLimits[BandCount + 1];
+
+	/**
+	 * @brief m_iUntilSpectrum The number of samples until the next spectrum is due
+	 */
+	int m_iUntilSpectrum;
+
+	/**
+	 * @brief m_dSumOfSquares The sum of the squared samples since the last spectrum
+	 */
+	double m_dSumOfSquares;
+
+	/**
+	 * @brief m_dPeak The peak sample since the last spectrum
+	 */
+	double m_dPeak;
+
+	/**
+	 * @brief m_iSamples The number of samples since the last spectrum
+	 */
+	int m_iSamples;
+
+	/**
+	 * @brief m_Mutex Guards m_Levels and m_dLoad
+	 */
+	mutable QMutex m_Mutex;
+
+	/**
+	 * @brief m_Levels The most recent measurement
+	 */
+	Levels m_Levels;
+
+	/**
+	 * @brief m_dLoad The fraction of one core used during the last second
+	 */
+	double m_dLoad;
+};
@@ -0,0 +1,392 @@
+#include "AudioKernels.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define RADIO_UI_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RADIO_UI_NEON
+#endif
+
+namespace
+{
+
+//scales a 16 bit sample to [-1, 1]
+const float cfSampleScale = 1.0f / 32768.0f;
+
+#if defined(RADIO_UI_SSE2)
+
+typedef __m128 Vector;
+
+inline Vector Load(const float* p) { return _mm_loadu_ps(p); }
+inline void Store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+inline Vector Splat(float f) { return _mm_set1_ps(f); }
+inline Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+inline Vector Sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+inline Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+inline Vector Max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+inline Vector Abs(Vector v) { return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF))); }
+
+#elif defined(RADIO_UI_NEON)
+
+typedef float32x4_t Vector;
+
+inline Vector Load(const float* p) { return vld1q_f32(p); }
+inline void Store(float* p, Vector v) { vst1q_f32(p, v); }
+inline Vector Splat(float f) { return vdupq_n_f32(f); }
+inline Vector Add(Vector a, Vector b) { return vaddq_f32(a, b); }
+inline Vector Sub(Vector a, Vector b) { return vsubq_f32(a, b); }
+inline Vector Mul(Vector a, Vector b) { return vmulq_f32(a, b); }
+inline Vector Max(Vector a, Vector b) { return vmaxq_f32(a, b); }
+inline Vector Abs(Vector v) { return vabsq_f32(v); }
+
+#endif
+
+#if defined(RADIO_UI_SSE2) || defined(RADIO_UI_NEON)
+#define RADIO_UI_SIMD
+
+/**
+ * @brief MixDownVectorized Convert mono or stereo 16 bit samples, four frames at a time
+ * @param input The interleaved samples
+ * @param channels 1 or 2
+ * @param frames The number of frames
+ * @param output Receives one sample per frame
+ * @return The number of frames converted, the rest is left to the scalar implementation
+ */
+int MixDownVectorized(const qint16* input, int channels, int frames, float* output)
+{
+	auto i = 0;
+
+#if defined(RADIO_UI_SSE2)
+	if(1 == channels)
+	{
+		const auto scale = Splat(cfSampleScale);
+
+		for(; i + 8 <= frames; i += 8)
+		{
+			const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+
+			//sign extend by moving each sample into the upper half of a 32 bit lane
+			const auto low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+			const auto high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+
+			Store(output + i, Mul(low, scale));
+			Store(output + i + 4, Mul(high, scale));
+		}
+	}
+	else if(2 == channels)
+	{
+		const auto scale = Splat(cfSampleScale * 0.5f);
+
+		for(; i + 4 <= frames; i += 4)
+		{
+			const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 2 * i));
+
+			const auto low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+			const auto high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+
+			//the even lanes are the left channel, the odd lanes the right channel
+			const auto left = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+			const auto right = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+
+			Store(output + i, Mul(Add(left, right), scale));
+		}
+	}
+#elif defined(RADIO_UI_NEON)
+	if(1 == channels)
+	{
+		const auto scale = Splat(cfSampleScale);
+
+		for(; i + 8 <= frames; i += 8)
+		{
+			const auto x = vld1q_s16(input + i);
+
+			Store(output + i, Mul(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+			Store(output + i + 4, Mul(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+		}
+	}
+	else if(2 == channels)
+	{
+		const auto scale = Splat(cfSampleScale * 0.5f);
+
+		for(; i + 8 <= frames; i += 8)
+		{
+			//the load splits the channels already
+			const auto x = vld2q_s16(input + 2 * i);
+
+			const auto low = vaddl_s16(vget_low_s16(x.val[0]), vget_low_s16(x.val[1]));
+			const auto high = vaddl_s16(vget_high_s16(x.val[0]), vget_high_s16(x.val[1]));
+
+			Store(output + i, Mul(vcvtq_f32_s32(low), scale));
+			Store(output + i + 4, Mul(vcvtq_f32_s32(high), scale));
+		}
+	}
+#endif
+
+	return i;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+#endif
+
+/**
+ * @brief MixDownScalar Convert 16 bit samples one frame at a time
+ * @param input The interleaved samples
+ * @param channels The number of channels
+ * @param first The first frame to convert
+ * @param frames The number of frames
+ * @param output Receives one sample per frame
+ */
+void MixDownScalar(const qint16* input, int channels, int first, int frames, float* output)
+{
+	const auto scale = cfSampleScale / channels;
+
+	for(auto i = first; i < frames; ++i)
+	{
+		auto sum = 0;
+		for(auto c = 0; c < channels; ++c) sum += input[i * channels + c];
+
+		output[i] = static_cast<float>(sum) * scale;
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+const char* AudioKernels::instructionSet()
+{
+#if defined(RADIO_UI_SSE2)
+	return "SSE2";
+#elif defined(RADIO_UI_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void AudioKernels::mixDown(const qint16* input, int channels, int frames, float* output, bool vectorized)
+{
+	auto first = 0;
+
+#if defined(RADIO_UI_SIMD)
+	if(true == vectorized) first = MixDownVectorized(input, channels, frames, output);
+#else
+	Q_UNUSED(vectorized)
+#endif
+
+	MixDownScalar(input, channels, first, frames, output);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void AudioKernels::mixDown(const float* input, int channels, int frames, float* output)
+{
+	const auto scale = 1.0f / channels;
+
+	for(auto i = 0; i < frames; ++i)
+	{
+		auto sum = 0.0f;
+		for(auto c = 0; c < channels; ++c) sum += input[i * channels + c];
+
+		output[i] = sum * scale;
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void AudioKernels::levels(const float* samples, int count, float &sumOfSquares, float &peak, bool vectorized)
+{
+	auto i = 0;
+	auto sum = 0.0f;
+	auto maximum = 0.0f;
+
+#if defined(RADIO_UI_SIMD)
+	if(true == vectorized)
+	{
+		auto sums = Splat(0.0f);
+		auto maxima = Splat(0.0f);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			const auto x = Load(samples + i);
+
+			sums = Add(sums, Mul(x, x));
+			maxima = Max(maxima, Abs(x));
+		}
+
+		//the lanes are only combined once per block
+		float lanes[4];
+		Store(lanes, sums);
+		sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+		Store(lanes, maxima);
+		maximum = qMax(qMax(lanes[0], lanes[1]), qMax(lanes[2], lanes[3]));
+	}
+#else
+	Q_UNUSED(vectorized)
+#endif
+
+	for(; i < count; ++i)
+	{
+		sum += samples[i] * samples[i];
+		maximum = qMax(maximum, std::fabs(samples[i]));
+	}
+
+	sumOfSquares = sum;
+	peak = maximum;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+Spectrum::Spectrum(int size)
+	: m_iSize(qMax(8, size))
+	, m_Window()
+	, m_BitReverse()
+	, m_TwiddleRe()
+	, m_TwiddleIm()
+	, m_Re()
+	, m_Im()
+{
+	Q_ASSERT(0 == (m_iSize & (m_iSize - 1)));
+
+	const auto pi = std::acos(-1.0);
+
+	m_Window.resize(m_iSize);
+	m_BitReverse.resize(m_iSize);
+	m_TwiddleRe.resize(m_iSize - 1);
+	m_TwiddleIm.resize(m_iSize - 1);
+	m_Re.resize(m_iSize);
+	m_Im.resize(m_iSize);
+
+	//the Hann window halves the amplitude of a sine, and the positive bins hold half of its energy
+	for(auto n = 0; n < m_iSize; ++n)
+	{
+		const auto hann = 0.5 - 0.5 * std::cos(2.0 * pi * n / m_iSize);
+		m_Window[n] = static_cast<float>(hann * 4.0 / m_iSize);
+	}
+
+	auto bits = 0;
+	while((1 << bits) < m_iSize) ++bits;
+
+	for(auto n = 0; n < m_iSize; ++n)
+	{
+		auto reversed = 0;
+		for(auto b = 0; b < bits; ++b) reversed |= ((n >> b) & 1) << (bits - 1 - b);
+
+		m_BitReverse[n] = reversed;
+	}
+
+	for(auto half = 1; half < m_iSize; half <<= 1)
+	{
+		for(auto k = 0; k < half; ++k)
+		{
+			const auto angle = -pi * k / half;
+			m_TwiddleRe[half - 1 + k] = static_cast<float>(std::cos(angle));
+			m_TwiddleIm[half - 1 + k] = static_cast<float>(std::sin(angle));
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int Spectrum::size() const
+{
+	return m_iSize;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void Spectrum::power(const float* samples, float* power, bool vectorized)
+{
+	auto re = m_Re.data();
+	auto im = m_Im.data();
+
+	//the window is applied while permuting, a gather cannot be vectorized anyway
+	for(auto n = 0; n < m_iSize; ++n) re[m_BitReverse.at(n)] = samples[n] * m_Window.at(n);
+	std::memset(im, 0, sizeof(float) * static_cast<size_t>(m_iSize));
+
+	transform(vectorized);
+
+	const auto bins = m_iSize / 2;
+	auto k = 0;
+
+#if defined(RADIO_UI_SIMD)
+	if(true == vectorized)
+	{
+		for(; k + 4 <= bins; k += 4)
+		{
+			const auto r = Load(re + k);
+			const auto i = Load(im + k);
+
+			Store(power + k, Add(Mul(r, r), Mul(i, i)));
+		}
+	}
+#endif
+
+	for(; k < bins; ++k) power[k] = re[k] * re[k] + im[k] * im[k];
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void Spectrum::transform(bool vectorized)
+{
+	auto re = m_Re.data();
+	auto im = m_Im.data();
+
+	const auto twiddleRe = m_TwiddleRe.constData();
+	const auto twiddleIm = m_TwiddleIm.constData();
+
+#if !defined(RADIO_UI_SIMD)
+	Q_UNUSED(vectorized)
+#endif
+
+	for(auto half = 1; half < m_iSize; half <<= 1)
+	{
+		const auto wRe = twiddleRe + half - 1;
+		const auto wIm = twiddleIm + half - 1;
+
+		for(auto start = 0; start < m_iSize; start += 2 * half)
+		{
+			auto aRe = re + start;
+			auto aIm = im + start;
+			auto bRe = aRe + half;
+			auto bIm = aIm + half;
+
+			auto k = 0;
+
+#if defined(RADIO_UI_SIMD)
+			//the first two stages have less than four butterflies per group and stay scalar
+			if(true == vectorized)
+			{
+				for(; k + 4 <= half; k += 4)
+				{
+					const auto wr = Load(wRe + k);
+					const auto wi = Load(wIm + k);
+					const auto br = Load(bRe + k);
+					const auto bi = Load(bIm + k);
+					const auto ar = Load(aRe + k);
+					const auto ai = Load(aIm + k);
+
+					const auto tr = Sub(Mul(br, wr), Mul(bi, wi));
+					const auto ti = Add(Mul(br, wi), Mul(bi, wr));
+
+					Store(aRe + k, Add(ar, tr));
+					Store(aIm + k, Add(ai, ti));
+					Store(bRe + k, Sub(ar, tr));
+					Store(bIm + k, Sub(ai, ti));
+				}
+			}
+#endif
+
+			for(; k < half; ++k)
+			{
+				const auto tr = bRe[k] * wRe[k] - bIm[k] * wIm[k];
+				const auto ti = bRe[k] * wIm[k] + bIm[k] * wRe[k];
+
+				bRe[k] = aRe[k] - tr;
+				bIm[k] = aIm[k] - ti;
+				aRe[k] += tr;
+				aIm[k] += ti;
+			}
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief The AudioKernels class holds the sample kernels of the level meter
+ *
+ * The kernels are vectorized with SSE2 or NEON, whichever the compiler targets, four floats at a time. Without either
+ * instruction set, or when asked to, the scalar implementation is used. Nothing is allocated, all buffers are passed in.
+ *
+ * @note NEON is only used if the compiler targets it, e.g. with -mfpu=neon on 32 bit ARM. AArch64 always has it.
+ */
+class AudioKernels
+{
+public:
+
+	/**
+	 * @brief instructionSet The instruction set the kernels were vectorized for
+	 * @return "SSE2", "NEON" or "scalar"
+	 */
+	static const char* instructionSet();
+
+	/**
+	 * @brief mixDown Convert interleaved 16 bit samples to mono floats in the range [-1, 1]
+	 * @param input The interleaved samples
+	 * @param channels The number of channels
+	 * @param frames The number of frames
+	 * @param output Receives one sample per frame
+	 * @param vectorized False to use the scalar implementation
+	 */
+	static void mixDown(const qint16* input, int channels, int frames, float* output, bool vectorized = true);
+
+	/**
+	 * @brief mixDown Convert interleaved float samples to mono floats
+	 * @param input The interleaved samples
+	 * @param channels The number of channels
+	 * @param frames The number of frames
+	 * @param output Receives one sample per frame
+	 */
+	static void mixDown(const float* input, int channels, int frames, float* output);
+
+	/**
+	 * @brief levels Measure a block of samples
+	 * @param samples The samples
+	 * @param count The number of samples
+	 * @param sumOfSquares Receives the sum of the squared samples, the root mean square is derived from it
+	 * @param peak Receives the largest absolute sample
+	 * @param vectorized False to use the scalar implementation
+	 */
+	static void levels(const float* samples, int count, float &sumOfSquares, float &peak, bool vectorized = true);
+};
+
+/**
+ * @brief The Spectrum class computes the power spectrum of fixed size blocks with a radix-2 FFT
+ *
+ * The window, the twiddle factors and the working buffers are allocated once by the constructor. The butterflies of
+ * all stages with at least four of them per group and the power computation are vectorized like the AudioKernels.
+ */
+class Spectrum
+{
+public:
+
+	/**
+	 * @brief Spectrum Default constructor
+	 * @param size The block size, a power of two of at least 8
+	 */
+	explicit Spectrum(int size);
+
+	/**
+	 * @brief size The block size
+	 * @return The number of samples per block
+	 */
+	int size() const;
+
+	/**
+	 * @brief power Compute the power spectrum of a block, a Hann window is applied
+	 * @param samples The block, size() samples
+	 * @param power Receives size() / 2 bins, a full scale sine results in about 1.0 in its bin
+	 * @param vectorized False to use the scalar implementation
+	 */
+	void power(const float* samples, float* power, bool vectorized = true);
+
+private:
+
+	/**
+	 * @brief transform Run the butterflies on the bit reversed working buffers
+	 * @param vectorized False to use the scalar implementation
+	 */
+	void transform(bool vectorized);
+
+	/**
+	 * @brief m_iSize The block size
+	 */
+	int m_iSize;
+
+	/**
+	 * @brief m_Window The Hann window, pre-scaled so a full scale sine has a power of 1.0
+	 */
+	QVector<float> m_Window;
+
+	/**
+	 * @brief m_BitReverse The position of each sample after the bit reversal permutation
+	 */
+	QVector<int> m_BitReverse;
+
+	/**
+	 * @brief m_TwiddleRe The real parts of the twiddle factors, the factors of a stage with n butterflies per group
+	 * start at index n - 1
+	 */
+	QVector<float> m_TwiddleRe;
+
+	/**
+	 * @brief m_TwiddleIm The imaginary parts of the twiddle factors
+	 */
+	QVector<float> m_TwiddleIm;
+
+	/**
+	 * @brief m_Re The real parts of the working buffer
+	 */
+	QVector<float> m_Re;
+
+	/**
+	 * @brief m_Im The imaginary parts of the working buffer
+	 */
+	QVector<float> m_Im;
+};
@@ -0,0 +1,293 @@
+#include "ControlServer.h"
+#include "StallWatchdog.h"
+
+namespace
+{
+
+//a line longer than this is not a command, the client is disconnected, in bytes
+const qint64 ciMaxLineLength = 4096;
+
+//events are not queued for a client with more unsent bytes than this
+const qint64 ciMaxPending = 64 * 1024;
+
+//how long to wait for a running instance on the socket before taking it over, in milliseconds
+const int ciConnectTimeout = 500;
+
+/**
+ * @brief Field Prepare a name or value for a protocol line
+ * @param text The text
+ * @return The text with tabs and line breaks replaced by spaces
+ */
+QString Field(QString text)
+{
+	text.replace(QLatin1Char('\t'), QLatin1Char(' '));
+	text.replace(QLatin1Char('\r'), QLatin1Char(' '));
+	text.replace(QLatin1Char('\n'), QLatin1Char(' '));
+
+	return text;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief StateName The protocol name of a player state
+ * @param state The player state
+ * @return The name
+ */
+QString StateName(QMediaPlayer::State state)
+{
+	switch(state)
+	{
+	case QMediaPlayer::PlayingState:
+		return QString("playing");
+	case QMediaPlayer::PausedState:
+		return QString("paused");
+	default:
+		return QString("stopped");
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+ControlServer::ControlServer(PlaybackCore &core, QObject* parent)
+	: QObject(parent)
+	, m_Core(core)
+	, m_Server()
+	, m_Clients()
+	, m_MetaData()
+{
+	connect(&m_Server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+
+	connect(&m_Core, &PlaybackCore::currentStationChanged, this, [=]()
+	{
+		//the values of the previous station are pushed again if the new one sends the same
+		m_MetaData.clear();
+		broadcast(stationLine());
+	});
+	connect(&m_Core, &PlaybackCore::playerStateChanged, this, [=]() { broadcast(stateLine()); });
+	connect(&m_Core, &PlaybackCore::volumeChanged, this, [=](int volume)
+	{
+		broadcast(QString("volume %1").arg(volume));
+	});
+	connect(&m_Core, &PlaybackCore::metaDataChanged, this, &ControlServer::onMetaDataChanged);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+ControlServer::~ControlServer()
+{
+	//the clients are deleted together with the server, their disconnects must not reach this half destroyed instance
+	for(auto client : m_Clients) disconnect(client, nullptr, this, nullptr);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ControlServer::listen(const QString &name)
+{
+	m_Server.close();
+
+	//only the user running the player may control it
+	m_Server.setSocketOptions(QLocalServer::UserAccessOption);
+
+	if(true == m_Server.listen(name)) return true;
+	if(QAbstractSocket::AddressInUseError != m_Server.serverError()) return false;
+
+	//only a socket left behind by a crashed run is taken over, not the one of a running instance
+	QLocalSocket other;
+	other.connectToServer(name);
+	if(true == other.waitForConnected(ciConnectTimeout)) return false;
+
+	QLocalServer::removeServer(name);
+
+	return m_Server.listen(name);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString ControlServer::errorString() const
+{
+	return m_Server.errorString();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString ControlServer::socketPath() const
+{
+	return m_Server.fullServerName();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void ControlServer::onNewConnection()
+{
+	while(true == m_Server.hasPendingConnections())
+	{
+		auto client = m_Server.nextPendingConnection();
+		m_Clients << client;
+
+		connect(client, &QLocalSocket::readyRead, this, [=]() { readCommands(client); });
+		connect(client, &QLocalSocket::disconnected, this, [=]()
+		{
+			m_Clients.removeAll(client);
+			client->deleteLater();
+		});
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void ControlServer::onMetaDataChanged()
+{
+	if(true == m_Clients.isEmpty()) return;
+
+	//only the values which changed since the last push are sent
+	for(const auto &key : m_Core.availableMetaData())
+	{
+		const auto value = Field(m_Core.metaData(key).toString());
+		if((true == m_MetaData.contains(key)) && (value == m_MetaData.value(key))) continue;
+
+		m_MetaData.insert(key, value);
+		broadcast(QString("metadata %1\t%2").arg(Field(key), value));
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void ControlServer::readCommands(QLocalSocket* client)
+{
+	while(true == client->canReadLine())
+	{
+		const auto line = QString::fromUtf8(client->readLine()).trimmed();
+		if(false == line.isEmpty()) execute(client, line);
+	}
+
+	//whatever is sending this, it does not speak the protocol
+	if(ciMaxLineLength < client->bytesAvailable())
+	{
+		send(client, QStringList() << QString("error line too long"));
+		client->disconnectFromServer();
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void ControlServer::execute(QLocalSocket* client, const QString &line)
+{
+	const auto separator = line.indexOf(QLatin1Char(' '));
+	const auto command = line.left(separator).toLower();
+	const auto argument = (0 <= separator) ? line.mid(separator + 1).trimmed() : QString();
+
+	QStringList lines;
+
+	if(QString("list") == command)
+	{
+		const auto &stations = m_Core.stations();
+
+		for(auto row = 0; row < stations.rowCount(); ++row)
+		{
+			const auto id = stations.id(row);
+			lines << QString("station %1\t%2").arg(id).arg(Field(stations.station(id)->m_strDefaultPublisher));
+		}
+	}
+	else if(QString("play") == command)
+	{
+		if(false == m_Core.play(findStation(argument)))
+		{
+			send(client, QStringList() << QString("error unknown station"));
+			return;
+		}
+	}
+	else if(QString("stop") == command)
+	{
+		m_Core.stop();
+	}
+	else if(QString("pause") == command)
+	{
+		m_Core.pause();
+	}
+	else if(QString("resume") == command)
+	{
+		m_Core.resume();
+	}
+	else if(QString("volume") == command)
+	{
+		if(true == argument.isEmpty())
+		{
+			lines << QString("volume %1").arg(m_Core.volume());
+		}
+		else
+		{
+			auto valid = false;
+			const auto volume = argument.toInt(&valid);
+
+			if((false == valid) || (0 > volume) || (100 < volume))
+			{
+				send(client, QStringList() << QString("error volume out of range"));
+				return;
+			}
+
+			m_Core.setVolume(volume);
+		}
+	}
+	else if(QString("current") == command)
+	{
+		lines << stationLine() << stateLine() << QString("volume %1").arg(m_Core.volume());
+
+		for(const auto &key : m_Core.availableMetaData())
+		{
+			lines << QString("metadata %1\t%2").arg(Field(key), Field(m_Core.metaData(key).toString()));
+		}
+	}
+	else if(QString("stalls") == command)
+	{
+		lines << StallWatchdog::report();
+	}
+	else
+	{
+		send(client, QStringList() << QString("error unknown command"));
+		return;
+	}
+
+	lines << QString("ok");
+	send(client, lines);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int ControlServer::findStation(const QString &argument) const
+{
+	const auto &stations = m_Core.stations();
+
+	auto valid = false;
+	const auto id = argument.toInt(&valid);
+	if((true == valid) && (nullptr != stations.station(id))) return id;
+
+	for(auto row = 0; row < stations.rowCount(); ++row)
+	{
+		const auto candidate = stations.id(row);
+		if(0 == argument.compare(stations.station(candidate)->m_strDefaultPublisher, Qt::CaseInsensitive)) return candidate;
+	}
+
+	return -1;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString ControlServer::stationLine() const
+{
+	return QString("station %1\t%2").arg(m_Core.currentId()).arg(Field(m_Core.currentStation()->m_strDefaultPublisher));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString ControlServer::stateLine() const
+{
+	return QString("state %1").arg(StateName(m_Core.playerState()));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void ControlServer::send(QLocalSocket* client, const QStringList &lines)
+{
+	client->write((lines.join(QLatin1Char('\n')) + QLatin1Char('\n')).toUtf8());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void ControlServer::broadcast(const QString &event)
+{
+	for(auto client : m_Clients)
+	{
+		if(ciMaxPending < client->bytesToWrite()) continue;
+
+		send(client, QStringList() << QString("event %1").arg(event));
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QObject>
+
+#include "PlaybackCore.h"
+
+/**
+ * @brief The ControlServer class lets other processes control a playback core through a local socket
+ *
+ * The protocol is line based, every line is UTF-8 text and the fields of a line are separated by tabs. A client sends
+ * one command per line, the server answers with any number of data lines followed by "ok" or "error <reason>":
+ *
+ *   list                     station <id>\t<name> for every station
+ *   play <id>|<name>         switch to a station
+ *   stop, pause, resume      control the current station
+ *   volume [<0-100>]         set the volume, without an argument only report it as volume <n>
+ *   current                  station <id>\t<name>, state <state>, volume <n> and metadata <key>\t<value> lines
+ *   stalls                   the stalls of the gui thread, see StallWatchdog::report()
+ *
+ * Changes are pushed to all clients as they happen, regardless of who caused them:
+ *
+ *   event station <id>\t<name>
+ *   event state playing|paused|stopped
+ *   event volume <n>
+ *   event metadata <key>\t<value>
+ *
+ * @note Tabs and line breaks within names and values are replaced by spaces. Clients which do not read their socket
+ * miss events instead of making the server buffer them without limit.
+ */
+class ControlServer : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief ControlServer Default constructor, call listen() to accept clients
+	 * @param core The playback core controlled by the clients
+	 * @param parent
+	 */
+	explicit ControlServer(PlaybackCore &core, QObject* parent = nullptr);
+
+	/**
+	 * @brief ~ControlServer Default destructor, disconnects all clients
+	 */
+	virtual ~ControlServer();
+
+	/**
+	 * @brief listen Accept clients on a local socket, a stale socket left by a previous run is removed
+	 * @param name The socket path, a plain name is placed in the temporary folder
+	 * @return False if the socket could not be created, see errorString()
+	 */
+	bool listen(const QString &name);
+
+	/**
+	 * @brief errorString Why listen() failed
+	 * @return The error
+	 */
+	QString errorString() const;
+
+	/**
+	 * @brief socketPath The full path of the socket
+	 * @return The path, empty if not listening
+	 */
+	QString socketPath() const;
+
+private slots:
+
+	/**
+	 * @brief onNewConnection Accept the pending clients
+	 */
+	void onNewConnection();
+
+	/**
+	 * @brief onMetaDataChanged Push the changed meta data values of the current station
+	 */
+	void onMetaDataChanged();
+
+private:
+
+	/**
+	 * @brief readCommands Execute the complete lines a client sent
+	 * @param client The client
+	 */
+	void readCommands(QLocalSocket* client);
+
+	/**
+	 * @brief execute Execute a single command
+	 * @param client The client which sent the command, receives the answer
+	 * @param line The command line without the line break
+	 */
+	void execute(QLocalSocket* client, const QString &line);
+
+	/**
+	 * @brief findStation Resolve the argument of the play command
+	 * @param argument A station id or a station name, names are compared case insensitively
+	 * @return The station id, -1 if there is no such station
+	 */
+	int findStation(const QString &argument) const;
+
+	/**
+	 * @brief stationLine Describe the current station
+	 * @return The station line, "station -1\t" if there is no current station
+	 */
+	QString stationLine() const;
+
+	/**
+	 * @brief stateLine Describe the state of the current station
+	 * @return The state line
+	 */
+	QString stateLine() const;
+
+	/**
+	 * @brief send Send lines to a client
+	 * @param client The client
+	 * @param lines The lines without line breaks
+	 */
+	void send(QLocalSocket* client, const QStringList &lines);
+
+	/**
+	 * @brief broadcast Push an event to all clients
+	 * @param event The event line without the "event " prefix and the line break
+	 */
+	void broadcast(const QString &event);
+
+	/**
+	 * @brief m_Core The playback core controlled by the clients
+	 */
+	PlaybackCore &m_Core;
+
+	/**
+	 * @brief m_Server Accepts the clients
+	 */
+	QLocalServer m_Server;
+
+	/**
+	 * @brief m_Clients The connected clients
+	 */
+	QList<QLocalSocket*> m_Clients;
+
+	/**
+	 * @brief m_MetaData The meta data values of the current station pushed last, by key
+	 */
+	QHash<QString, QString> m_MetaData;
+};
@@ -0,0 +1,144 @@
+#include "IcyDemuxer.h"
+
+#include <QTextCodec>
+
+namespace
+{
+
+//the length byte of a metadata block counts in units of this many bytes
+const int ciMetadataUnit = 16;
+
+}
+
+IcyDemuxer::IcyDemuxer()
+	: m_iInterval(0)
+	, m_iAudioLeft(0)
+	, m_iMetadataLeft(-1)
+	, m_baMetadata()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyDemuxer::reset(int metaInterval)
+{
+	m_iInterval = qMax(0, metaInterval);
+	m_iAudioLeft = m_iInterval;
+	m_iMetadataLeft = -1;
+	m_baMetadata.clear();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyDemuxer::feed(const char* data, qint64 length, const AudioReceiver &audio, const MetadataReceiver &metadata)
+{
+	while(0 < length)
+	{
+		if(0 == m_iInterval)
+		{
+			audio(data, length);
+			return;
+		}
+
+		if(0 < m_iAudioLeft)
+		{
+			const auto count = qMin(m_iAudioLeft, length);
+			audio(data, count);
+
+			data += count;
+			length -= count;
+			m_iAudioLeft -= count;
+			continue;
+		}
+
+		if(0 > m_iMetadataLeft)
+		{
+			m_iMetadataLeft = static_cast<uchar>(*data) * ciMetadataUnit;
+			m_baMetadata.clear();
+
+			++data;
+			--length;
+		}
+		else
+		{
+			const auto count = qMin(m_iMetadataLeft, length);
+			m_baMetadata.append(data, static_cast<int>(count));
+
+			data += count;
+			length -= count;
+			m_iMetadataLeft -= count;
+		}
+
+		if(0 != m_iMetadataLeft) continue;
+
+		//most blocks are empty, they only tell that nothing changed
+		if(false == m_baMetadata.isEmpty())
+		{
+			const auto parsed = parseMetadata(m_baMetadata);
+			if(false == parsed.isEmpty()) metadata(parsed);
+		}
+
+		m_iAudioLeft = m_iInterval;
+		m_iMetadataLeft = -1;
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyDemuxer::parseHeader(const QByteArray &key, const QByteArray &value, QVariantMap &metadata)
+{
+	const auto k = key.trimmed().toLower();
+	if(false == k.startsWith("icy-")) return;
+
+	const auto text = decode(value.trimmed());
+	metadata.insert(QString::fromLatin1(k), text);
+
+	if("icy-name" == k) metadata.insert(QStringLiteral("publisher"), text);
+	else if("icy-genre" == k) metadata.insert(QStringLiteral("genre"), text);
+	else if("icy-description" == k) metadata.insert(QStringLiteral("description"), text);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QVariantMap IcyDemuxer::parseMetadata(const QByteArray &block)
+{
+	QVariantMap metadata;
+
+	//blocks are padded with zeros to a multiple of 16 bytes
+	auto end = block.indexOf('\0');
+	if(0 > end) end = block.size();
+
+	auto position = 0;
+	while(position < end)
+	{
+		const auto separator = block.indexOf("='", position);
+		if((0 > separator) || (separator >= end)) break;
+
+		//titles may contain quotes, a value ends at the first quote followed by a semicolon or the end of the block
+		auto valueEnd = block.indexOf("';", separator + 2);
+		if((0 > valueEnd) || (valueEnd >= end)) valueEnd = block.lastIndexOf('\'', end - 1);
+		if(valueEnd < separator + 2) break;
+
+		const auto key = block.mid(position, separator - position).trimmed().toLower();
+		const auto value = decode(block.mid(separator + 2, valueEnd - separator - 2));
+
+		if(false == key.isEmpty())
+		{
+			metadata.insert(QString::fromLatin1(key), value);
+			if("streamtitle" == key) metadata.insert(QStringLiteral("title"), value);
+		}
+
+		position = valueEnd + 2;
+	}
+
+	return metadata;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString IcyDemuxer::decode(const QByteArray &text)
+{
+	QTextCodec::ConverterState state;
+	const auto decoded = QTextCodec::codecForName("UTF-8")->toUnicode(text.constData(), text.size(), &state);
+
+	//text which is no valid UTF-8 was most likely sent by an older server in Latin-1
+	if(0 < state.invalidChars) return QString::fromLatin1(text);
+
+	return decoded;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <functional>
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+
+/**
+ * @brief The IcyDemuxer class separates the audio data of an ICY (Shoutcast/Icecast) stream from its metadata
+ *
+ * A server which was asked for metadata with the "Icy-MetaData: 1" request header interleaves a metadata block after
+ * every icy-metaint bytes of audio. The demuxer is fed the raw stream in chunks of any size and passes the audio on as
+ * spans of the fed chunks, so the audio payload is not copied. Only the metadata blocks are collected and parsed.
+ *
+ * The metadata is reported with lower case keys. Besides the raw ICY keys, the values are also reported under the keys
+ * of QMediaMetaData which the media backends use, so the meta_key_1 and meta_key_2 fields of a station work the same
+ * with either source:
+ * - StreamTitle: title
+ * - icy-name: publisher
+ * - icy-genre: genre
+ * - icy-description: description
+ */
+class IcyDemuxer
+{
+public:
+
+	typedef std::function<void(const char*, qint64)> AudioReceiver;
+	typedef std::function<void(QVariantMap)> MetadataReceiver;
+
+	/**
+	 * @brief IcyDemuxer Default constructor, the stream is passed on as it is until reset() is called
+	 */
+	IcyDemuxer();
+
+	/**
+	 * @brief reset Start demuxing a new response
+	 * @param metaInterval The number of audio bytes between two metadata blocks, the icy-metaint header. 0 if the
+	 * stream has no interleaved metadata.
+	 */
+	void reset(int metaInterval);
+
+	/**
+	 * @brief feed Demux the next chunk of the stream
+	 * @param data The chunk
+	 * @param length The size of the chunk in bytes
+	 * @param audio Called with each span of audio data, in stream order
+	 * @param metadata Called with each complete metadata block which is not empty, in stream order
+	 */
+	void feed(const char* data, qint64 length, const AudioReceiver &audio, const MetadataReceiver &metadata);
+
+	/**
+	 * @brief parseHeader Convert an ICY response header into metadata
+	 * @param key The header name
+	 * @param value The raw header value
+	 * @param metadata Receives the metadata, unknown headers are ignored
+	 */
+	static void parseHeader(const QByteArray &key, const QByteArray &value, QVariantMap &metadata);
+
+	/**
+	 * @brief parseMetadata Convert a metadata block into metadata
+	 * @param block The block, e.g. "StreamTitle='Artist - Title';StreamUrl='';"
+	 * @return The metadata
+	 */
+	static QVariantMap parseMetadata(const QByteArray &block);
+
+	/**
+	 * @brief decode Decode a metadata text, servers send UTF-8 or Latin-1
+	 * @param text The raw text
+	 * @return The decoded text
+	 */
+	static QString decode(const QByteArray &text);
+
+private:
+
+	/**
+	 * @brief m_iInterval The number of audio bytes between two metadata blocks, 0 if there are none
+	 */
+	qint64 m_iInterval;
+
+	/**
+	 * @brief m_iAudioLeft The number of audio bytes up to the next metadata block
+	 */
+	qint64 m_iAudioLeft;
+
+	/**
+	 * @brief m_iMetadataLeft The number of bytes missing of the current metadata block, -1 if its length byte is next
+	 */
+	qint64 m_iMetadataLeft;
+
+	/**
+	 * @brief m_baMetadata The part of the current metadata block received so far
+	 */
+	QByteArray m_baMetadata;
+};
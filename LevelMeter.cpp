@@ -0,0 +1,185 @@
+#include "LevelMeter.h"
+
+#include <QPainter>
+
+#include "Tracer.h"
+
+namespace
+{
+
+//the polling and repaint interval in milliseconds, about 30 frames per second
+const int ciTickInterval = 33;
+
+//the range shown by the meter, the top is at 0 dB
+const double cdRange = 60.0;
+
+//how far the bars fall per tick, in dB
+const double cdFallPerTick = 1.5;
+
+//the number of ticks without a new measurement after which the audio is considered silent
+const int ciSilentTicks = 6;
+
+//the height of the level bar relative to the widget height
+const double cdLevelHeight = 0.25;
+
+//the space between the bars in pixels
+const int ciGap = 2;
+
+//the color of the bars
+const QColor ccAccent = QColor(72, 126, 176);
+
+//the color of the peak mark
+const QColor ccPeak = QColor(255, 255, 255);
+
+/**
+ * @brief Fraction Map a level to the meter scale
+ * @param level The level in dB
+ * @return The position on the meter, from 0.0 at the bottom to 1.0 at the top
+ */
+double Fraction(double level)
+{
+	return qBound(0.0, (level + cdRange) / cdRange, 1.0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+LevelMeter::LevelMeter(QWidget* parent)
+	: QWidget(parent)
+	, m_pAnalyzer(nullptr)
+	, m_uUpdate(0)
+	, m_iSilentTicks(0)
+	, m_Displayed()
+	, m_Timer()
+{
+	setAttribute(Qt::WA_OpaquePaintEvent);
+
+	m_Displayed.m_dRms = -cdRange;
+	m_Displayed.m_dPeak = -cdRange;
+	for(auto band = 0; band < AudioAnalyzer::BandCount; ++band) m_Displayed.m_Bands[band] = -cdRange;
+
+	m_Timer.setInterval(ciTickInterval);
+	connect(&m_Timer, &QTimer::timeout, this, &LevelMeter::onTick);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LevelMeter::setAnalyzer(const AudioAnalyzer* analyzer)
+{
+	if(nullptr != m_pAnalyzer) disconnect(m_pAnalyzer, nullptr, this, nullptr);
+
+	m_pAnalyzer = analyzer;
+	m_uUpdate = 0;
+
+	if(nullptr != m_pAnalyzer) connect(m_pAnalyzer, &AudioAnalyzer::audioQueued, this, &LevelMeter::wake);
+
+	wake();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LevelMeter::wake()
+{
+	if((true == isVisible()) && (false == m_Timer.isActive())) m_Timer.start();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LevelMeter::paintEvent(QPaintEvent* event)
+{
+	Q_UNUSED(event)
+
+	TRACE_SCOPE("paintLevelMeter", "paint");
+
+	QPainter painter(this);
+	painter.fillRect(rect(), Qt::black);
+
+	const auto levelHeight = qMax(4, static_cast<int>(height() * cdLevelHeight));
+	const auto levelWidth = static_cast<int>(width() * Fraction(m_Displayed.m_dRms));
+	const auto peak = static_cast<int>(width() * Fraction(m_Displayed.m_dPeak));
+
+	painter.fillRect(0, 0, levelWidth, levelHeight, ccAccent);
+	if(0 < peak) painter.fillRect(qMax(0, peak - ciGap), 0, ciGap, levelHeight, ccPeak);
+
+	//the bands fill the rest, from the lowest band on the left
+	const auto top = levelHeight + ciGap;
+	const auto bandsHeight = height() - top;
+	const auto bandWidth = static_cast<double>(width() + ciGap) / AudioAnalyzer::BandCount;
+
+	for(auto band = 0; band < AudioAnalyzer::BandCount; ++band)
+	{
+		const auto left = static_cast<int>(band * bandWidth);
+		const auto right = static_cast<int>((band + 1) * bandWidth) - ciGap;
+		const auto barHeight = static_cast<int>(bandsHeight * Fraction(m_Displayed.m_Bands[band]));
+
+		if(0 < barHeight) painter.fillRect(left, height() - barHeight, right - left, barHeight, ccAccent);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LevelMeter::showEvent(QShowEvent* event)
+{
+	QWidget::showEvent(event);
+
+	wake();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LevelMeter::hideEvent(QHideEvent* event)
+{
+	QWidget::hideEvent(event);
+
+	m_Timer.stop();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LevelMeter::onTick()
+{
+	AudioAnalyzer::Levels levels;
+	auto silent = true;
+
+	if(nullptr != m_pAnalyzer)
+	{
+		levels = m_pAnalyzer->levels();
+
+		if(levels.m_uUpdate != m_uUpdate)
+		{
+			m_uUpdate = levels.m_uUpdate;
+			m_iSilentTicks = 0;
+			silent = false;
+		}
+		else if(ciSilentTicks > ++m_iSilentTicks)
+		{
+			//the measurements come at about the tick rate, keep the bars until the next one
+			return;
+		}
+	}
+
+	auto changed = false;
+
+	changed |= fall(m_Displayed.m_dRms, (true == silent) ? -cdRange : levels.m_dRms);
+	changed |= fall(m_Displayed.m_dPeak, (true == silent) ? -cdRange : levels.m_dPeak);
+	for(auto band = 0; band < AudioAnalyzer::BandCount; ++band)
+	{
+		changed |= fall(m_Displayed.m_Bands[band], (true == silent) ? -cdRange : levels.m_Bands[band]);
+	}
+
+	if(true == changed)
+	{
+		update();
+	}
+	else if(true == silent)
+	{
+		//all bars are at the bottom, wake() starts polling again once audio arrives
+		m_Timer.stop();
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool LevelMeter::fall(double &displayed, double level)
+{
+	const auto target = qMax(-cdRange, level);
+	const auto previous = displayed;
+
+	displayed = (target >= displayed) ? target : qMax(target, displayed - cdFallPerTick);
+
+	return previous != displayed;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QTimer>
+#include <QWidget>
+
+#include "AudioAnalyzer.h"
+
+/**
+ * @brief The LevelMeter class shows the level and the coarse spectrum measured by an AudioAnalyzer
+ *
+ * The meter polls the analyzer at most about 30 times per second and only while it is visible and audio arrives. The
+ * bars rise immediately and fall back slowly, once they reached the bottom the polling stops until audio is queued
+ * again. The widget is painted directly, without the style sheet engine.
+ */
+class LevelMeter : public QWidget
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief LevelMeter Default constructor
+	 * @param parent The parent widget
+	 */
+	explicit LevelMeter(QWidget* parent = nullptr);
+
+	/**
+	 * @brief setAnalyzer Set the analyzer to show
+	 * @param analyzer The analyzer, must outlive the meter. Nullptr lets the meter fall back to silence.
+	 */
+	void setAnalyzer(const AudioAnalyzer* analyzer);
+
+public slots:
+
+	/**
+	 * @brief wake Start polling the analyzer, connected to AudioAnalyzer::audioQueued()
+	 */
+	void wake();
+
+protected:
+
+	void paintEvent(QPaintEvent* event) override;
+
+	void showEvent(QShowEvent* event) override;
+
+	void hideEvent(QHideEvent* event) override;
+
+private slots:
+
+	/**
+	 * @brief onTick Take the latest levels from the analyzer and apply the ballistics
+	 */
+	void onTick();
+
+private:
+
+	/**
+	 * @brief fall Move a displayed level towards a new level
+	 * @param displayed The displayed level in dB, updated
+	 * @param level The measured level in dB
+	 * @return True if the displayed level changed
+	 */
+	static bool fall(double &displayed, double level);
+
+	/**
+	 * @brief m_pAnalyzer The analyzer shown, may be null
+	 */
+	const AudioAnalyzer* m_pAnalyzer;
+
+	/**
+	 * @brief m_uUpdate The measurement last taken from the analyzer
+	 */
+	quint64 m_uUpdate;
+
+	/**
+	 * @brief m_iSilentTicks The number of ticks since the last new measurement
+	 */
+	int m_iSilentTicks;
+
+	/**
+	 * @brief m_Displayed The displayed levels in dB
+	 */
+	AudioAnalyzer::Levels m_Displayed;
+
+	/**
+	 * @brief m_Timer Paces the polling and the repaints
+	 */
+	QTimer m_Timer;
+};
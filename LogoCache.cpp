@@ -0,0 +1,220 @@
+#include "LogoCache.h"
+
+#include <algorithm>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+
+namespace
+{
+
+//the name of the file holding the information about all entries
+const QString cstrIndexFileName = QStringLiteral("index.json");
+
+}
+
+LogoCache::LogoCache(const QString &directory, qint64 maximumSize)
+	: m_strDirectory(directory)
+	, m_iMaximumSize(maximumSize)
+	, m_iSize(0)
+	, m_Entries()
+{
+	if(true == m_strDirectory.isEmpty())
+	{
+		m_strDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/logos");
+	}
+
+	QDir().mkpath(m_strDirectory);
+
+	loadIndex();
+	evict();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+LogoCache::~LogoCache()
+{
+	saveIndex();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool LogoCache::contains(const QUrl &url) const
+{
+	return m_Entries.contains(key(url));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+LogoCache::Entry LogoCache::entry(const QUrl &url) const
+{
+	return m_Entries.value(key(url));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString LogoCache::path(const QUrl &url)
+{
+	const auto k = key(url);
+	if(false == m_Entries.contains(k)) return QString();
+
+	touch(url);
+
+	return QDir(m_strDirectory).filePath(k);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoCache::insert(const QUrl &url, const QByteArray &data, const QByteArray &eTag, const QByteArray &lastModified)
+{
+	const auto k = key(url);
+
+	//entries which can never fit are not stored at all
+	if(data.size() > m_iMaximumSize)
+	{
+		remove(url);
+		return;
+	}
+
+	QSaveFile f(QDir(m_strDirectory).filePath(k));
+	if(false == f.open(QFile::WriteOnly)) return;
+
+	f.write(data);
+	if(false == f.commit()) return;
+
+	m_iSize -= m_Entries.value(k).m_iSize;
+
+	Entry e;
+	e.m_uUrl = url;
+	e.m_baETag = eTag;
+	e.m_baLastModified = lastModified;
+	e.m_iSize = data.size();
+	e.m_tLastUsed = QDateTime::currentDateTimeUtc();
+
+	m_Entries.insert(k, e);
+	m_iSize += e.m_iSize;
+
+	//the new entry is the most recently used one, so it is never evicted here
+	evict();
+	saveIndex();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoCache::touch(const QUrl &url)
+{
+	auto it = m_Entries.find(key(url));
+	if(m_Entries.end() == it) return;
+
+	//the index is written on the next modification or on destruction, hits alone must not cause writes
+	it->m_tLastUsed = QDateTime::currentDateTimeUtc();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoCache::remove(const QUrl &url)
+{
+	const auto k = key(url);
+	if(false == m_Entries.contains(k)) return;
+
+	m_iSize -= m_Entries.take(k).m_iSize;
+	QFile::remove(QDir(m_strDirectory).filePath(k));
+
+	saveIndex();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 LogoCache::size() const
+{
+	return m_iSize;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString LogoCache::directory() const
+{
+	return m_strDirectory;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString LogoCache::key(const QUrl &url)
+{
+	return QString::fromLatin1(QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Sha1).toHex());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoCache::loadIndex()
+{
+	QFile f(QDir(m_strDirectory).filePath(cstrIndexFileName));
+	if(false == f.open(QFile::ReadOnly)) return;
+
+	const auto jsonObj = QJsonDocument::fromJson(f.readAll()).object();
+
+	for(const auto &k : jsonObj.keys())
+	{
+		const auto entryObject = jsonObj.value(k).toObject();
+
+		//skip entries whose data was removed behind our back
+		QFileInfo fi(QDir(m_strDirectory).filePath(k));
+		if(false == fi.exists()) continue;
+
+		Entry e;
+		e.m_uUrl = QUrl(entryObject.value("url").toString());
+		e.m_baETag = entryObject.value("etag").toString().toLatin1();
+		e.m_baLastModified = entryObject.value("last-modified").toString().toLatin1();
+		e.m_iSize = fi.size();
+		e.m_tLastUsed = QDateTime::fromString(entryObject.value("last-used").toString(), Qt::ISODate);
+
+		m_Entries.insert(k, e);
+		m_iSize += e.m_iSize;
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoCache::saveIndex() const
+{
+	QJsonObject jsonObj;
+
+	for(auto it = m_Entries.cbegin(); it != m_Entries.cend(); ++it)
+	{
+		QJsonObject entryObject;
+		entryObject.insert("url", it->m_uUrl.toString());
+		entryObject.insert("etag", QString::fromLatin1(it->m_baETag));
+		entryObject.insert("last-modified", QString::fromLatin1(it->m_baLastModified));
+		entryObject.insert("last-used", it->m_tLastUsed.toString(Qt::ISODate));
+
+		jsonObj.insert(it.key(), entryObject);
+	}
+
+	QSaveFile f(QDir(m_strDirectory).filePath(cstrIndexFileName));
+	if(false == f.open(QFile::WriteOnly)) return;
+
+	f.write(QJsonDocument(jsonObj).toJson(QJsonDocument::Compact));
+	f.commit();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoCache::evict()
+{
+	if(m_iSize <= m_iMaximumSize) return;
+
+	//sorted once per pass, so evicting many entries does not scan all of them for each one
+	QVector<QPair<QDateTime, QString>> byLastUse;
+	byLastUse.reserve(m_Entries.size());
+	for(auto it = m_Entries.cbegin(); it != m_Entries.cend(); ++it)
+	{
+		byLastUse.append(qMakePair(it->m_tLastUsed, it.key()));
+	}
+
+	std::sort(byLastUse.begin(), byLastUse.end());
+
+	for(auto it = byLastUse.cbegin(); (it != byLastUse.cend()) && (m_iSize > m_iMaximumSize); ++it)
+	{
+		m_iSize -= m_Entries.take(it->second).m_iSize;
+		QFile::remove(QDir(m_strDirectory).filePath(it->second));
+	}
+
+	saveIndex();
+}
+//----------------------------------------------------------------------------------------------------------------------
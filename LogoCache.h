@@ -0,0 +1,155 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QMap>
+#include <QString>
+#include <QUrl>
+
+/**
+ * @brief The LogoCache class is a persistent, content addressed store for downloaded logos
+ *
+ * Each entry is keyed by the hash of its url and holds the encoded image data together with the validators (ETag and
+ * Last-Modified) returned by the server, so the entry can be revalidated with a conditional request. The cache is
+ * limited in size, the least recently used entries are evicted first.
+ *
+ * @note The cache is not thread safe, all calls must be made from the same thread
+ */
+class LogoCache
+{
+public:
+
+	/**
+	 * @brief The Entry struct describes a single cached logo
+	 */
+	struct Entry
+	{
+		//! The url the data was downloaded from
+		QUrl m_uUrl;
+
+		//! The ETag header of the response, may be empty
+		QByteArray m_baETag;
+
+		//! The Last-Modified header of the response, may be empty
+		QByteArray m_baLastModified;
+
+		//! The size of the stored data in bytes
+		qint64 m_iSize = 0;
+
+		//! When the entry was used the last time, used for eviction
+		QDateTime m_tLastUsed;
+	};
+
+	/**
+	 * @brief LogoCache Default constructor
+	 * @param directory Where to store the cache, defaults to the logos folder inside the users cache location
+	 * @param maximumSize The maximum number of bytes to store
+	 */
+	explicit LogoCache(const QString &directory = QString(), qint64 maximumSize = 8 * 1024 * 1024);
+
+	/**
+	 * @brief ~LogoCache Writes the index including the latest usage information
+	 */
+	~LogoCache();
+
+	/**
+	 * @brief contains Check if data for the url is available
+	 * @param url The url to check
+	 * @return True if the cache holds data for the url
+	 */
+	bool contains(const QUrl &url) const;
+
+	/**
+	 * @brief entry Get the entry information for an url
+	 * @param url The url
+	 * @return The entry, default constructed if the url is not cached
+	 */
+	Entry entry(const QUrl &url) const;
+
+	/**
+	 * @brief path Get the file holding the cached data for an url and mark the entry as used
+	 * @param url The url
+	 * @return The path of the file, empty if the url is not cached
+	 *
+	 * @note The file is not read here, so it can be read and decoded in one go on a worker thread. If it turns out to
+	 * be unreadable, the entry must be removed.
+	 */
+	QString path(const QUrl &url);
+
+	/**
+	 * @brief insert Store or replace the data for an url, evicts old entries if the cache gets too big
+	 * @param url The url
+	 * @param data The encoded image data
+	 * @param eTag The ETag header of the response
+	 * @param lastModified The Last-Modified header of the response
+	 */
+	void insert(const QUrl &url, const QByteArray &data, const QByteArray &eTag, const QByteArray &lastModified);
+
+	/**
+	 * @brief touch Mark the entry for an url as used, e.g. after a successful revalidation
+	 * @param url The url
+	 */
+	void touch(const QUrl &url);
+
+	/**
+	 * @brief remove Drop the entry for an url
+	 * @param url The url
+	 */
+	void remove(const QUrl &url);
+
+	/**
+	 * @brief size The number of bytes currently stored
+	 * @return The size of all entries
+	 */
+	qint64 size() const;
+
+	/**
+	 * @brief directory Where the cache is stored
+	 * @return The cache directory
+	 */
+	QString directory() const;
+
+private:
+
+	/**
+	 * @brief key Calculate the content address for an url
+	 * @param url The url
+	 * @return The hex encoded hash of the url
+	 */
+	static QString key(const QUrl &url);
+
+	/**
+	 * @brief loadIndex Read the index of all entries from the cache directory
+	 */
+	void loadIndex();
+
+	/**
+	 * @brief saveIndex Write the index of all entries to the cache directory
+	 */
+	void saveIndex() const;
+
+	/**
+	 * @brief evict Remove the least recently used entries until the cache fits into the maximum size
+	 */
+	void evict();
+
+	/**
+	 * @brief m_strDirectory Where to store the data
+	 */
+	QString m_strDirectory;
+
+	/**
+	 * @brief m_iMaximumSize The maximum number of bytes to store
+	 */
+	const qint64 m_iMaximumSize;
+
+	/**
+	 * @brief m_iSize The number of bytes currently stored
+	 */
+	qint64 m_iSize;
+
+	/**
+	 * @brief m_Entries All entries, keyed by the hash of the url
+	 */
+	QMap<QString, Entry> m_Entries;
+};
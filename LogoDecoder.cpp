@@ -0,0 +1,68 @@
+#include "LogoDecoder.h"
+
+#include <QThread>
+
+#include "PoolTask.h"
+#include "Tracer.h"
+
+LogoDecoder::LogoDecoder()
+	: QObject(nullptr)
+	, m_uNextJob(0)
+	, m_Jobs()
+	, m_Pool()
+{
+	m_Pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+
+	//the signal is emitted from the workers, the receivers must be called on our own thread
+	connect(this, &LogoDecoder::logoDecoded, this, &LogoDecoder::onLogoDecoded, Qt::QueuedConnection);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+LogoDecoder::~LogoDecoder()
+{
+	m_Pool.clear();
+	m_Pool.waitForDone();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDecoder::decodeBase64(const QByteArray &data, const ImageReceiver &receiver)
+{
+	enqueue([=]() { return QImage::fromData(QByteArray::fromBase64(data)); }, receiver);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDecoder::decodeFile(const QString &path, const ImageReceiver &receiver)
+{
+	enqueue([=]() { return QImage(path); }, receiver);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDecoder::decodeData(const QByteArray &data, const ImageReceiver &receiver)
+{
+	enqueue([=]() { return QImage::fromData(data); }, receiver);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDecoder::enqueue(const std::function<QImage()> &decode, const ImageReceiver &receiver)
+{
+	const auto job = m_uNextJob++;
+	m_Jobs.insert(job, receiver);
+
+	m_Pool.start(new PoolTask([=]()
+	{
+		TRACE_SCOPE("decodeLogo", "logo");
+		emit logoDecoded(job, decode());
+	}));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDecoder::onLogoDecoded(quint64 job, QImage image)
+{
+	TRACE_SCOPE("onLogoDecoded", "logo");
+
+	if(false == m_Jobs.contains(job)) return;
+
+	auto receiver = m_Jobs.take(job);
+	if(nullptr != receiver) receiver(image);
+}
+//----------------------------------------------------------------------------------------------------------------------
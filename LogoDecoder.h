@@ -0,0 +1,97 @@
+#pragma once
+
+#include <functional>
+
+#include <QObject>
+
+#include <QImage>
+#include <QMap>
+#include <QThreadPool>
+
+/**
+ * @brief The LogoDecoder class decodes station logos on a pool of worker threads
+ *
+ * @note Decoding produces QImage instances only, conversion to QPixmap must happen on the gui thread. All receivers
+ * are called on the thread owning the decoder, in the order the logos finish decoding.
+ */
+class LogoDecoder : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	typedef std::function<void(QImage)> ImageReceiver;
+
+	/**
+	 * @brief LogoDecoder Default constructor, uses one worker thread per available core
+	 */
+	explicit LogoDecoder();
+
+	/**
+	 * @brief ~LogoDecoder Drops all pending jobs and waits for the running ones
+	 */
+	virtual ~LogoDecoder();
+
+	/**
+	 * @brief decodeBase64 Request decoding of base64 encoded image data
+	 * @param data The base64 encoded image data
+	 * @param receiver Called with the decoded image, the image is null if decoding failed
+	 */
+	void decodeBase64(const QByteArray &data, const ImageReceiver &receiver);
+
+	/**
+	 * @brief decodeFile Request decoding of an image file
+	 * @param path The image file to load
+	 * @param receiver Called with the decoded image, the image is null if decoding failed
+	 */
+	void decodeFile(const QString &path, const ImageReceiver &receiver);
+
+	/**
+	 * @brief decodeData Request decoding of encoded image data, e.g. a downloaded logo
+	 * @param data The image data
+	 * @param receiver Called with the decoded image, the image is null if decoding failed
+	 */
+	void decodeData(const QByteArray &data, const ImageReceiver &receiver);
+
+signals:
+
+	/**
+	 * @brief logoDecoded Emitted from the worker threads when a job is finished
+	 * @param job The job identifier
+	 * @param image The decoded image
+	 */
+	void logoDecoded(quint64 job, QImage image);
+
+private slots:
+
+	/**
+	 * @brief onLogoDecoded Dispatches a decoded image to its receiver
+	 * @param job The job identifier
+	 * @param image The decoded image
+	 */
+	void onLogoDecoded(quint64 job, QImage image);
+
+private:
+
+	/**
+	 * @brief enqueue Register the receiver and run the decode function on the pool
+	 * @param decode Produces the image, runs on a worker thread
+	 * @param receiver The receiver for the image
+	 */
+	void enqueue(const std::function<QImage()> &decode, const ImageReceiver &receiver);
+
+	/**
+	 * @brief m_uNextJob The identifier for the next job
+	 */
+	quint64 m_uNextJob;
+
+	/**
+	 * @brief m_Jobs All pending jobs
+	 */
+	QMap<quint64, ImageReceiver> m_Jobs;
+
+	/**
+	 * @brief m_Pool The worker threads, declared last so the workers are gone before anything else is destroyed
+	 */
+	QThreadPool m_Pool;
+};
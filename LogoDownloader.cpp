@@ -1,41 +1,406 @@
 #include "LogoDownloader.h"
 
 #include <QPixmap>
+#include <QTimer>
 
-LogoDownloader::LogoDownloader()
+#include "Tracer.h"
+
+namespace
+{
+
+//the maximum number of concurrent requests to a single host
+const int ciMaxConnectionsPerHost = 2;
+
+//the time after which a request is aborted, in milliseconds
+const int ciRequestTimeout = 10000;
+
+//how often a download is tried before giving up
+const int ciMaxAttempts = 4;
+
+//the delay before the first retry, doubled for each further retry, in milliseconds
+const int ciRetryDelay = 1000;
+
+/**
+ * @brief IsRetryable Check if a failed request should be tried again
+ * @param reply The finished request
+ * @return True for network errors, timeouts and server side errors
+ */
+bool IsRetryable(QNetworkReply* reply)
+{
+	const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+	//no http response at all means a network problem or a timeout
+	if(0 == status) return (QNetworkReply::NoError != reply->error());
+
+	return (500 <= status);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+LogoDownloader::LogoDownloader(const QString &cacheDirectory)
 	: QObject(nullptr)
 	, m_Manager()
+	, m_Cache(cacheDirectory)
+	, m_Jobs()
+	, m_Queues()
+	, m_Replies()
+	, m_Connections()
+	, m_uNextSequence(0)
+	, m_Decodes()
+	, m_CachedDecodes()
+	, m_uNextDecode(0)
+	, m_Decoder()
 {
 	connect(&m_Manager, &QNetworkAccessManager::finished, this, &LogoDownloader::onDownloadFinished);
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-void LogoDownloader::downloadLogo(const QUrl &url, const LogoReceiver &receiver)
+void LogoDownloader::downloadLogo(const QUrl &url, const LogoReceiver &receiver, QObject* context, int priority)
+{
+	Receiver r;
+	r.m_fReceiver = receiver;
+	r.m_pContext = context;
+	r.m_bHasContext = (nullptr != context);
+
+	//serve the cached logo once decoded, the request only asks the server whether it changed since
+	if(true == m_Cache.contains(url)) decodeCached(url, r);
+
+	const auto key = url.toString();
+	const bool pending = m_Jobs.contains(key);
+
+	auto &job = m_Jobs[key];
+
+	if(false == pending)
+	{
+		job.m_uUrl = url;
+		job.m_iPriority = priority;
+		job.m_uSequence = m_uNextSequence++;
+
+		queue(job);
+	}
+	else if(priority > job.m_iPriority)
+	{
+		//the queue position depends on the priority
+		if(true == isQueued(job)) unqueue(job);
+		job.m_iPriority = priority;
+		if(true == isQueued(job)) queue(job);
+	}
+
+	addReceiver(job.m_Receivers, r);
+
+	schedule();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::cancel(const QUrl &url)
+{
+	const auto key = url.toString();
+	dropDecodes(key, false);
+
+	if(false == m_Jobs.contains(key)) return;
+
+	auto job = m_Jobs.take(key);
+	if(true == isQueued(job)) unqueue(job);
+
+	//the finished request is ignored as the job is gone
+	if(nullptr != job.m_pReply) job.m_pReply->abort();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::setPriority(const QUrl &url, int priority)
 {
-	m_Jobs.insert(url.toString(), receiver);
+	auto it = m_Jobs.find(url.toString());
+	if((m_Jobs.end() == it) || (priority == it->m_iPriority)) return;
+
+	const auto queued = isQueued(*it);
+	if(true == queued) unqueue(*it);
+	it->m_iPriority = priority;
+	if(true == queued) queue(*it);
 
-	//issue a new request
-	QNetworkRequest request(url);
-	m_Manager.get(request);
+	schedule();
 }
 //----------------------------------------------------------------------------------------------------------------------
 
 void LogoDownloader::onDownloadFinished(QNetworkReply* reply)
 {
-	if(false == m_Jobs.contains(reply->url().toString())) return;
+	Tracer::asyncEnd("downloadLogo", "network", reinterpret_cast<quintptr>(reply));
+	TRACE_SCOPE("onDownloadFinished", "network");
+
+	reply->deleteLater();
 
-	QPixmap logo;
+	const auto host = reply->request().url().host();
+	m_Connections[host] = qMax(0, m_Connections.value(host) - 1);
 
-	if(QNetworkReply::NoError == reply->error())
+	const auto key = m_Replies.take(reply);
+
+	//the job was canceled in the meantime
+	if((false == m_Jobs.contains(key)) || (reply != m_Jobs.value(key).m_pReply))
 	{
-		logo.loadFromData(reply->readAll());
+		schedule();
+		return;
 	}
 
-	reply->deleteLater();
+	auto &job = m_Jobs[key];
+	job.m_pReply = nullptr;
+
+	//the cached logo is still valid and was already passed to the receivers
+	if(304 == reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt())
+	{
+		//unless it could not be decoded meanwhile, then it is downloaded in full
+		if(false == m_Cache.contains(job.m_uUrl))
+		{
+			queue(job);
+			schedule();
+			return;
+		}
+
+		m_Cache.touch(job.m_uUrl);
+		m_Jobs.remove(key);
+
+		schedule();
+		return;
+	}
+
+	//try again later, each retry waits twice as long as the one before
+	if((true == IsRetryable(reply)) && (ciMaxAttempts > ++job.m_iAttempts))
+	{
+		job.m_bWaitingForRetry = true;
+
+		QTimer::singleShot(ciRetryDelay << (job.m_iAttempts - 1), this, [=]()
+		{
+			//the job may have been canceled and requested again meanwhile
+			if((false == m_Jobs.contains(key)) || (false == m_Jobs[key].m_bWaitingForRetry)) return;
+
+			auto &waiting = m_Jobs[key];
+			waiting.m_bWaitingForRetry = false;
+			queue(waiting);
+
+			schedule();
+		});
+
+		schedule();
+		return;
+	}
+
+	const auto finishedJob = m_Jobs.take(key);
+	const auto data = (QNetworkReply::NoError == reply->error()) ? reply->readAll() : QByteArray();
+
+	if(true == data.isEmpty())
+	{
+		//keep showing the cached logo if the revalidation failed
+		if(false == m_Cache.contains(finishedJob.m_uUrl)) deliver(finishedJob.m_Receivers, QPixmap());
+
+		schedule();
+		return;
+	}
+
+	const auto eTag = reply->rawHeader("ETag");
+	const auto lastModified = reply->rawHeader("Last-Modified");
+
+	decode(finishedJob.m_uUrl, data, [=](QPixmap logo)
+	{
+		if(false == logo.isNull())
+		{
+			m_Cache.insert(finishedJob.m_uUrl, data, eTag, lastModified);
+
+			//a cached logo still being decoded is older than this one
+			dropDecodes(key, true);
+		}
+
+		if((false == logo.isNull()) || (false == m_Cache.contains(finishedJob.m_uUrl)))
+		{
+			deliver(finishedJob.m_Receivers, logo);
+		}
+	});
+
+	schedule();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::addReceiver(QList<Receiver> &receivers, const Receiver &receiver)
+{
+	//a new receiver for the same context replaces the old one, repeated requests must not pile up
+	if(true == receiver.m_bHasContext)
+	{
+		for(auto it = receivers.begin(); it != receivers.end();)
+		{
+			if((true == it->m_bHasContext) && ((nullptr == it->m_pContext) || (receiver.m_pContext == it->m_pContext)))
+			{
+				it = receivers.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	receivers.append(receiver);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::decodeCached(const QUrl &url, const Receiver &receiver)
+{
+	const auto key = url.toString();
+
+	//the logo is already being decoded, e.g. because the station was shown again meanwhile
+	if(true == m_CachedDecodes.contains(key))
+	{
+		addReceiver(m_Decodes[m_CachedDecodes.value(key)].m_Receivers, receiver);
+		return;
+	}
+
+	const auto id = m_uNextDecode++;
+
+	Decode d;
+	d.m_strUrl = key;
+	d.m_bCached = true;
+	d.m_Receivers.append(receiver);
+	m_Decodes.insert(id, d);
+	m_CachedDecodes.insert(key, id);
+
+	//the file is read by the worker as well, a cache hit does not touch the disk on this thread
+	m_Decoder.decodeFile(m_Cache.path(url), [=](QImage image)
+	{
+		//the request was canceled or a newer logo was delivered meanwhile
+		if(false == m_Decodes.contains(id)) return;
+
+		m_CachedDecodes.remove(key);
+		const auto decoded = m_Decodes.take(id);
+
+		//the data is gone or broken, the entry is useless
+		if(true == image.isNull())
+		{
+			m_Cache.remove(url);
+			return;
+		}
+
+		deliver(decoded.m_Receivers, QPixmap::fromImage(image));
+	});
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::decode(const QUrl &url, const QByteArray &data, const LogoReceiver &receiver)
+{
+	const auto id = m_uNextDecode++;
+
+	Decode d;
+	d.m_strUrl = url.toString();
+	m_Decodes.insert(id, d);
+
+	m_Decoder.decodeData(data, [=](QImage image)
+	{
+		//the request was canceled or a newer logo was delivered meanwhile
+		if(false == m_Decodes.contains(id)) return;
+
+		m_Decodes.remove(id);
+		receiver(QPixmap::fromImage(image));
+	});
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::dropDecodes(const QString &key, bool cachedOnly)
+{
+	for(auto it = m_Decodes.begin(); it != m_Decodes.end();)
+	{
+		if((key == it->m_strUrl) && ((false == cachedOnly) || (true == it->m_bCached)))
+		{
+			if(true == it->m_bCached) m_CachedDecodes.remove(key);
+			it = m_Decodes.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::queue(const Job &job)
+{
+	m_Queues[job.m_uUrl.host()].insert(qMakePair(-job.m_iPriority, job.m_uSequence), job.m_uUrl.toString());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::unqueue(const Job &job)
+{
+	auto queue = m_Queues.find(job.m_uUrl.host());
+	if(m_Queues.end() == queue) return;
+
+	queue->remove(qMakePair(-job.m_iPriority, job.m_uSequence));
+	if(true == queue->isEmpty()) m_Queues.erase(queue);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool LogoDownloader::isQueued(const Job &job)
+{
+	return (nullptr == job.m_pReply) && (false == job.m_bWaitingForRetry);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::schedule()
+{
+	forever
+	{
+		//only the first job of each host with a free connection is a candidate, so this depends on the hosts only
+		auto next = m_Queues.end();
+
+		for(auto it = m_Queues.begin(); it != m_Queues.end(); ++it)
+		{
+			if(ciMaxConnectionsPerHost <= m_Connections.value(it.key())) continue;
+			if((m_Queues.end() == next) || (it->firstKey() < next->firstKey())) next = it;
+		}
 
-	auto receiver = m_Jobs.value(reply->url().toString());
-	if(nullptr != receiver) receiver(logo);
+		if(m_Queues.end() == next) break;
 
-	m_Jobs.remove(reply->url().toString());
+		const auto key = next->first();
+		next->erase(next->begin());
+		if(true == next->isEmpty()) m_Queues.erase(next);
+
+		start(m_Jobs[key]);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::start(Job &job)
+{
+	QNetworkRequest request(job.m_uUrl);
+
+	//a cached logo only needs to be revalidated
+	if(true == m_Cache.contains(job.m_uUrl))
+	{
+		const auto entry = m_Cache.entry(job.m_uUrl);
+		if(false == entry.m_baETag.isEmpty()) request.setRawHeader("If-None-Match", entry.m_baETag);
+		if(false == entry.m_baLastModified.isEmpty()) request.setRawHeader("If-Modified-Since", entry.m_baLastModified);
+	}
+
+	auto reply = m_Manager.get(request);
+	if(true == Tracer::isEnabled())
+	{
+		Tracer::asyncBegin("downloadLogo", "network", reinterpret_cast<quintptr>(reply), job.m_uUrl.toString());
+	}
+
+	job.m_pReply = reply;
+	m_Replies.insert(reply, job.m_uUrl.toString());
+	m_Connections[job.m_uUrl.host()] += 1;
+
+	//the timer is owned by the reply, so it is gone together with the request
+	auto timer = new QTimer(reply);
+	timer->setSingleShot(true);
+	connect(timer, &QTimer::timeout, reply, &QNetworkReply::abort);
+	timer->start(ciRequestTimeout);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoDownloader::deliver(const QList<Receiver> &receivers, const QPixmap &logo)
+{
+	for(const auto &r : receivers)
+	{
+		//the receiver belongs to an object which no longer exists
+		if((true == r.m_bHasContext) && (nullptr == r.m_pContext)) continue;
+
+		if(nullptr != r.m_fReceiver) r.m_fReceiver(logo);
+	}
 }
 //----------------------------------------------------------------------------------------------------------------------
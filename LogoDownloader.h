@@ -4,14 +4,29 @@
 
 #include <QObject>
 
+#include <QHash>
+#include <QMap>
+#include <QPointer>
 #include <QUrl>
 
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 
+#include "LogoCache.h"
+#include "LogoDecoder.h"
+
 /**
  * @brief The LogoDownloader class is a small helper for logo downloads
+ *
+ * Requests for the same url are coalesced into a single download, any number of receivers can wait for it. The number
+ * of concurrent connections per host is limited, pending requests are started by priority. Each request is subject to
+ * a timeout and failed requests are retried with exponential backoff.
+ *
+ * @note Downloaded logos are kept in a persistent LogoCache. A cached logo is passed to the receiver as soon as it is
+ * decoded and revalidated in the background with a conditional request, the receiver is called a second time only if
+ * the server returns a changed logo. All logos are decoded on worker threads, cached ones are read there as well and
+ * only once per url while a decode is pending. The receivers are called on the thread owning the downloader.
  */
 class LogoDownloader : public QObject
 {
@@ -23,15 +38,33 @@ public:
 
 	/**
 	 * @brief LogoDownloader Default constructor
-	 * @param parent
+	 * @param cacheDirectory Where to store downloaded logos, the default location is used if empty
 	 */
-	explicit LogoDownloader();
+	explicit LogoDownloader(const QString &cacheDirectory = QString());
 
 	/**
 	 * @brief downloadLogo Request a logo for download
 	 * @param url The logo to download
+	 * @param receiver Called with the logo, the logo is null if the download failed
+	 * @param context If set, the receiver is dropped when the context is destroyed and a later request with the same
+	 * context for the same url replaces this receiver instead of adding another one
+	 * @param priority Pending requests with a higher priority are started first, a pending request for the same url
+	 * is raised to this priority
+	 */
+	void downloadLogo(const QUrl &url, const LogoReceiver &receiver, QObject* context = nullptr, int priority = 0);
+
+	/**
+	 * @brief cancel Abort the request for an url, none of its receivers will be called
+	 * @param url The logo url
 	 */
-	void downloadLogo(const QUrl &url, const LogoReceiver &receiver);
+	void cancel(const QUrl &url);
+
+	/**
+	 * @brief setPriority Change the priority of a pending request
+	 * @param url The logo url
+	 * @param priority The new priority
+	 */
+	void setPriority(const QUrl &url, int priority);
 
 private slots:
 
@@ -43,13 +76,183 @@ private slots:
 
 private:
 
+	/**
+	 * @brief The Receiver struct describes a single party waiting for a logo
+	 */
+	struct Receiver
+	{
+		//! The function to call
+		LogoReceiver m_fReceiver;
+
+		//! The optional context object
+		QPointer<QObject> m_pContext;
+
+		//! True if a context was given, used to detect destroyed contexts
+		bool m_bHasContext = false;
+	};
+
+	/**
+	 * @brief The Job struct describes the download of a single url
+	 */
+	struct Job
+	{
+		//! The url to download
+		QUrl m_uUrl;
+
+		//! Everyone waiting for the logo
+		QList<Receiver> m_Receivers;
+
+		//! The priority, higher priorities are started first
+		int m_iPriority = 0;
+
+		//! Used to start jobs of the same priority in the order they were requested
+		quint64 m_uSequence = 0;
+
+		//! The number of failed attempts so far
+		int m_iAttempts = 0;
+
+		//! The running request, null if not started yet
+		QNetworkReply* m_pReply = nullptr;
+
+		//! True while waiting before the next attempt
+		bool m_bWaitingForRetry = false;
+	};
+
+	/**
+	 * @brief The Decode struct describes logo data being decoded on the workers
+	 */
+	struct Decode
+	{
+		//! The url of the logo
+		QString m_strUrl;
+
+		//! True for data from the cache, false for downloaded data
+		bool m_bCached = false;
+
+		//! Everyone waiting for the logo from the cache, empty for downloaded data
+		QList<Receiver> m_Receivers;
+	};
+
+	/**
+	 * @brief addReceiver Add a receiver to a list, replacing the receivers of the same or of a destroyed context
+	 * @param receivers The receivers waiting for a logo
+	 * @param receiver The new receiver
+	 */
+	static void addReceiver(QList<Receiver> &receivers, const Receiver &receiver);
+
+	/**
+	 * @brief decodeCached Read and decode a cached logo on the workers, requests for a logo already being decoded only
+	 * add their receiver to it
+	 * @param url The url of the logo, must be cached
+	 * @param receiver Called with the logo unless it cannot be decoded, then the cache entry is removed instead
+	 */
+	void decodeCached(const QUrl &url, const Receiver &receiver);
+
+	/**
+	 * @brief decode Decode downloaded logo data on the workers
+	 * @param url The url of the logo
+	 * @param data The encoded logo
+	 * @param receiver Called with the logo, the logo is null if decoding failed. Not called if the decode is dropped.
+	 */
+	void decode(const QUrl &url, const QByteArray &data, const LogoReceiver &receiver);
+
+	/**
+	 * @brief dropDecodes Make sure the results of running decodes are not delivered
+	 * @param key The url of the logo
+	 * @param cachedOnly True to only drop the decodes of data from the cache
+	 */
+	void dropDecodes(const QString &key, bool cachedOnly);
+
+	/**
+	 * @brief queue Put a job into the queue of its host, to be started by schedule()
+	 * @param job The job, neither running nor waiting for a retry
+	 */
+	void queue(const Job &job);
+
+	/**
+	 * @brief unqueue Take a job out of the queue of its host
+	 * @param job The job, must be queued with its current priority
+	 */
+	void unqueue(const Job &job);
+
+	/**
+	 * @brief isQueued Check if a job is in the queue of its host
+	 * @param job The job
+	 * @return True if the job is neither running nor waiting for a retry
+	 */
+	static bool isQueued(const Job &job);
+
+	/**
+	 * @brief schedule Start queued jobs as long as the per host limits allow
+	 */
+	void schedule();
+
+	/**
+	 * @brief start Issue the request for a job
+	 * @param job The job to start
+	 */
+	void start(Job &job);
+
+	/**
+	 * @brief deliver Pass a logo to all receivers whose context still exists
+	 * @param receivers The receivers of a job or of a cached logo
+	 * @param logo The logo
+	 */
+	static void deliver(const QList<Receiver> &receivers, const QPixmap &logo);
+
 	/**
 	 * @brief m_Manager The instance for the download request
 	 */
 	QNetworkAccessManager m_Manager;
 
 	/**
-	 * @brief m_Jobs All jobs
+	 * @brief m_Cache The persistent store for downloaded logos
+	 */
+	LogoCache m_Cache;
+
+	/**
+	 * @brief m_Jobs All jobs, keyed by url
+	 */
+	QMap<QString, Job> m_Jobs;
+
+	/**
+	 * @brief m_Queues The urls of the jobs waiting to be started by host, each ordered by descending priority and then
+	 * by request order, so the next job of a host is always the first one
+	 */
+	QMap<QString, QMap<QPair<int, quint64>, QString>> m_Queues;
+
+	/**
+	 * @brief m_Replies The url of each running request
+	 */
+	QMap<QNetworkReply*, QString> m_Replies;
+
+	/**
+	 * @brief m_Connections The number of running requests per host
+	 */
+	QMap<QString, int> m_Connections;
+
+	/**
+	 * @brief m_uNextSequence The sequence number for the next job
+	 */
+	quint64 m_uNextSequence;
+
+	/**
+	 * @brief m_Decodes The running decodes whose results are still wanted, by decode number
+	 */
+	QMap<quint64, Decode> m_Decodes;
+
+	/**
+	 * @brief m_CachedDecodes The number of the running decode of each cached logo, by url
+	 */
+	QHash<QString, quint64> m_CachedDecodes;
+
+	/**
+	 * @brief m_uNextDecode The number of the next decode
+	 */
+	quint64 m_uNextDecode;
+
+	/**
+	 * @brief m_Decoder Decodes the logos, declared last so the workers are gone before anything else is destroyed
 	 */
-	QMap<QString, LogoReceiver> m_Jobs;
+	LogoDecoder m_Decoder;
 };
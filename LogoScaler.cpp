@@ -0,0 +1,392 @@
+#include "LogoScaler.h"
+
+#include "PoolTask.h"
+#include "Tracer.h"
+
+namespace
+{
+
+/**
+ * @brief Bytes The memory used by a logo
+ * @param logo The logo
+ * @return The used memory in bytes
+ */
+qint64 Bytes(const QImage &logo)
+{
+	return static_cast<qint64>(logo.bytesPerLine()) * logo.height();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Bytes The memory used by a rendition
+ * @param rendition The rendition
+ * @return The used memory in bytes
+ */
+qint64 Bytes(const QPixmap &rendition)
+{
+	return static_cast<qint64>(rendition.width()) * rendition.height() * rendition.depth() / 8;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+LogoScaler::LogoScaler()
+	: QObject(nullptr)
+	, m_uGeneration(0)
+	, m_MaximumSize()
+	, m_iMemoryBudget(0)
+	, m_iMemory(0)
+	, m_uLastUse(0)
+	, m_uHits(0)
+	, m_uMisses(0)
+	, m_Logos()
+	, m_LastUse()
+	, m_Recency()
+	, m_Ingesting()
+	, m_Targets()
+	, m_Renditions()
+	, m_StationRenditions()
+	, m_Requested()
+	, m_Receivers()
+	, m_Pool()
+{
+	m_Pool.setMaxThreadCount(1);
+
+	//the signal is emitted from the worker, the receivers must be called on our own thread
+	connect(this, &LogoScaler::logoScaled, this, &LogoScaler::onLogoScaled, Qt::QueuedConnection);
+	connect(this, &LogoScaler::logoIngested, this, &LogoScaler::onLogoIngested, Qt::QueuedConnection);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+LogoScaler::~LogoScaler()
+{
+	m_Pool.clear();
+	m_Pool.waitForDone();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QImage LogoScaler::scaleToRectangle(const QImage &logo, const QSize &size, double factor)
+{
+	if((true == logo.isNull()) || (true == size.isEmpty())) return logo;
+
+	double heightRatio = (1.0 * logo.height()) / (1.0 * size.height());
+	double widthRatio = (1.0 * logo.width()) / (1.0 * size.width());
+
+	if((1.0 < widthRatio) && (widthRatio >= heightRatio))
+	{
+		return logo.scaledToWidth(size.width() * factor, Qt::SmoothTransformation);
+	}
+	else if((1.0 < heightRatio) && (heightRatio > widthRatio))
+	{
+		return logo.scaledToHeight(size.height() * factor, Qt::SmoothTransformation);
+	}
+
+	return logo;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::setLogo(int station, const QImage &logo)
+{
+	//a downscaling still running for the previous logo is outdated
+	m_Ingesting.remove(station);
+
+	const auto tooLarge = (false == m_MaximumSize.isEmpty()) &&
+												((logo.width() > m_MaximumSize.width()) || (logo.height() > m_MaximumSize.height()));
+
+	if((true == logo.isNull()) || (false == tooLarge))
+	{
+		store(station, logo);
+		return;
+	}
+
+	//renditions requested meanwhile wait for the downscaled logo
+	removeLogo(station);
+
+	const auto generation = ++m_uGeneration;
+	const auto maximumSize = m_MaximumSize;
+
+	m_Ingesting.insert(station, generation);
+
+	m_Pool.start(new PoolTask([=]()
+	{
+		TRACE_SCOPE("ingestLogo", "logo");
+		emit logoIngested(station, generation, scaleToRectangle(logo, maximumSize));
+	}));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::setMaximumSize(const QSize &size)
+{
+	m_MaximumSize = size;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::setMemoryBudget(qint64 bytes)
+{
+	m_iMemoryBudget = bytes;
+	evict(-1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 LogoScaler::memoryBudget() const
+{
+	return m_iMemoryBudget;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 LogoScaler::memory() const
+{
+	return m_iMemory;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::removeLogo(int station)
+{
+	m_iMemory -= Bytes(m_Logos.take(station));
+	m_Recency.remove(m_LastUse.take(station));
+	m_Ingesting.remove(station);
+
+	dropRenditions(station);
+
+	//renderings of the old logo are discarded, the waiting receivers get the next logo
+	for(auto it = m_Requested.begin(); it != m_Requested.end();)
+	{
+		if(station != it.value().m_iStation)
+		{
+			++it;
+		}
+		else if(false == m_Receivers.contains(it.key()))
+		{
+			it = m_Requested.erase(it);
+		}
+		else
+		{
+			it.value().m_uGeneration = 0;
+			++it;
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::addTarget(const QSize &size, double factor, qreal devicePixelRatio)
+{
+	for(const auto &target : m_Targets)
+	{
+		if((size == target.m_Size) && (factor == target.m_dFactor) && (devicePixelRatio == target.m_dDevicePixelRatio))
+		{
+			return;
+		}
+	}
+
+	const Target target{size, factor, devicePixelRatio};
+	m_Targets.append(target);
+
+	for(auto it = m_Logos.cbegin(); it != m_Logos.cend(); ++it)
+	{
+		if(true == it.value().isNull()) continue;
+
+		const auto k = key(it.key(), target);
+		if((false == m_Renditions.contains(k)) && (false == m_Requested.contains(k))) render(it.key(), target);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::invalidate()
+{
+	m_Targets.clear();
+
+	for(const auto &rendition : m_Renditions) m_iMemory -= Bytes(rendition);
+	m_Renditions.clear();
+	m_StationRenditions.clear();
+
+	//renderings nobody is waiting for are no longer needed, their results are discarded
+	for(auto it = m_Requested.begin(); it != m_Requested.end();)
+	{
+		if(false == m_Receivers.contains(it.key())) it = m_Requested.erase(it);
+		else ++it;
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::scaledLogo(int station, const QSize &size, double factor, qreal devicePixelRatio,
+														const LogoReceiver &receiver)
+{
+	const Target target{size, factor, devicePixelRatio};
+	const auto k = key(station, target);
+
+	touch(station);
+
+	if(true == m_Renditions.contains(k))
+	{
+		++m_uHits;
+		if(nullptr != receiver) receiver(m_Renditions.value(k));
+		return;
+	}
+
+	//stations without a logo have nothing to scale
+	if((true == m_Logos.contains(station)) && (true == m_Logos.value(station).isNull()))
+	{
+		if(nullptr != receiver) receiver(QPixmap());
+		return;
+	}
+
+	++m_uMisses;
+
+	m_Receivers[k].append(receiver);
+
+	if(true == m_Requested.contains(k)) return;
+
+	if(true == m_Logos.contains(station))
+	{
+		render(station, target);
+	}
+	else
+	{
+		//rendered as soon as the logo is set
+		m_Requested.insert(k, Request{station, target, 0});
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 LogoScaler::hits() const
+{
+	return m_uHits;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 LogoScaler::misses() const
+{
+	return m_uMisses;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::onLogoScaled(QString key, quint64 generation, QImage image)
+{
+	//the rendering is outdated or nobody needs it anymore
+	if((false == m_Requested.contains(key)) || (generation != m_Requested.value(key).m_uGeneration)) return;
+
+	const auto request = m_Requested.take(key);
+
+	auto logo = QPixmap::fromImage(image);
+	logo.setDevicePixelRatio(request.m_Target.m_dDevicePixelRatio);
+
+	m_iMemory += Bytes(logo) - Bytes(m_Renditions.value(key));
+	if(false == m_Renditions.contains(key)) m_StationRenditions[request.m_iStation].append(key);
+	m_Renditions.insert(key, logo);
+
+	for(const auto &receiver : m_Receivers.take(key)) { if(nullptr != receiver) receiver(logo); }
+
+	evict(request.m_iStation);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::onLogoIngested(int station, quint64 generation, QImage image)
+{
+	//the logo was set again or removed meanwhile
+	if((false == m_Ingesting.contains(station)) || (generation != m_Ingesting.value(station))) return;
+
+	m_Ingesting.remove(station);
+
+	store(station, image);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString LogoScaler::key(int station, const Target &target)
+{
+	return QString::number(station) + QLatin1Char('\n') +
+				 QString::number(target.m_Size.width()) + QLatin1Char('x') + QString::number(target.m_Size.height()) +
+				 QLatin1Char('*') + QString::number(target.m_dFactor) +
+				 QLatin1Char('@') + QString::number(target.m_dDevicePixelRatio);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::render(int station, const Target &target)
+{
+	const auto k = key(station, target);
+	const auto logo = m_Logos.value(station);
+	const auto generation = ++m_uGeneration;
+
+	m_Requested.insert(k, Request{station, target, generation});
+
+	m_Pool.start(new PoolTask([=]()
+	{
+		TRACE_SCOPE("scaleLogo", "logo");
+
+		const auto size = target.m_Size * target.m_dDevicePixelRatio;
+		emit logoScaled(k, generation, scaleToRectangle(logo, size, target.m_dFactor));
+	}));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::store(int station, const QImage &logo)
+{
+	m_iMemory += Bytes(logo) - Bytes(m_Logos.value(station));
+	m_Logos.insert(station, logo);
+	touch(station);
+
+	//all renditions of the previous logo are outdated
+	dropRenditions(station);
+
+	//restart everything requested for this station, or answer with an empty logo
+	for(const auto &k : m_Requested.keys())
+	{
+		const auto request = m_Requested.value(k);
+		if(station != request.m_iStation) continue;
+
+		if(true == logo.isNull())
+		{
+			m_Requested.remove(k);
+			for(const auto &receiver : m_Receivers.take(k)) { if(nullptr != receiver) receiver(QPixmap()); }
+		}
+		else
+		{
+			render(station, request.m_Target);
+		}
+	}
+
+	if(true == logo.isNull()) return;
+
+	for(const auto &target : m_Targets)
+	{
+		if(false == m_Requested.contains(key(station, target))) render(station, target);
+	}
+
+	evict(station);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::dropRenditions(int station)
+{
+	for(const auto &k : m_StationRenditions.take(station)) m_iMemory -= Bytes(m_Renditions.take(k));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::touch(int station)
+{
+	const auto lastUse = ++m_uLastUse;
+
+	m_Recency.remove(m_LastUse.value(station, 0));
+	m_LastUse.insert(station, lastUse);
+
+	if(false == m_Logos.value(station).isNull()) m_Recency.insert(lastUse, station);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoScaler::evict(int keep)
+{
+	if(0 >= m_iMemoryBudget) return;
+
+	while(m_iMemoryBudget < m_iMemory)
+	{
+		//only a single station is kept, so at most one entry is skipped
+		auto it = m_Recency.cbegin();
+		if((m_Recency.cend() != it) && (keep == it.value())) ++it;
+		if(m_Recency.cend() == it) return;
+
+		const auto oldest = it.value();
+
+		removeLogo(oldest);
+		emit logoEvicted(oldest);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <functional>
+
+#include <QObject>
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMap>
+#include <QPixmap>
+#include <QSize>
+#include <QStringList>
+#include <QThreadPool>
+
+/**
+ * @brief The LogoScaler class keeps pre-scaled renditions of the station logos
+ *
+ * A rendition is identified by the registry id of the station, the target size, the scaling factor and the device
+ * pixel ratio. Each target which was registered with addTarget() is rendered in the background as soon as a station
+ * logo is set, so displaying a logo later does not need any resampling on the gui thread.
+ *
+ * Logos larger than the maximum size are downscaled in the background before they are stored. Logos and renditions are
+ * kept within a memory budget, the logos of the stations shown least recently are evicted first. An evicted logo must
+ * be set again before its renditions can be served, logoEvicted() tells when this is the case.
+ *
+ * @note Scaling produces QImage instances only, conversion to QPixmap happens on the thread owning the scaler
+ */
+class LogoScaler : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	typedef std::function<void(QPixmap)> LogoReceiver;
+
+	/**
+	 * @brief LogoScaler Default constructor, uses a single background thread
+	 */
+	explicit LogoScaler();
+
+	/**
+	 * @brief ~LogoScaler Drops all pending jobs and waits for the running one
+	 */
+	virtual ~LogoScaler();
+
+	/**
+	 * @brief scaleToRectangle Scale a logo down to fit into a rectangle, smaller logos are not scaled
+	 * @param logo The logo to scale
+	 * @param size The size of the rectangle in device pixels
+	 * @param factor The fraction of the rectangle to fill
+	 * @return The scaled logo
+	 */
+	static QImage scaleToRectangle(const QImage &logo, const QSize &size, double factor = 1.0);
+
+	/**
+	 * @brief setLogo Set the full resolution logo for a station, drops all renditions of the station
+	 * @param station The station id
+	 * @param logo The logo, may be null if the station has no logo
+	 */
+	void setLogo(int station, const QImage &logo);
+
+	/**
+	 * @brief setMaximumSize Logos are downscaled to fit into this size before they are stored
+	 * @param size The largest size a logo is displayed at in device pixels, empty to store logos as they are
+	 */
+	void setMaximumSize(const QSize &size);
+
+	/**
+	 * @brief setMemoryBudget Limit the memory used by the logos and renditions, evicts logos if needed
+	 * @param bytes The budget in bytes, 0 for no limit
+	 */
+	void setMemoryBudget(qint64 bytes);
+
+	/**
+	 * @brief memoryBudget The memory the logos and renditions may use
+	 * @return The budget in bytes, 0 for no limit
+	 */
+	qint64 memoryBudget() const;
+
+	/**
+	 * @brief memory The memory currently used by the logos and renditions
+	 * @return The used memory in bytes
+	 */
+	qint64 memory() const;
+
+	/**
+	 * @brief removeLogo Forget the logo and all renditions of a station, e.g. when its logo source changed
+	 * @param station The station id
+	 *
+	 * @note Pending requests are kept and served once a logo is set again
+	 */
+	void removeLogo(int station);
+
+	/**
+	 * @brief addTarget Render all logos for this target in the background, now and whenever a logo is set
+	 * @param size The target size in logical pixels
+	 * @param factor The fraction of the target to fill
+	 * @param devicePixelRatio The device pixel ratio of the screen showing the logo
+	 */
+	void addTarget(const QSize &size, double factor, qreal devicePixelRatio);
+
+	/**
+	 * @brief invalidate Drop all renditions and targets, e.g. when the target widgets were resized
+	 */
+	void invalidate();
+
+	/**
+	 * @brief scaledLogo Request a rendition of a station logo
+	 * @param station The station id
+	 * @param size The target size in logical pixels
+	 * @param factor The fraction of the target to fill
+	 * @param devicePixelRatio The device pixel ratio of the screen showing the logo
+	 * @param receiver Called with the rendition, immediately if it is available. If the station logo is not set yet,
+	 * the receiver is called as soon as it is. The pixmap is null if the station has no logo.
+	 */
+	void scaledLogo(int station, const QSize &size, double factor, qreal devicePixelRatio,
+									const LogoReceiver &receiver);
+
+	/**
+	 * @brief hits The number of requests served from a ready rendition
+	 * @return The hit counter
+	 */
+	quint64 hits() const;
+
+	/**
+	 * @brief misses The number of requests which had to wait for a rendition
+	 * @return The miss counter
+	 */
+	quint64 misses() const;
+
+signals:
+
+	/**
+	 * @brief logoScaled Emitted from the worker thread when a rendition is finished
+	 * @param key The rendition key
+	 * @param generation The generation the rendition was started in
+	 * @param image The scaled image
+	 */
+	void logoScaled(QString key, quint64 generation, QImage image);
+
+	/**
+	 * @brief logoIngested Emitted from the worker thread when a logo was downscaled for storage
+	 * @param station The station id
+	 * @param generation The generation the downscaling was started in
+	 * @param image The downscaled logo
+	 */
+	void logoIngested(int station, quint64 generation, QImage image);
+
+	/**
+	 * @brief logoEvicted Emitted when the logo of a station was dropped to stay within the memory budget
+	 * @param station The station id
+	 */
+	void logoEvicted(int station);
+
+private slots:
+
+	/**
+	 * @brief onLogoScaled Stores a finished rendition and passes it to the waiting receivers
+	 * @param key The rendition key
+	 * @param generation The generation the rendition was started in
+	 * @param image The scaled image
+	 */
+	void onLogoScaled(QString key, quint64 generation, QImage image);
+
+	/**
+	 * @brief onLogoIngested Stores a downscaled logo
+	 * @param station The station id
+	 * @param generation The generation the downscaling was started in
+	 * @param image The downscaled logo
+	 */
+	void onLogoIngested(int station, quint64 generation, QImage image);
+
+private:
+
+	/**
+	 * @brief The Target struct describes the geometry of a single rendition
+	 */
+	struct Target
+	{
+		//! The target size in logical pixels
+		QSize m_Size;
+
+		//! The fraction of the target to fill
+		double m_dFactor;
+
+		//! The device pixel ratio of the screen showing the logo
+		qreal m_dDevicePixelRatio;
+	};
+
+	/**
+	 * @brief The Request struct describes a rendition which was requested but is not finished yet
+	 */
+	struct Request
+	{
+		//! The station id
+		int m_iStation;
+
+		//! The target geometry
+		Target m_Target;
+
+		//! The generation the rendering was started in, 0 if it was not started yet
+		quint64 m_uGeneration;
+	};
+
+	/**
+	 * @brief key Build the key identifying a rendition
+	 * @param station The station id
+	 * @param target The target geometry
+	 * @return The rendition key
+	 */
+	static QString key(int station, const Target &target);
+
+	/**
+	 * @brief render Start rendering a station logo for a target in the background
+	 * @param station The station id
+	 * @param target The target geometry
+	 */
+	void render(int station, const Target &target);
+
+	/**
+	 * @brief store Keep a logo which fits the maximum size and start rendering all targets for it
+	 * @param station The station id
+	 * @param logo The logo, may be null if the station has no logo
+	 */
+	void store(int station, const QImage &logo);
+
+	/**
+	 * @brief dropRenditions Drop all finished renditions of a station
+	 * @param station The station id
+	 */
+	void dropRenditions(int station);
+
+	/**
+	 * @brief touch Mark the logo of a station as recently shown
+	 * @param station The station id
+	 */
+	void touch(int station);
+
+	/**
+	 * @brief evict Drop the logos of the stations shown least recently until the memory budget is met
+	 * @param keep The station which must not be evicted, usually the one just stored, -1 for none
+	 */
+	void evict(int keep);
+
+	/**
+	 * @brief m_uGeneration Incremented whenever a rendering is started, results of outdated renderings are discarded
+	 */
+	quint64 m_uGeneration;
+
+	/**
+	 * @brief m_MaximumSize Logos are downscaled to fit into this size in device pixels, empty for no limit
+	 */
+	QSize m_MaximumSize;
+
+	/**
+	 * @brief m_iMemoryBudget The memory the logos and renditions may use in bytes, 0 for no limit
+	 */
+	qint64 m_iMemoryBudget;
+
+	/**
+	 * @brief m_iMemory The memory used by the logos and renditions in bytes, updated whenever one is added or dropped
+	 */
+	qint64 m_iMemory;
+
+	/**
+	 * @brief m_uLastUse Incremented whenever a logo is shown
+	 */
+	quint64 m_uLastUse;
+
+	/**
+	 * @brief m_uHits The hit counter
+	 */
+	quint64 m_uHits;
+
+	/**
+	 * @brief m_uMisses The miss counter
+	 */
+	quint64 m_uMisses;
+
+	/**
+	 * @brief m_Logos The full resolution logo of each station
+	 */
+	QMap<int, QImage> m_Logos;
+
+	/**
+	 * @brief m_LastUse When each logo was shown the last time, in m_uLastUse ticks
+	 */
+	QHash<int, quint64> m_LastUse;
+
+	/**
+	 * @brief m_Recency The stations with a logo by the tick they were shown last, the least recently shown first
+	 *
+	 * @note Stations without a logo use no memory, they are left out so evict() never has to skip them
+	 */
+	QMap<quint64, int> m_Recency;
+
+	/**
+	 * @brief m_Ingesting The logos being downscaled and the generation of the running downscaling
+	 */
+	QHash<int, quint64> m_Ingesting;
+
+	/**
+	 * @brief m_Targets All targets rendered in advance
+	 */
+	QList<Target> m_Targets;
+
+	/**
+	 * @brief m_Renditions All finished renditions
+	 */
+	QHash<QString, QPixmap> m_Renditions;
+
+	/**
+	 * @brief m_StationRenditions The keys of the finished renditions of each station
+	 */
+	QHash<int, QStringList> m_StationRenditions;
+
+	/**
+	 * @brief m_Requested All renditions requested but not finished yet
+	 */
+	QHash<QString, Request> m_Requested;
+
+	/**
+	 * @brief m_Receivers Everyone waiting for a rendition
+	 */
+	QHash<QString, QList<LogoReceiver>> m_Receivers;
+
+	/**
+	 * @brief m_Pool The worker thread, declared last so the worker is gone before anything else is destroyed
+	 */
+	QThreadPool m_Pool;
+};
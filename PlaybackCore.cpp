@@ -0,0 +1,592 @@
+#include "PlaybackCore.h"
+
+#include "StreamReader.h"
+#include "Tracer.h"
+
+namespace
+{
+
+//full volume when starting and switching stations
+const int ciDefaultVolume = 100;
+
+//the number of previously played stations considered for standby players
+const int ciMaxStationHistory = 5;
+
+//metadata changes within this interval are reported together, in milliseconds
+const int ciMetadataInterval = 16;
+
+//the delay of the first station probes after startup, so they do not slow down the first station, in milliseconds
+const int ciProbeDelay = 10000;
+
+//how often the stations are probed, in milliseconds
+const int ciProbeInterval = 30 * 60 * 1000;
+
+//stations probed less than this many seconds ago are not probed again
+const qint64 ciProbeMaxAge = 30 * 60;
+
+}
+
+PlaybackCore::PlaybackCore(const QString &stationsFileName, QObject* parent)
+	: QObject(parent)
+	, m_strStationsFile(stationsFileName)
+	, m_StationModel()
+	, m_StationCatalog()
+	, m_StationReader(new StationReader(), [](StationReader* r) { r->deleteLater(); })
+	, m_iCurrentStation(-1)
+	, m_CurrentStation(std::make_shared<const StationInformation>())
+	, m_strCurrentUrl()
+	, m_Player(StandbyPlayers::createPlayer())
+	, m_iStreamBuffer(0)
+	, m_iTimeShiftSeconds(0)
+	, m_iTimeShiftSize(0)
+	, m_StandbyPlayers(new StandbyPlayers(), [](StandbyPlayers* s) { s->deleteLater(); })
+	, m_StationHistory()
+	, m_StationProber()
+	, m_ProbeTimer()
+	, m_ShownStations()
+	, m_bIdle(false)
+	, m_bProbeDeferred(false)
+	, m_bStandbyDeferred(false)
+	, m_MetaDataKeys()
+	, m_MetadataTimer()
+{
+	qRegisterMetaType<StationInformation>();
+
+	connectPlayer();
+
+	m_MetadataTimer.setSingleShot(true);
+	m_MetadataTimer.setInterval(ciMetadataInterval);
+	connect(&m_MetadataTimer, &QTimer::timeout, this, &PlaybackCore::metaDataChanged);
+
+	//the probes only read response headers, still they leave the bandwidth to the playing station
+	m_StationProber.setBusyCheck([=]()
+	{
+		const auto reader = StreamReader::find(m_Player.get());
+		return ((nullptr != reader) && (true == reader->isBuffering())) ||
+					 (QMediaPlayer::LoadingMedia == m_Player->mediaStatus()) ||
+					 (QMediaPlayer::StalledMedia == m_Player->mediaStatus());
+	});
+
+	connect(this, &PlaybackCore::playerStateChanged, this, [=](QMediaPlayer::State state)
+	{
+		m_StationProber.setThrottled(QMediaPlayer::PlayingState == state);
+	});
+	connect(&m_StationProber, &StationProber::resultChanged, this, &PlaybackCore::stationProbed);
+
+	m_ProbeTimer.setInterval(ciProbeInterval);
+	connect(&m_ProbeTimer, &QTimer::timeout, this, &PlaybackCore::probeStations);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+PlaybackCore::~PlaybackCore()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::start()
+{
+	{
+		TRACE_SCOPE("loadStations", "catalog");
+
+		//a compiled catalog is mapped and read in place, the json file is only parsed if there is no up to date catalog
+		if((true == m_StationCatalog.open(m_strStationsFile)) || (true == m_StationCatalog.openFor(m_strStationsFile)))
+		{
+			m_StationModel.setStations(m_StationCatalog.stations());
+		}
+		else
+		{
+			m_StationModel.setStations(StationReader::readFile(m_strStationsFile));
+		}
+	}
+
+	m_iCurrentStation = -1;
+
+	//later changes of the file are merged while playing
+	m_StationReader->watch(m_strStationsFile, [=](QList<StationInformation> stations) { reloadStations(stations); });
+
+	m_ProbeTimer.start();
+	QTimer::singleShot(ciProbeDelay, this, &PlaybackCore::probeStations);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::setStandbyPlayers(int count, qint64 memoryBudget)
+{
+	m_StandbyPlayers->setCapacity(count, memoryBudget);
+	prepareStandbyPlayers();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::setStreamBuffer(int milliseconds)
+{
+	milliseconds = qMax(0, milliseconds);
+	if(milliseconds == m_iStreamBuffer) return;
+
+	m_iStreamBuffer = milliseconds;
+	m_StandbyPlayers->setStreamBuffer(m_iStreamBuffer);
+
+	//the station played on startup is connected again, so it gets the buffer as well
+	if(QMediaPlayer::PlayingState == m_Player->state())
+	{
+		attachStream();
+		m_Player->play();
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::setTimeShift(int seconds, qint64 size)
+{
+	m_iTimeShiftSeconds = qMax(0, seconds);
+	m_iTimeShiftSize = qMax<qint64>(0, size);
+
+	const auto reader = StreamReader::find(m_Player.get());
+	if(nullptr != reader) reader->setTimeShift(m_iTimeShiftSeconds, m_iTimeShiftSize);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::setIdle(bool idle)
+{
+	if(idle == m_bIdle) return;
+
+	m_bIdle = idle;
+
+	if(true == m_bIdle)
+	{
+		//the standby players are connected again when somebody could switch stations
+		if(0 < m_StandbyPlayers->capacity())
+		{
+			m_StandbyPlayers->prepare(QStringList());
+			m_bStandbyDeferred = true;
+		}
+	}
+	else
+	{
+		if(true == m_bStandbyDeferred) prepareStandbyPlayers();
+		if(true == m_bProbeDeferred) probeStations();
+
+		m_bStandbyDeferred = false;
+		m_bProbeDeferred = false;
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::setShownStations(const QList<int> &ids)
+{
+	m_ShownStations = ids;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StationModel& PlaybackCore::stations()
+{
+	return m_StationModel;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+const StationCatalog& PlaybackCore::catalog() const
+{
+	return m_StationCatalog;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+const StationProber& PlaybackCore::prober() const
+{
+	return m_StationProber;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QStringList PlaybackCore::stationUrls(const StationRecord &station)
+{
+	return QStringList() << station->m_strMediaUrl << station->m_MirrorUrls;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool PlaybackCore::isDead(const StationRecord &station) const
+{
+	return m_StationProber.isDead(stationUrls(station));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int PlaybackCore::currentId() const
+{
+	return m_iCurrentStation;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StationRecord PlaybackCore::currentStation() const
+{
+	return m_CurrentStation;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString PlaybackCore::currentUrl() const
+{
+	return m_strCurrentUrl;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QMediaPlayer* PlaybackCore::player() const
+{
+	return m_Player.get();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QMediaPlayer::State PlaybackCore::playerState() const
+{
+	return m_Player->state();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QMediaPlayer::MediaStatus PlaybackCore::mediaStatus() const
+{
+	return m_Player->mediaStatus();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int PlaybackCore::volume() const
+{
+	return m_Player->volume();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool PlaybackCore::isTimeShifted() const
+{
+	const auto reader = StreamReader::find(m_Player.get());
+	return (nullptr != reader) && (true == reader->isTimeShifted());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QVariant PlaybackCore::metaData(const QString &key) const
+{
+	QVariant value;
+
+	//metadata demuxed from the stream itself is preferred, it arrives without the delays of the backend
+	const auto reader = StreamReader::find(m_Player.get());
+	if(nullptr != reader) value = reader->metaData(key);
+
+	//the key as reported by the backend is known after the first match, so usually a direct lookup is enough
+	if((false == value.isValid()) && (true == m_MetaDataKeys.contains(key)))
+	{
+		value = m_Player->metaData(m_MetaDataKeys.value(key));
+	}
+
+	if(false == value.isValid())
+	{
+		for(const auto &k : m_Player->availableMetaData())
+		{
+			if(key == k.toLower())
+			{
+				m_MetaDataKeys.insert(key, k);
+				value = m_Player->metaData(k);
+				break;
+			}
+		}
+	}
+
+	return value;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QStringList PlaybackCore::availableMetaData() const
+{
+	QStringList keys;
+
+	const auto reader = StreamReader::find(m_Player.get());
+	if(nullptr != reader) keys << reader->availableMetaData();
+
+	for(const auto &key : m_Player->availableMetaData()) keys << key.toLower();
+
+	keys.removeDuplicates();
+
+	return keys;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool PlaybackCore::play(int id)
+{
+	const auto station = m_StationModel.station(id);
+	if(nullptr == station) return false;
+
+	TRACE_SCOPE("play", "player");
+
+	const auto previousUrl = m_strCurrentUrl;
+
+	m_iCurrentStation = id;
+	m_CurrentStation = station;
+	m_strCurrentUrl = streamUrl(station);
+
+	//the clients update their views before the stream is connected
+	emit currentStationChanged(id);
+
+	//a standby player is already connected and buffered, it only needs to be promoted
+	auto standby = m_StandbyPlayers->take(m_strCurrentUrl);
+
+	if(nullptr != standby)
+	{
+		Tracer::instant("promoteStandbyPlayer", "player", m_strCurrentUrl);
+
+		disconnectPlayer();
+		m_StandbyPlayers->adopt(m_Player, previousUrl);
+
+		m_Player = standby;
+		connectPlayer();
+
+		m_Player->setVolume(ciDefaultVolume);
+		m_Player->setMuted(false);
+
+		emit playerChanged(m_Player.get());
+
+		//the promoted player is already running, its changes happened while it was muted
+		emit playerStateChanged(m_Player->state());
+		emit mediaStatusChanged(m_Player->mediaStatus());
+		emit volumeChanged(m_Player->volume());
+
+		onMediaChanged();
+	}
+	else
+	{
+		if(QMediaPlayer::PlayingState == m_Player->state())
+		{
+			m_Player->stop();
+		}
+
+		attachStream();
+		m_Player->setVolume(ciDefaultVolume);
+		m_Player->play();
+	}
+
+	if(false == previousUrl.isEmpty())
+	{
+		m_StationHistory.removeAll(previousUrl);
+		m_StationHistory.prepend(previousUrl);
+		while(ciMaxStationHistory < m_StationHistory.size()) m_StationHistory.removeLast();
+	}
+
+	prepareStandbyPlayers();
+
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::pause()
+{
+	if(QMediaPlayer::PlayingState != m_Player->state()) return;
+
+	//without time shifting a paused stream would fall behind, so it is stopped and connected again on resume
+	const auto reader = StreamReader::find(m_Player.get());
+	if((nullptr != reader) && (true == reader->pause())) m_Player->pause();
+	else m_Player->stop();
+
+	emit timeShiftChanged();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::resume()
+{
+	if(true == m_strCurrentUrl.isEmpty()) return;
+
+	const auto reader = StreamReader::find(m_Player.get());
+
+	if(QMediaPlayer::StoppedState == m_Player->state())
+	{
+		attachStream();
+		m_Player->setVolume(ciDefaultVolume);
+	}
+	else if((QMediaPlayer::PausedState == m_Player->state()) && (nullptr != reader))
+	{
+		//the reader kept the stream while paused, playback continues exactly where it was paused
+		reader->resume();
+	}
+
+	m_Player->play();
+
+	emit timeShiftChanged();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::stop()
+{
+	m_Player->stop();
+
+	emit timeShiftChanged();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::jumpToLive()
+{
+	const auto reader = StreamReader::find(m_Player.get());
+	if(nullptr != reader) reader->jumpToLive();
+
+	//jumping to the live stream while paused means playing it
+	if(QMediaPlayer::PlayingState != m_Player->state()) resume();
+
+	emit timeShiftChanged();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::setVolume(int volume)
+{
+	m_Player->setVolume(qBound(0, volume, 100));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::probeStations()
+{
+	if(true == m_bIdle)
+	{
+		m_bProbeDeferred = true;
+		return;
+	}
+
+	QStringList urls;
+
+	//the stations shown first, so they are flagged early
+	for(auto id : m_ShownStations)
+	{
+		const auto station = m_StationModel.station(id);
+		if(nullptr != station) urls << stationUrls(station);
+	}
+
+	for(auto row = 0; row < m_StationModel.rowCount(); ++row)
+	{
+		urls << stationUrls(m_StationModel.station(m_StationModel.id(row)));
+	}
+
+	m_StationProber.probe(urls, ciProbeMaxAge);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::onMediaChanged()
+{
+	Tracer::instant("onMediaChanged", "metadata");
+
+	//streams may send bursts of changes, the clients are notified at most once per interval
+	if(false == m_MetadataTimer.isActive()) m_MetadataTimer.start();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::reloadStations(const QList<StationInformation> &stations)
+{
+	TRACE_SCOPE("reloadStations", "catalog");
+
+	emit stationsAboutToReload();
+
+	//the stations keep their ids, so the clients keep showing the same stations
+	const auto changes = m_StationModel.update(stations);
+
+	//the player is left alone, only the record of the current station is updated
+	if(nullptr == m_StationModel.station(m_iCurrentStation))
+	{
+		m_iCurrentStation = -1;
+	}
+	else if(true == changes.m_Changed.contains(m_iCurrentStation))
+	{
+		m_CurrentStation = m_StationModel.station(m_iCurrentStation);
+	}
+
+	emit stationsReloaded(changes);
+
+	prepareStandbyPlayers();
+
+	//new urls are probed right away, the others keep their results
+	if((false == changes.m_Changed.isEmpty()) || (false == changes.m_Added.isEmpty())) probeStations();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::connectPlayer()
+{
+	m_MetaDataKeys.clear();
+
+	connect(m_Player.get(), &QMediaPlayer::volumeChanged, this, &PlaybackCore::volumeChanged);
+	connect(m_Player.get(), &QMediaPlayer::currentMediaChanged, this, &PlaybackCore::onMediaChanged);
+	connect(m_Player.get(), &QMediaPlayer::metaDataAvailableChanged, this, &PlaybackCore::onMediaChanged);
+	connect(m_Player.get(), &QMediaPlayer::stateChanged, this, &PlaybackCore::playerStateChanged);
+	connect(m_Player.get(), &QMediaPlayer::mediaStatusChanged, this, &PlaybackCore::mediaStatusChanged);
+
+	if(true == Tracer::isEnabled())
+	{
+		connect(m_Player.get(), &QMediaPlayer::stateChanged, this,
+						[](QMediaPlayer::State state) { Tracer::instant("playerState", "player", QString::number(state)); });
+		connect(m_Player.get(), &QMediaPlayer::mediaStatusChanged, this,
+						[](QMediaPlayer::MediaStatus status) { Tracer::instant("mediaStatus", "player", QString::number(status)); });
+	}
+
+	//a standby player brings its own stream reader
+	const auto reader = StreamReader::find(m_Player.get());
+	if(nullptr != reader)
+	{
+		reader->setTimeShift(m_iTimeShiftSeconds, m_iTimeShiftSize);
+		connect(reader, &StreamReader::metaDataChanged, this, &PlaybackCore::onMediaChanged);
+	}
+
+	emit timeShiftChanged();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::disconnectPlayer()
+{
+	disconnect(m_Player.get(), nullptr, this, nullptr);
+
+	const auto reader = StreamReader::find(m_Player.get());
+	if(nullptr != reader) disconnect(reader, nullptr, this, nullptr);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::attachStream()
+{
+	m_MetaDataKeys.clear();
+
+	StreamReader::attach(m_Player.get(), m_strCurrentUrl, m_iStreamBuffer);
+
+	//the titles come from the reader, the backend does not see the metadata of the stream
+	const auto reader = StreamReader::find(m_Player.get());
+	if(nullptr != reader)
+	{
+		reader->setTimeShift(m_iTimeShiftSeconds, m_iTimeShiftSize);
+		connect(reader, &StreamReader::metaDataChanged, this, &PlaybackCore::onMediaChanged);
+	}
+
+	emit timeShiftChanged();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString PlaybackCore::streamUrl(const StationRecord &station) const
+{
+	return m_StationProber.fastest(stationUrls(station));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void PlaybackCore::prepareStandbyPlayers()
+{
+	if(0 == m_StandbyPlayers->capacity()) return;
+
+	if(true == m_bIdle)
+	{
+		m_bStandbyDeferred = true;
+		return;
+	}
+
+	QStringList neighbours;
+
+	//the stations next to the current one in the catalog are the most likely candidates besides the history
+	const auto row = m_StationModel.row(m_iCurrentStation);
+	if(0 <= row)
+	{
+		for(auto n : {row - 1, row + 1})
+		{
+			const auto neighbour = m_StationModel.station(m_StationModel.id(n));
+			if(nullptr != neighbour) neighbours << streamUrl(neighbour);
+		}
+	}
+
+	//alternate between the history and the neighbours, the last station played comes first
+	QStringList candidates;
+	for(auto i = 0; i < qMax(m_StationHistory.size(), neighbours.size()); ++i)
+	{
+		if(i < m_StationHistory.size()) candidates << m_StationHistory.at(i);
+		if(i < neighbours.size()) candidates << neighbours.at(i);
+	}
+
+	candidates.removeAll(m_strCurrentUrl);
+
+	m_StandbyPlayers->prepare(candidates);
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <memory>
+
+#include <QHash>
+#include <QMediaPlayer>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+#include "StandbyPlayers.h"
+#include "StationCatalog.h"
+#include "StationModel.h"
+#include "StationProber.h"
+#include "StationReader.h"
+
+/**
+ * @brief The PlaybackCore class loads the stations and plays them, without any widgets
+ *
+ * The core owns the station catalog, the player of the current station with its stream reader, the standby players and
+ * the station prober. The gui and the control socket of the headless mode are both clients of the core: they call
+ * play(), pause() and friends and follow its signals, so a station switched through the socket shows up in the gui as
+ * well.
+ *
+ * @note Nothing in here decodes logos, the logo sources of the stations are only passed on to the clients
+ */
+class PlaybackCore : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief PlaybackCore Default constructor, call start() to load the stations
+	 * @param stationsFileName From where to load the station information
+	 * @param parent
+	 */
+	explicit PlaybackCore(const QString &stationsFileName = QString("stations.json"), QObject* parent = nullptr);
+
+	/**
+	 * @brief ~PlaybackCore Default destructor
+	 */
+	virtual ~PlaybackCore();
+
+	/**
+	 * @brief start Load the stations, watch the stations file for changes and schedule the station probes
+	 */
+	void start();
+
+	/**
+	 * @brief setStandbyPlayers Enable zapping mode, keeping muted players connected to the likely next stations
+	 * @param count The maximum number of standby players, 0 disables zapping mode
+	 * @param memoryBudget The memory the standby players may use in bytes, 0 for no limit
+	 */
+	void setStandbyPlayers(int count, qint64 memoryBudget = 0);
+
+	/**
+	 * @brief setStreamBuffer Play the streams through a jitter buffer which reconnects broken streams transparently
+	 * @param milliseconds The amount of audio to buffer before playing, 0 to let the players connect themselves
+	 *
+	 * @note The current station is connected again if it is playing
+	 */
+	void setStreamBuffer(int milliseconds);
+
+	/**
+	 * @brief setTimeShift Keep receiving the stream while paused, so playback resumes where it was paused
+	 * @param seconds The longest time shift in seconds, 0 lets pause stop the stream
+	 * @param size The largest time shift file in bytes
+	 *
+	 * @note Only works with a stream buffer, see setStreamBuffer()
+	 */
+	void setTimeShift(int seconds, qint64 size);
+
+	/**
+	 * @brief setIdle Defer the background network work, i.e. the station probes and the standby players
+	 * @param idle True to defer, false to catch up on the deferred work
+	 */
+	void setIdle(bool idle);
+
+	/**
+	 * @brief setShownStations Set the stations the user is looking at, they are probed first
+	 * @param ids The station ids
+	 */
+	void setShownStations(const QList<int> &ids);
+
+	/**
+	 * @brief stations All stations read from the stations file
+	 * @return The station model, the clients may track the logo states in it
+	 */
+	StationModel& stations();
+
+	/**
+	 * @brief catalog The compiled stations file the stations were loaded from
+	 * @return The catalog, not open if the stations were read from the json file
+	 */
+	const StationCatalog& catalog() const;
+
+	/**
+	 * @brief prober Checks the station urls in the background
+	 * @return The prober
+	 */
+	const StationProber& prober() const;
+
+	/**
+	 * @brief stationUrls The urls a station can be played from
+	 * @param station The station
+	 * @return The media url followed by the mirrors
+	 */
+	static QStringList stationUrls(const StationRecord &station);
+
+	/**
+	 * @brief isDead Whether none of the urls of a station answered its last probe
+	 * @param station The station
+	 * @return True if the station is offline
+	 */
+	bool isDead(const StationRecord &station) const;
+
+	/**
+	 * @brief currentId The id of the current station
+	 * @return The id, -1 if no station was played yet or the current one was removed
+	 */
+	int currentId() const;
+
+	/**
+	 * @brief currentStation The record of the current station
+	 * @return The record, never null
+	 */
+	StationRecord currentStation() const;
+
+	/**
+	 * @brief currentUrl The url played for the current station
+	 * @return One of the media url and the mirrors of the current station
+	 */
+	QString currentUrl() const;
+
+	/**
+	 * @brief player The player of the current station, changes when a standby player is promoted
+	 * @return The player
+	 */
+	QMediaPlayer* player() const;
+
+	/**
+	 * @brief playerState The state of the player of the current station
+	 * @return The player state
+	 */
+	QMediaPlayer::State playerState() const;
+
+	/**
+	 * @brief mediaStatus The media status of the player of the current station
+	 * @return The media status
+	 */
+	QMediaPlayer::MediaStatus mediaStatus() const;
+
+	/**
+	 * @brief volume The volume of the current station
+	 * @return The volume from 0 to 100
+	 */
+	int volume() const;
+
+	/**
+	 * @brief isTimeShifted Whether the current station plays behind the live stream
+	 * @return True if there is time shifted audio to skip
+	 */
+	bool isTimeShifted() const;
+
+	/**
+	 * @brief metaData Get a meta data value of the current station
+	 * @param key The lower case key, e.g. "title"
+	 * @return The value from the stream itself or from the backend, invalid if not available
+	 */
+	QVariant metaData(const QString &key) const;
+
+	/**
+	 * @brief availableMetaData The lower case keys of all meta data values of the current station
+	 * @return The keys
+	 */
+	QStringList availableMetaData() const;
+
+public slots:
+
+	/**
+	 * @brief play Switch to a station and play it
+	 * @param id The station id
+	 * @return False if there is no such station
+	 */
+	bool play(int id);
+
+	/**
+	 * @brief pause Pause the current station, it is stopped if time shifting is disabled
+	 */
+	void pause();
+
+	/**
+	 * @brief resume Play the current station again, where it was paused if it was time shifted
+	 */
+	void resume();
+
+	/**
+	 * @brief stop Stop the current station, resume() connects it again
+	 */
+	void stop();
+
+	/**
+	 * @brief jumpToLive Drop the time shifted audio and continue with the live stream
+	 */
+	void jumpToLive();
+
+	/**
+	 * @brief setVolume Set the volume of the current station
+	 * @param volume The volume from 0 to 100
+	 */
+	void setVolume(int volume);
+
+	/**
+	 * @brief probeStations Queue the urls of all stations for probing, urls probed recently are skipped
+	 */
+	void probeStations();
+
+signals:
+
+	/**
+	 * @brief stationsAboutToReload Emitted when a changed stations file is about to be merged, the station model still
+	 * holds the previous stations
+	 */
+	void stationsAboutToReload();
+
+	/**
+	 * @brief stationsReloaded Emitted after a changed stations file was merged into the station model
+	 * @param changes The changes
+	 */
+	void stationsReloaded(const StationModel::Changes &changes);
+
+	/**
+	 * @brief currentStationChanged Emitted when another station was selected for playback
+	 * @param id The station id
+	 */
+	void currentStationChanged(int id);
+
+	/**
+	 * @brief playerChanged Emitted when a standby player took over the current station
+	 * @param player The new player
+	 */
+	void playerChanged(QMediaPlayer* player);
+
+	/**
+	 * @brief playerStateChanged Emitted when the state of the player of the current station changes
+	 * @param state The new state
+	 */
+	void playerStateChanged(QMediaPlayer::State state);
+
+	/**
+	 * @brief mediaStatusChanged Emitted when the media status of the player of the current station changes
+	 * @param status The new status
+	 */
+	void mediaStatusChanged(QMediaPlayer::MediaStatus status);
+
+	/**
+	 * @brief volumeChanged Emitted when the volume of the current station changes
+	 * @param volume The new volume
+	 */
+	void volumeChanged(int volume);
+
+	/**
+	 * @brief timeShiftChanged Emitted when the current station may have started or stopped playing behind the live
+	 * stream, see isTimeShifted()
+	 */
+	void timeShiftChanged();
+
+	/**
+	 * @brief metaDataChanged Emitted when meta data of the current station changed, bursts of changes result in a
+	 * single signal
+	 */
+	void metaDataChanged();
+
+	/**
+	 * @brief stationProbed Emitted when the result of a station url changed
+	 * @param url The probed url
+	 */
+	void stationProbed(const QString &url);
+
+private slots:
+
+	/**
+	 * @brief onMediaChanged Schedules metaDataChanged, so bursts of changes result in a single signal
+	 */
+	void onMediaChanged();
+
+private:
+
+	/**
+	 * @brief reloadStations Merge a changed stations file, only the affected stations are updated
+	 * @param stations The stations read from the changed file
+	 *
+	 * @note The current station keeps playing, even if it was changed or removed
+	 */
+	void reloadStations(const QList<StationInformation> &stations);
+
+	/**
+	 * @brief connectPlayer Connect the current player to the core
+	 */
+	void connectPlayer();
+
+	/**
+	 * @brief disconnectPlayer Disconnect the current player from the core
+	 */
+	void disconnectPlayer();
+
+	/**
+	 * @brief attachStream Set the current station as the media of the player, through a stream reader if enabled
+	 */
+	void attachStream();
+
+	/**
+	 * @brief streamUrl Pick the url to play for a station
+	 * @param station The station
+	 * @return The media url or the mirror answering fastest, as far as the stations were probed
+	 */
+	QString streamUrl(const StationRecord &station) const;
+
+	/**
+	 * @brief prepareStandbyPlayers Connect the standby players to the stations most likely played next
+	 */
+	void prepareStandbyPlayers();
+
+	/**
+	 * @brief m_strStationsFile From where to load the station information
+	 */
+	const QString m_strStationsFile;
+
+	/**
+	 * @brief m_StationModel All stations read from the stations file
+	 */
+	StationModel m_StationModel;
+
+	/**
+	 * @brief m_StationCatalog The compiled stations file the stations were loaded from, if there is an up to date one
+	 */
+	StationCatalog m_StationCatalog;
+
+	/**
+	 * @brief m_StationReader Watches the stations file and parses it again when it changes
+	 */
+	std::shared_ptr<StationReader> m_StationReader;
+
+	/**
+	 * @brief m_iCurrentStation The id of the currently selected station, -1 if none was selected or it was removed
+	 */
+	int m_iCurrentStation;
+
+	/**
+	 * @brief m_CurrentStation The record of the currently selected station, never null
+	 */
+	StationRecord m_CurrentStation;
+
+	/**
+	 * @brief m_strCurrentUrl The url played for the current station, one of its media url and mirrors
+	 */
+	QString m_strCurrentUrl;
+
+	/**
+	 * @brief m_Player The instance used to play the media urls
+	 */
+	std::shared_ptr<QMediaPlayer> m_Player;
+
+	/**
+	 * @brief m_iStreamBuffer The jitter buffer of the players in milliseconds, 0 if the players connect themselves
+	 */
+	int m_iStreamBuffer;
+
+	/**
+	 * @brief m_iTimeShiftSeconds The longest time shift in seconds, 0 if pausing stops the stream
+	 */
+	int m_iTimeShiftSeconds;
+
+	/**
+	 * @brief m_iTimeShiftSize The largest time shift file in bytes
+	 */
+	qint64 m_iTimeShiftSize;
+
+	/**
+	 * @brief m_StandbyPlayers The muted players kept ready for zapping
+	 */
+	std::shared_ptr<StandbyPlayers> m_StandbyPlayers;
+
+	/**
+	 * @brief m_StationHistory The media urls of the previously played stations, the most recent one first
+	 */
+	QStringList m_StationHistory;
+
+	/**
+	 * @brief m_StationProber Checks the station urls in the background
+	 */
+	StationProber m_StationProber;
+
+	/**
+	 * @brief m_ProbeTimer Repeats the station probes
+	 */
+	QTimer m_ProbeTimer;
+
+	/**
+	 * @brief m_ShownStations The stations the user is looking at, probed first
+	 */
+	QList<int> m_ShownStations;
+
+	/**
+	 * @brief m_bIdle True while the background network work is deferred
+	 */
+	bool m_bIdle;
+
+	/**
+	 * @brief m_bProbeDeferred True if the stations were due for probing while idle
+	 */
+	bool m_bProbeDeferred;
+
+	/**
+	 * @brief m_bStandbyDeferred True if the standby players were due for an update while idle
+	 */
+	bool m_bStandbyDeferred;
+
+	/**
+	 * @brief m_MetaDataKeys The keys as reported by the backend, by their lower case form. Reset for every player.
+	 */
+	mutable QHash<QString, QString> m_MetaDataKeys;
+
+	/**
+	 * @brief m_MetadataTimer Coalesces meta data changes
+	 */
+	QTimer m_MetadataTimer;
+};
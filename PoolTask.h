@@ -0,0 +1,36 @@
+#pragma once
+
+#include <functional>
+
+#include <QRunnable>
+
+/**
+ * @brief The PoolTask class runs a single function on a QThreadPool
+ */
+class PoolTask : public QRunnable
+{
+public:
+
+	/**
+	 * @brief PoolTask Default constructor, the task deletes itself when done
+	 * @param task The function to run on the pool
+	 */
+	explicit PoolTask(const std::function<void()> &task)
+		: QRunnable()
+		, m_Task(task)
+	{
+		setAutoDelete(true);
+	}
+
+	void run() override
+	{
+		m_Task();
+	}
+
+private:
+
+	/**
+	 * @brief m_Task The function to run
+	 */
+	std::function<void()> m_Task;
+};
@@ -1,15 +1,14 @@
 #include "RadioGui.h"
 #include "ui_RadioGui.h"
 
-#include <QThread>
+#include "StallWatchdog.h"
+#include "StreamReader.h"
+#include "Tracer.h"
 
-#include <QFile>
+#include <QCoreApplication>
 #include <QFileInfo>
-#include <QTextStream>
-
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonValue>
+#include <QSet>
+#include <QThread>
 
 #include <QMediaService>
 #include <QMediaMetaData>
@@ -18,306 +17,478 @@
 namespace
 {
 
-//full volume when starting and switching stations
-const int ciDefaultVolume = 100;
+//the memory the station logos may use unless configured otherwise, in bytes
+const qint64 ciDefaultLogoMemory = 4 * 1024 * 1024;
 
 //the stylesheet to use for the station label
 const QString cstrDefaultLabelStyleSheet = QStringLiteral("QLabel { background-color: %1; }");
 
-//the stylesheet to use for each station button
-const QString cstrDefaultButtonStyleSheet = QStringLiteral("QPushButton {" \
-																													 " border-radius: 15px;" \
-																													 " border: 3px solid rgb(72, 126, 176);" \
-																													 " color: rgb(72, 126, 176);" \
-																													 " background-color: %1;" \
-																													 " padding: 5px 5px 5px 5px;" \
-																													 " outline: none;" \
-																													 "}" \
-																													 "QPushButton:checked {" \
-																													 " border-radius: 15px;" \
-																													 " border: 3px solid rgb(255,255,255);" \
-																													 " color: rgb(255,255,255);" \
-																													 " background-color: %2;" \
-																													 " padding: 5px 5px 5px 5px;" \
-																													 " outline: none;" \
-																													 "}");
-
-QPixmap ScaleLogoToRectangle(const QPixmap &logo, const QRect &rect, const double &factor = 1.0)
+/**
+ * @brief SetFittingText Display a text in the largest font fitting into the container
+ * @param fitter Finds and memoizes the font size
+ * @param l The container
+ * @param text The text to display, elided if it does not fit at the minimum font size
+ * @param fraction The fraction of the container width and height the text may use
+ */
+template<typename T = QLabel>
+void SetFittingText(TextFitter &fitter, T* l, const QString &text, const double &fraction = 0.9)
 {
-	auto scaledLogo = logo;
-
-	double heightRatio = (1.0 * scaledLogo.height()) / (1.0 * rect.height());
-	double widthRatio = (1.0 * scaledLogo.width()) / (1.0 * rect.width());
+	TRACE_SCOPE("SetFittingText", "text");
 
-	if((1.0 < widthRatio) && (widthRatio > heightRatio))
-	{
-		scaledLogo = scaledLogo.scaledToWidth(rect.width() * factor, Qt::SmoothTransformation);
+	const auto fit = fitter.fit(text, l->font(), l->contentsRect().size(), fraction);
 
-	}
-	else if((1.0 < heightRatio) && (heightRatio > widthRatio))
-	{
-		scaledLogo = scaledLogo.scaledToHeight(rect.height() * factor, Qt::SmoothTransformation);
-	}
-
-	return scaledLogo;
+	l->setFont(fit.m_Font);
+	l->setText(fit.m_strText);
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-template<typename T = QLabel>
-void SetMaximumFontForTextContainer(T* l, const double &fraction = 0.9)
+}
+
+RadioGui::RadioGui(const QString &stationsFileName, QWidget *parent)
+	: QMainWindow(parent)
+	, m_ui(new Ui::RadioGui)
+	, m_Core(stationsFileName)
+	, m_StationSearch()
+	, m_SearchResults()
+	, m_SourceButtons()
+	, m_iPage(0)
+	, m_bLevelMeter(true)
+	, m_AudioAnalyzer()
+	, m_AudioProbe()
+	, m_LogoDownLoader(new LogoDownloader(), [](LogoDownloader* d) { d->deleteLater(); })
+	, m_LogoDecoder(new LogoDecoder(), [](LogoDecoder* d) { d->deleteLater(); })
+	, m_LogoScaler(new LogoScaler(), [](LogoScaler* s) { s->deleteLater(); })
+	, m_TextFitter()
+	, m_bIdle(false)
+	, m_bIdleTimedOut(false)
+	, m_IdleTimer()
+	, m_strIdleFile()
+	, m_IdleFileWatcher()
+	, m_bMetadataDeferred(false)
+	, m_DeferredLogos()
+	, m_ReloadingLogos()
+	, m_WakeupCounter()
+	, m_FirstMetadata()
+	, m_SecondMetadata()
 {
-	//the available size
-	auto newSize = l->contentsRect().size();
+	TRACE_SCOPE("RadioGui", "startup");
 
-	QFontMetrics fm = l->fontMetrics();
+	{
+		TRACE_SCOPE("setupUi", "startup");
+		m_ui->setupUi(this);
+	}
 
-	//we use only a fraction of the available width and height
-	auto availableWidth = fraction * newSize.width();
-	auto availableHeight = fraction * newSize.height();
+	//the station logo is rendered again whenever the label size changes
+	m_ui->lblStation->installEventFilter(this);
+	m_LogoScaler->addTarget(m_ui->btn1->iconSize(), 1.0, devicePixelRatioF());
+	m_LogoScaler->setMaximumSize(maximumLogoSize());
+	m_LogoScaler->setMemoryBudget(ciDefaultLogoMemory);
 
-	//detect the currently longest string
-	auto cls = l->text();
+	connect(m_LogoScaler.get(), &LogoScaler::logoEvicted, this, &RadioGui::onLogoEvicted);
 
-	auto maxWidth = 1.0 * fm.width(cls);
-	auto maxHeight = 1.0 * fm.height();
+	m_ui->btnPlayingPage->setChecked(true);
+	m_ui->stackedWidget->setCurrentWidget(m_ui->pagePlaying);
+	m_ui->sliderVolume->setValue(m_Core.volume());
 
-	QFont font(l->font());
+	connect(m_ui->btnPlayingPage, &QPushButton::clicked, this, &RadioGui::onNavigationButtonClicked);
+	connect(m_ui->btnSelectSourcePage, &QPushButton::clicked, this, &RadioGui::onNavigationButtonClicked);
+	connect(m_ui->btnSettingsPage, &QPushButton::clicked, this, &RadioGui::onNavigationButtonClicked);
 
-	auto widthScaling = availableWidth / maxWidth;
-	auto heightScaling = availableHeight / maxHeight;
+	//the station buttons only show the current page of the station model, they are reused for every page
+	m_SourceButtons << m_ui->btn1 << m_ui->btn2 << m_ui->btn3 << m_ui->btn4 << m_ui->btn5 << m_ui->btn6;
+	for(auto button : m_SourceButtons)
+	{
+		button->setProperty("station", -1);
+		connect(button, &QPushButton::clicked, this, &RadioGui::onSourceButtonClicked);
+	}
 
-	//scale size according to size change but only up to the minimum value possible
-	font.setPointSizeF(font.pointSizeF() * qMin(widthScaling, heightScaling));
-	l->setFont(font);
+	//the probe delivers the decoded buffers on the gui thread, the analyzer only queues them there
+	m_ui->levelMeter->setAnalyzer(&m_AudioAnalyzer);
+	connect(&m_AudioProbe, &QAudioProbe::audioBufferProbed, &m_AudioAnalyzer, &AudioAnalyzer::write);
+	m_AudioProbe.setSource(m_Core.player());
+
+	//the gui follows the core, so stations switched by other clients show up as well
+	connect(&m_Core, &PlaybackCore::currentStationChanged, this, &RadioGui::onCurrentStationChanged);
+	connect(&m_Core, &PlaybackCore::stationsAboutToReload, this, &RadioGui::onStationsAboutToReload);
+	connect(&m_Core, &PlaybackCore::stationsReloaded, this, &RadioGui::onStationsReloaded);
+	connect(&m_Core, &PlaybackCore::playerChanged, this, &RadioGui::onPlayerChanged);
+	connect(&m_Core, &PlaybackCore::playerStateChanged, this, &RadioGui::onPlayerStateChanged);
+	connect(&m_Core, &PlaybackCore::playerStateChanged, this, &RadioGui::playerStateChanged);
+	connect(&m_Core, &PlaybackCore::mediaStatusChanged, this, &RadioGui::mediaStatusChanged);
+	connect(&m_Core, &PlaybackCore::timeShiftChanged, this, &RadioGui::updateLiveButton);
+	connect(&m_Core, &PlaybackCore::metaDataChanged, this, &RadioGui::onMetaDataChanged);
+	connect(&m_Core, &PlaybackCore::stationProbed, this, &RadioGui::onStationProbed);
+
+	connect(&m_Core, &PlaybackCore::volumeChanged, m_ui->sliderVolume, &QSlider::setValue);
+	connect(m_ui->sliderVolume, &QSlider::valueChanged, &m_Core, &PlaybackCore::setVolume);
+
+	updateLiveButton();
+
+	m_IdleTimer.setSingleShot(true);
+	connect(&m_IdleTimer, &QTimer::timeout, this, [=]()
+	{
+		m_bIdleTimedOut = true;
+		updateIdle();
+	});
+	connect(&m_IdleFileWatcher, &QFileSystemWatcher::directoryChanged, this, &RadioGui::updateIdle);
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-/**
- * @brief ReadStationsFromFile Import station description from a UTF-8 encoded json file
- * @param file The file to import
- * @return The found stations
- */
-QList<StationInformation> ReadStationsFromFile(const QString &file)
+RadioGui::~RadioGui()
 {
-	QList<StationInformation> stations;
+	delete m_ui;
+}
+//----------------------------------------------------------------------------------------------------------------------
 
-	QFileInfo fi(file);
-	if(false == fi.exists()) return stations;
+void RadioGui::start()
+{
+	//load available stations, only the stations of the first page get their logos now, all other logos are requested
+	//when their page is shown
+	m_Core.start();
+	updateSearchIndex();
+	showPage(0);
 
-	QFile f(fi.absoluteFilePath());
-	if(true == f.open(QFile::ReadOnly))
+	//play first station
+	if(true == m_ui->btn1->isEnabled())
 	{
-		QTextStream s(&f);
-		QJsonDocument jsonDocument = QJsonDocument::fromJson(s.readAll().toUtf8());
+		emit m_ui->btn1->clicked();
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
 
-		const auto jsonObj = jsonDocument.object();
+void RadioGui::onStationsAboutToReload()
+{
+	auto &stations = m_Core.stations();
 
-		//all top-level keys are used as  the station names (which may get overwritten when meta-data is found)
-		for(const auto &stationName : jsonObj.keys())
+	m_ReloadingLogos.clear();
+	for(auto row = 0; row < stations.rowCount(); ++row)
+	{
+		const auto id = stations.id(row);
+		const auto station = stations.station(id);
+
+		if((StationModel::LogoLoading == stations.logoState(id)) && (true == station->m_uLogoUrl.isValid()))
 		{
-			const auto stationObject = jsonObj.value(stationName).toObject();
-
-			bool validLogo = (stationObject.contains("logo") ||
-												stationObject.contains("logo-file") ||
-												stationObject.contains("logo-url"));
-
-			bool valid = stationObject.contains("url") &&
-									 validLogo &&
-									 stationObject.contains("meta_key_1") &&
-									 stationObject.contains("meta_key_2");
-
-			if(false == valid) continue;
-
-			StationInformation station;
-			station.m_strDefaultPublisher = stationName;
-			station.m_strMediaUrl = stationObject.value("url").toString();
-			station.m_strFirstMetadataKey = stationObject.value("meta_key_1").toString();
-			station.m_strSecondMetadataKey = stationObject.value("meta_key_2").toString();
-
-			//we expect the logo data as base64 data
-			if(true == stationObject.contains("logo"))
-			{
-				auto pixmapData = stationObject.value(QString("logo")).toString().toLatin1();
-				station.m_pStationLogo.loadFromData(QByteArray::fromBase64(pixmapData));
-			}
-			//alternatively we allow the logo-file point to a valid image file
-			else if(true == stationObject.contains("logo-file"))
-			{
-				auto pixmapPath = stationObject.value(QString("logo-file")).toString();
-				station.m_pStationLogo.load(pixmapPath);
-			}
-			else if(true == stationObject.contains("logo-url"))
-			{
-				//only store the url, download needs to be performed when needed
-				station.m_uLogoUrl = stationObject.value(QString("logo-url")).toString();
-			}
-
-			{
-				station.m_cBackgroundColorNormal = Qt::black;
-
-				if(true == stationObject.contains("background-color-normal"))
-				{
-					auto backgroundColor = stationObject.value(QString("background-color-normal")).toString();
-
-					QColor c(backgroundColor);
-					if(true == c.isValid())
-					{
-						station.m_cBackgroundColorNormal = c;
-					}
-				}
-			}
-
-			{
-				station.m_cBackgroundColorChecked = QColor(72, 126, 176);
-
-				if(true == stationObject.contains("background-color-checked"))
-				{
-					auto backgroundColor = stationObject.value(QString("background-color-checked")).toString();
-
-					QColor c(backgroundColor);
-					if(true == c.isValid())
-					{
-						station.m_cBackgroundColorChecked = c;
-					}
-				}
-			}
-
-			stations.append(station);
+			m_ReloadingLogos.insert(id);
 		}
 	}
-
-	return stations;
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-}
-
-RadioGui::RadioGui(const QString &stationsFileName, QWidget *parent)
-	: QMainWindow(parent)
-	, m_strStationsFile(stationsFileName)
-	, m_ui(new Ui::RadioGui)
-	, m_Player(new QMediaPlayer(), [](QMediaPlayer* p) { p->deleteLater(); })
-	, m_LogoDownLoader(new LogoDownloader(), [](LogoDownloader* d) { d->deleteLater(); })
+void RadioGui::onStationsReloaded(const StationModel::Changes &changes)
 {
-	m_ui->setupUi(this);
+	TRACE_SCOPE("onStationsReloaded", "catalog");
 
-	qRegisterMetaType<StationInformation>();
-
-	m_ui->btnPlayingPage->setChecked(true);
-	m_ui->stackedWidget->setCurrentWidget(m_ui->pagePlaying);
-	m_ui->sliderVolume->setValue(ciDefaultVolume);
+	//logos from an outdated source must not show up later
+	for(const auto &outdated : {changes.m_Removed, changes.m_LogoChanged})
+	{
+		for(auto it = outdated.cbegin(); it != outdated.cend(); ++it)
+		{
+			if(true == m_ReloadingLogos.contains(it.key())) m_LogoDownLoader->cancel(it.value()->m_uLogoUrl);
 
-	connect(m_ui->btnPlayingPage, &QPushButton::clicked, this, &RadioGui::onNavigationButtonClicked);
-	connect(m_ui->btnSelectSourcePage, &QPushButton::clicked, this, &RadioGui::onNavigationButtonClicked);
-	connect(m_ui->btnSettingsPage, &QPushButton::clicked, this, &RadioGui::onNavigationButtonClicked);
+			m_LogoScaler->removeLogo(it.key());
+		}
+	}
 
-	connect(m_Player.get(), &QMediaPlayer::volumeChanged, m_ui->sliderVolume, &QSlider::setValue);
-	connect(m_Player.get(), &QMediaPlayer::currentMediaChanged, this, &RadioGui::onMediaChanged);
-	connect(m_Player.get(), &QMediaPlayer::metaDataAvailableChanged, this, &RadioGui::onMediaChanged);
+	m_ReloadingLogos.clear();
 
-	connect(m_ui->sliderVolume, &QSlider::valueChanged, m_Player.get(), &QMediaPlayer::setVolume);
+	//the player is left alone, only the displayed information is updated
+	const auto id = m_Core.currentId();
+	if(true == changes.m_Changed.contains(id))
+	{
+		if(true == changes.m_ColorsChanged.contains(id))
+		{
+			const auto color = m_Core.currentStation()->m_cBackgroundColorNormal;
+			m_ui->lblStation->setStyleSheet(cstrDefaultLabelStyleSheet.arg(color.name(QColor::HexArgb)));
+		}
 
-	//load available stations
-	loadStations();
+		if(StationModel::LogoNotLoaded == m_Core.stations().logoState(id)) showStationLogo();
 
-	//play first station
-	if(true == m_ui->btn1->isEnabled())
-	{
-		emit m_ui->btn1->clicked();
+		//the station information may name other meta data keys now
+		onMetaDataChanged();
 	}
+
+	updateSearchIndex();
+	showPage(m_iPage);
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-RadioGui::~RadioGui()
+void RadioGui::updateSearchIndex()
 {
-	delete m_ui;
+	const auto &stations = m_Core.stations();
+
+	m_StationSearch.clear();
+
+	for(auto row = 0; row < stations.rowCount(); ++row)
+	{
+		const auto station = stations.station(stations.id(row));
+		m_StationSearch.addStation(QStringList() << station->m_strDefaultPublisher
+																						 << station->m_strGenre
+																						 << station->m_strMediaUrl);
+	}
+
+	m_SearchResults = m_StationSearch.search(m_ui->lineEditSearch->text());
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-void RadioGui::loadStations()
+void RadioGui::showPage(int page)
 {
-	QList<StationInformation> cStations = ReadStationsFromFile(m_strStationsFile);
+	TRACE_SCOPE("showPage", "catalog");
+
+	auto &stations = m_Core.stations();
+	const auto currentId = m_Core.currentId();
+
+	//while searching only the results are paged, the best match first
+	const auto searching = (false == m_ui->lineEditSearch->text().trimmed().isEmpty());
+	const auto shownRows = (true == searching) ? m_SearchResults.size() : stations.rowCount();
 
-	auto buttons = m_ui->pageSelectSource->findChildren<QPushButton*>();
+	const auto pageSize = m_SourceButtons.size();
+	const auto pageCount = qMax(1, (shownRows + pageSize - 1) / pageSize);
 
-	//disable all per default
-	for(auto button : buttons) { button->setEnabled(false); }
+	page = qBound(0, page, pageCount - 1);
+	m_iPage = page;
 
-	for(auto i = 0; i < qMin(cStations.size(), buttons.size()); ++i)
+	QVector<int> previousStations;
+	QList<int> shownStations;
+
+	for(auto i = 0; i < pageSize; ++i)
 	{
-		auto button = m_ui->pageSelectSource->findChild<QPushButton*>(QString("btn%1").arg(i+1));
+		auto button = m_SourceButtons.at(i);
+		const auto index = (page * pageSize) + i;
+
+		previousStations << button->property("station").toInt();
 
-		Q_ASSERT(nullptr != button);
-		if(nullptr == button) button = buttons.at(i);
+		if(shownRows <= index)
+		{
+			button->setProperty("station", -1);
+			button->setLogo(QPixmap());
+			button->setText(QString());
+			button->setChecked(false);
+			button->setEnabled(false);
+			button->setOffline(false);
+			continue;
+		}
+
+		const auto id = stations.id((true == searching) ? m_SearchResults.at(index) : index);
+		const auto station = stations.station(id);
+		button->setProperty("station", id);
+		shownStations << id;
+
+		//the tile paints the station colors itself, no style sheet has to be parsed
+		button->setColors(station->m_cBackgroundColorNormal, station->m_cBackgroundColorChecked);
+
+		button->setChecked(id == currentId);
+		button->setEnabled(true);
+		button->setOffline(m_Core.isDead(station));
 
-		auto station = cStations[i];
-		button->setProperty("station", QVariant::fromValue(station));
+		const auto logoState = stations.logoState(id);
 
-		//if a valid url is given, we need to download the logo now
-		if(true == station.m_uLogoUrl.isValid())
+		if((StationModel::LogoLoaded == logoState) || (StationModel::LogoMissing == logoState))
 		{
-			m_LogoDownLoader->downloadLogo(station.m_uLogoUrl,
-																		 [=](QPixmap logo)
-																		 {
-																				auto s = button->property("station").value<StationInformation>();
-																				button->setIcon(QIcon(logo));
-																				s.m_pStationLogo = logo;
-																				button->setProperty("station", QVariant::fromValue(s));
-
-																				if(true == button->icon().isNull())
-																				{
-																					button->setText(s.m_strDefaultPublisher);
-																					SetMaximumFontForTextContainer<QAbstractButton>(button);
-																				}
-																		 });
+			showButtonLogo(button, id);
 		}
 		else
 		{
-			button->setIcon(QIcon(station.m_pStationLogo));
+			//the name is shown until the logo is available, the station played first is fetched first
+			button->setLogo(QPixmap());
+			SetFittingText<QAbstractButton>(m_TextFitter, button, station->m_strDefaultPublisher);
 
-			if(true == button->icon().isNull())
-			{
-				button->setText(station.m_strDefaultPublisher);
-				SetMaximumFontForTextContainer<QAbstractButton>(button);
-			}
+			const auto current = (0 <= currentId) ? currentId : stations.id(0);
+			requestLogo(id, (id == current) ? 1 : 0);
 		}
+	}
 
-		//we replace the stylesheet with a modified one using the specified colors for the station
-		auto styleSheet = cstrDefaultButtonStyleSheet;
-		styleSheet = styleSheet.arg(station.m_cBackgroundColorNormal.name(QColor::HexArgb));
-		styleSheet = styleSheet.arg(station.m_cBackgroundColorChecked.name(QColor::HexArgb));
+	//logos of stations scrolled out of view are not needed anymore, they are requested again when shown
+	for(auto id : previousStations)
+	{
+		const auto station = stations.station(id);
+		if(nullptr == station) continue;
 
-		button->setStyleSheet(styleSheet);
+		auto stillShown = false;
+		for(auto button : m_SourceButtons) stillShown |= (id == button->property("station").toInt());
+		if(true == stillShown) continue;
 
-		button->setChecked(button == m_ui->btn1);
-		button->setEnabled(true);
+		if((StationModel::LogoLoading == stations.logoState(id)) && (true == station->m_uLogoUrl.isValid()))
+		{
+			m_LogoDownLoader->cancel(station->m_uLogoUrl);
+			stations.setLogoState(id, StationModel::LogoNotLoaded);
+		}
+	}
 
-		connect(button, &QPushButton::clicked, this, &RadioGui::onSourceButtonClicked);
+	//the core probes the shown stations first
+	m_Core.setShownStations(shownStations);
+
+	m_ui->labelPage->setText(QString("%1 / %2").arg(page + 1).arg(pageCount));
+	m_ui->btnPreviousPage->setEnabled(0 < page);
+	m_ui->btnNextPage->setEnabled(pageCount - 1 > page);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::requestLogo(int id, int priority)
+{
+	auto &stations = m_Core.stations();
+
+	if(StationModel::LogoNotLoaded != stations.logoState(id)) return;
+
+	if(true == m_bIdle)
+	{
+		m_DeferredLogos[id] = qMax(priority, m_DeferredLogos.value(id));
+		return;
+	}
+
+	const auto station = stations.station(id);
+	if(nullptr == station) return;
+
+	const auto receiver = [=](QImage logo)
+	{
+		//the station may have been removed or got a new logo source while loading
+		const auto current = m_Core.stations().station(id);
+		if(nullptr == current) return;
+
+		if(current->m_baLogoSource != station->m_baLogoSource) return;
+
+		setStationLogo(id, logo);
+	};
+
+	stations.setLogoState(id, StationModel::LogoLoading);
+
+	//pre-scaled catalog logos are only copied out of the mapped file, nothing is decoded
+	if(0 <= station->m_iCatalogLogo)
+	{
+		receiver(m_Core.catalog().logo(station->m_iCatalogLogo));
+	}
+	//the logos are decoded in parallel, each button is updated as soon as its logo is available
+	else if(false == station->m_baLogoData.isEmpty())
+	{
+		m_LogoDecoder->decodeBase64(station->m_baLogoData, receiver);
+	}
+	else if(false == station->m_strLogoFile.isEmpty())
+	{
+		m_LogoDecoder->decodeFile(station->m_strLogoFile, receiver);
+	}
+	//if a valid url is given, we need to download the logo now
+	else if(true == station->m_uLogoUrl.isValid())
+	{
+		m_LogoDownLoader->downloadLogo(station->m_uLogoUrl,
+																	 [=](QPixmap logo) { receiver(logo.toImage()); },
+																	 this,
+																	 priority);
+	}
+	else
+	{
+		setStationLogo(id, QImage());
 	}
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-void RadioGui::on_btnStartStop_clicked()
+void RadioGui::setLogoMemoryBudget(qint64 bytes)
 {
-	m_ui->btnStartStop->setIcon(m_ui->btnStartStop->isChecked() ? QIcon(":/Resources/Resources/pause.png") :
-																																QIcon(":/Resources/Resources/play-button.png"));
+	m_LogoScaler->setMemoryBudget(bytes);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::setStandbyPlayers(int count, qint64 memoryBudget)
+{
+	m_Core.setStandbyPlayers(count, memoryBudget);
+}
+//----------------------------------------------------------------------------------------------------------------------
 
-	if(true == m_ui->btnStartStop->isChecked())
+void RadioGui::setStreamBuffer(int milliseconds)
+{
+	m_Core.setStreamBuffer(milliseconds);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::setTimeShift(int seconds, qint64 size)
+{
+	m_Core.setTimeShift(seconds, size);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::setLevelMeter(bool enabled)
+{
+	if(enabled == m_bLevelMeter) return;
+
+	m_bLevelMeter = enabled;
+	m_ui->levelMeter->setVisible(m_bLevelMeter);
+
+	//without a source the probe delivers nothing and the analysis thread sleeps
+	if((true == m_bLevelMeter) && (false == m_bIdle)) m_AudioProbe.setSource(m_Core.player());
+	else m_AudioProbe.setSource(static_cast<QMediaObject*>(nullptr));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::setIdleTimeout(int seconds)
+{
+	//the input of all widgets is watched, it restarts the timeout
+	if(0 < seconds)
 	{
-		if(QMediaPlayer::StoppedState == m_Player->state())
-		{
-			m_Player->setMedia(QMediaContent(m_CurrentStation.m_strMediaUrl));
-			m_Player->setVolume(ciDefaultVolume);
-		}
-		m_Player->play();
+		QCoreApplication::instance()->installEventFilter(this);
+		m_IdleTimer.start(seconds * 1000);
 	}
 	else
 	{
-		if(QMediaPlayer::PlayingState == m_Player->state())
-		{
-			m_Player->stop();
-		}
+		QCoreApplication::instance()->removeEventFilter(this);
+		m_IdleTimer.stop();
 	}
+
+	m_bIdleTimedOut = false;
+	updateIdle();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::setIdleFile(const QString &file)
+{
+	if(false == m_IdleFileWatcher.directories().isEmpty())
+	{
+		m_IdleFileWatcher.removePaths(m_IdleFileWatcher.directories());
+	}
+
+	m_strIdleFile = file;
+
+	//the directory is watched, so the creation and the removal of the file are both noticed
+	if(false == m_strIdleFile.isEmpty()) m_IdleFileWatcher.addPath(QFileInfo(m_strIdleFile).absolutePath());
+
+	updateIdle();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool RadioGui::isIdle() const
+{
+	return m_bIdle;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+PlaybackCore& RadioGui::core()
+{
+	return m_Core;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QMediaPlayer::State RadioGui::playerState() const
+{
+	return m_Core.playerState();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QMediaPlayer::MediaStatus RadioGui::mediaStatus() const
+{
+	return m_Core.mediaStatus();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::on_btnStartStop_clicked()
+{
+	if(true == m_ui->btnStartStop->isChecked()) m_Core.resume();
+	else m_Core.pause();
+
+	//the button shows what the player does, e.g. if there is no station to resume
+	onPlayerStateChanged(m_Core.playerState());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::on_btnLive_clicked()
+{
+	m_Core.jumpToLive();
 }
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -342,6 +513,7 @@ void RadioGui::onNavigationButtonClicked()
 	}
 	else if(m_ui->btnSettingsPage == pressedButton)
 	{
+		 updateStatistics();
 		 m_ui->stackedWidget->setCurrentWidget(m_ui->pageSettings);
 	}
 }
@@ -349,97 +521,428 @@ void RadioGui::onNavigationButtonClicked()
 
 void RadioGui::onSourceButtonClicked()
 {
-	QPushButton* clickedButton{};
+	const auto clickedButton = qobject_cast<StationTile*>(sender());
+	if(nullptr == clickedButton) return;
 
-	for(auto button : m_ui->pageSelectSource->findChildren<QPushButton*>())
+	const auto id = clickedButton->property("station").toInt();
+
+	TRACE_SCOPE("onSourceButtonClicked", "player");
+
+	//the playing page is updated by onCurrentStationChanged, the same way as for a station switched by another client
+	if(false == m_Core.play(id)) clickedButton->setChecked(id == m_Core.currentId());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::onCurrentStationChanged(int id)
+{
+	const auto station = m_Core.currentStation();
+
+	for(auto button : m_SourceButtons) button->setChecked(id == button->property("station").toInt());
+
+	const auto style = cstrDefaultLabelStyleSheet.arg(station->m_cBackgroundColorNormal.name(QColor::HexArgb));
+	m_ui->lblStation->setStyleSheet(style);
+
+	showStationLogo();
+
+	SetFittingText(m_TextFitter, m_ui->labelInfo1, station->m_strDefaultPublisher);
+	SetFittingText(m_TextFitter, m_ui->labelInfo2, QString());
+
+	//the meta data of the previous station is of no use for this one
+	m_FirstMetadata = DisplayedMetadata();
+	m_SecondMetadata = DisplayedMetadata();
+
+	m_ui->btnStartStop->setChecked(true);
+	m_ui->btnStartStop->setIcon(QIcon(":/Resources/Resources/pause.png"));
+
+	emit m_ui->btnPlayingPage->clicked();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::on_btnPreviousPage_clicked()
+{
+	showPage(m_iPage - 1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::on_btnNextPage_clicked()
+{
+	showPage(m_iPage + 1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::on_lineEditSearch_textChanged(const QString &text)
+{
+	m_SearchResults = m_StationSearch.search(text);
+	showPage(0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::on_btnLoadLogos_clicked()
+{
+	auto &stations = m_Core.stations();
+
+	//only the visible stations are fetched again, requests still running are reused so repeated presses do not pile up
+	for(auto button : m_SourceButtons)
 	{
-		button->setChecked(button == sender());
-		if(button == sender()) clickedButton = button;
+		const auto id = button->property("station").toInt();
+		const auto station = stations.station(id);
+
+		if((nullptr == station) || (false == station->m_uLogoUrl.isValid())) continue;
+
+		const auto priority = button->isChecked() ? 1 : 0;
+
+		if(StationModel::LogoLoading == stations.logoState(id))
+		{
+			m_LogoDownLoader->setPriority(station->m_uLogoUrl, priority);
+		}
+		else
+		{
+			stations.setLogoState(id, StationModel::LogoNotLoaded);
+			requestLogo(id, priority);
+		}
 	}
+}
+//----------------------------------------------------------------------------------------------------------------------
 
-	if(nullptr != clickedButton)
-	{
-		m_CurrentStation = clickedButton->property("station").value<StationInformation>();
+void RadioGui::onPlayerStateChanged(QMediaPlayer::State state)
+{
+	const auto playing = (QMediaPlayer::PlayingState == state);
 
-		//the station logo may be too small or too big, scale for consistent look
-		auto logo = ScaleLogoToRectangle(QPixmap(m_CurrentStation.m_pStationLogo), m_ui->lblStation->contentsRect(), 0.8);
+	m_ui->btnStartStop->setChecked(playing);
+	m_ui->btnStartStop->setIcon((true == playing) ? QIcon(":/Resources/Resources/pause.png") :
+																									QIcon(":/Resources/Resources/play-button.png"));
+}
+//----------------------------------------------------------------------------------------------------------------------
 
-		const auto style = cstrDefaultLabelStyleSheet.arg(m_CurrentStation.m_cBackgroundColorNormal.name(QColor::HexArgb));
-		m_ui->lblStation->setStyleSheet(style);
-		m_ui->lblStation->setPixmap(logo);
+void RadioGui::onPlayerChanged(QMediaPlayer* player)
+{
+	//the analyzer follows the promoted standby player
+	if((true == m_bLevelMeter) && (false == m_bIdle)) m_AudioProbe.setSource(player);
+}
+//----------------------------------------------------------------------------------------------------------------------
 
+void RadioGui::onMetaDataChanged()
+{
+	//nobody is looking, the latest values are read when the idle mode is left
+	if(true == m_bIdle)
+	{
+		m_bMetadataDeferred = true;
+		return;
+	}
 
-		m_ui->labelInfo1->setText(m_CurrentStation.m_strDefaultPublisher);
-		m_ui->labelInfo2->setText(QString());
+	applyMetadata();
+}
+//----------------------------------------------------------------------------------------------------------------------
 
-		SetMaximumFontForTextContainer(m_ui->labelInfo1);
-		SetMaximumFontForTextContainer(m_ui->labelInfo2);
+bool RadioGui::eventFilter(QObject* watched, QEvent* event)
+{
+	switch(event->type())
+	{
+	case QEvent::MouseButtonPress:
+	case QEvent::TouchBegin:
+	case QEvent::KeyPress:
+	case QEvent::Wheel:
+		if(0 < m_IdleTimer.interval()) m_IdleTimer.start();
 
-		if(QMediaPlayer::PlayingState == m_Player->state())
+		if(true == m_bIdleTimedOut)
 		{
-			m_Player->stop();
+			m_bIdleTimedOut = false;
+
+			const auto wasIdle = m_bIdle;
+			updateIdle();
+
+			//the screen was blank, the press was only meant to wake it up
+			if((true == wasIdle) && (false == m_bIdle)) return true;
 		}
+		break;
+	default:
+		break;
+	}
+
+	if((m_ui->lblStation == watched) && (QEvent::Resize == event->type()))
+	{
+		//all renditions were made for the old geometry
+		m_LogoScaler->invalidate();
+		m_LogoScaler->addTarget(m_ui->btn1->iconSize(), 1.0, devicePixelRatioF());
+		m_LogoScaler->addTarget(m_ui->lblStation->contentsRect().size(), 0.8, m_ui->lblStation->devicePixelRatioF());
+		m_LogoScaler->setMaximumSize(maximumLogoSize());
 
-		m_Player->setMedia(QMediaContent(m_CurrentStation.m_strMediaUrl));
-		m_Player->setVolume(ciDefaultVolume);
-		m_Player->play();
+		showStationLogo();
+	}
+
+	return QMainWindow::eventFilter(watched, event);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::showButtonLogo(StationTile* button, int id)
+{
+	auto &stations = m_Core.stations();
 
-		m_ui->btnStartStop->setChecked(true);
-		m_ui->btnStartStop->setIcon(QIcon(":/Resources/Resources/pause.png"));
+	const auto station = stations.station(id);
+	if(nullptr == station) return;
 
-		emit m_ui->btnPlayingPage->clicked();
+	if(StationModel::LogoMissing == stations.logoState(id))
+	{
+		button->setLogo(QPixmap());
+		SetFittingText<QAbstractButton>(m_TextFitter, button, station->m_strDefaultPublisher);
+		return;
 	}
+
+	//the tile gets a rendition matching the icon size, so nothing needs to be scaled on each repaint
+	m_LogoScaler->scaledLogo(id, button->iconSize(), 1.0, button->devicePixelRatioF(),
+													 [=](QPixmap scaledLogo)
+													 {
+														 //the button may show another station by now
+														 if(id != button->property("station").toInt()) return;
+
+														 button->setLogo(scaledLogo);
+														 button->setText(QString());
+													 });
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-void RadioGui::on_btnLoadLogos_clicked()
+void RadioGui::setStationLogo(int id, const QImage &logo)
 {
-	auto buttons = m_ui->pageSelectSource->findChildren<QPushButton*>();
+	auto &stations = m_Core.stations();
+
+	const auto station = stations.station(id);
+	if(nullptr == station) return;
 
-	for(const auto &button : buttons)
+	//the scaler keeps the logo, downscaled to the largest size it is displayed at
+	stations.setLogoState(id, (true == logo.isNull()) ? StationModel::LogoMissing : StationModel::LogoLoaded);
+	m_LogoScaler->setLogo(id, logo);
+
+	for(auto button : m_SourceButtons)
 	{
-		StationInformation station = button->property("station").value<StationInformation>();
+		if(id == button->property("station").toInt()) showButtonLogo(button, id);
+	}
 
-		//if a valid url is given, we need to download the logo now
-		if(true == station.m_uLogoUrl.isValid())
-		{
-			m_LogoDownLoader->downloadLogo(station.m_uLogoUrl,
-																		 [=](QPixmap logo)
-																		 {
-																				auto s = button->property("station").value<StationInformation>();
-																				button->setIcon(QIcon(logo));
-																				s.m_pStationLogo = logo;
-																				button->setProperty("station", QVariant::fromValue(s));
-
-																				//be positive and expect a valid icon to be set
-																				button->setText(QString());
-
-																				if(true == button->icon().isNull())
-																				{
-																					button->setText(s.m_strDefaultPublisher);
-																					SetMaximumFontForTextContainer<QAbstractButton>(button);
-																				}
-																		 });
-		}
+	//the logo may arrive after the station was selected, in that case the playing page needs an update as well
+	if(id == m_Core.currentId()) showStationLogo();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::onLogoEvicted(int id)
+{
+	auto &stations = m_Core.stations();
+
+	if(StationModel::LogoLoaded != stations.logoState(id)) return;
+
+	//loaded again from the catalog or the disk cache the next time the station is shown, the icons already set keep
+	//their own copy, so evicting a visible logo does not blank it
+	stations.setLogoState(id, StationModel::LogoNotLoaded);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QSize RadioGui::maximumLogoSize() const
+{
+	const auto iconSize = m_ui->btn1->iconSize() * m_ui->btn1->devicePixelRatioF();
+	const auto labelSize = m_ui->lblStation->contentsRect().size() * m_ui->lblStation->devicePixelRatioF();
+
+	return iconSize.expandedTo(labelSize);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::showStationLogo()
+{
+	TRACE_SCOPE("showStationLogo", "logo");
+
+	const auto id = m_Core.currentId();
+
+	//the previous logo must not stay visible while the rendition for this station is not ready
+	m_ui->lblStation->setPixmap(QPixmap());
+	if(0 > id) return;
+
+	//the logo may have been evicted since, the rendition is served once it is loaded again
+	requestLogo(id, 1);
+
+	//the station logo may be too small or too big, a pre-scaled rendition keeps the look consistent
+	m_LogoScaler->scaledLogo(id, m_ui->lblStation->contentsRect().size(), 0.8, m_ui->lblStation->devicePixelRatioF(),
+													 [=](QPixmap logo)
+													 {
+														 if(id == m_Core.currentId()) m_ui->lblStation->setPixmap(logo);
+													 });
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::applyMetadata()
+{
+	TRACE_SCOPE("applyMetadata", "metadata");
+
+	const auto station = m_Core.currentStation();
+
+	updateMetadata(station->m_strFirstMetadataKey, m_FirstMetadata, m_ui->labelInfo1);
+	updateMetadata(station->m_strSecondMetadataKey, m_SecondMetadata, m_ui->labelInfo2);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::onStationProbed(const QString &url)
+{
+	for(auto button : m_SourceButtons)
+	{
+		const auto station = m_Core.stations().station(button->property("station").toInt());
+		if((nullptr == station) || (false == PlaybackCore::stationUrls(station).contains(url))) continue;
+
+		button->setOffline(m_Core.isDead(station));
 	}
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-void RadioGui::onMediaChanged()
+void RadioGui::updateMetadata(const QString &key, DisplayedMetadata &metadata, QLabel* label)
+{
+	if(true == key.isEmpty()) return;
+
+	//the station information may name another key since the value was displayed
+	if(key != metadata.m_strKey)
+	{
+		metadata = DisplayedMetadata();
+		metadata.m_strKey = key;
+	}
+
+	const auto value = m_Core.metaData(key);
+	if(false == value.isValid()) return;
+
+	//nothing changed, no relayout needed
+	const auto text = value.toString();
+	if((true == metadata.m_bDisplayed) && (text == metadata.m_strValue)) return;
+
+	metadata.m_strValue = text;
+	metadata.m_bDisplayed = true;
+
+	SetFittingText(m_TextFitter, label, text);
+
+	emit metadataDisplayed(text);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::updateLiveButton()
+{
+	m_ui->btnLive->setEnabled(m_Core.isTimeShifted());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::updateStatistics()
 {
-	for(auto i : m_Player->availableMetaData())
+	QStringList lines;
+	lines << QString("Logo cache: %1 hits, %2 misses").arg(m_LogoScaler->hits()).arg(m_LogoScaler->misses());
+	lines << QString("Text fit cache: %1 hits, %2 misses").arg(m_TextFitter.hits()).arg(m_TextFitter.misses());
+
+	const auto budget = m_LogoScaler->memoryBudget();
+	lines << QString("Logo memory: %1 KiB of %2").arg(m_LogoScaler->memory() / 1024)
+																							.arg((0 < budget) ? QString("%1 KiB").arg(budget / 1024) : QString("unlimited"));
+
+	const auto reader = StreamReader::find(m_Core.player());
+	if(nullptr != reader)
 	{
-		if(m_CurrentStation.m_strFirstMetadataKey.toLower() == i.toLower())
+		lines << QString("Stream buffer: %1 KiB of %2 KiB%3").arg(reader->bufferFill() / 1024)
+																											 .arg(reader->bufferTarget() / 1024)
+																											 .arg(reader->isBuffering() ? QString(", buffering") : QString());
+		lines << QString("Stream: %1 reconnects, %2 underruns").arg(reader->reconnects()).arg(reader->underruns());
+
+		if(true == reader->isTimeShifted()) lines << QString("Time shift: %1 s").arg(reader->timeShift() / 1000);
+	}
+
+	if(true == m_bLevelMeter)
+	{
+		const auto load = QString::number(m_AudioAnalyzer.load() * 100.0, 'f', 2);
+		lines << QString("Level meter: %1 % load (%2), %3 buffers dropped").arg(load).arg(AudioKernels::instructionSet())
+																																			.arg(m_AudioAnalyzer.dropped());
+	}
+
+	const auto &stations = m_Core.stations();
+
+	auto offline = 0;
+	for(auto row = 0; row < stations.rowCount(); ++row)
+	{
+		if(true == m_Core.isDead(stations.station(stations.id(row)))) ++offline;
+	}
+
+	lines << QString("Stations: %1 of %2 offline%3").arg(offline).arg(stations.rowCount())
+																								 .arg(m_Core.prober().isIdle() ? QString() : QString(", probing"));
+
+	m_WakeupCounter.sample();
+
+	//a mode is only reported once it was measured for a while
+	QStringList wakeups;
+	for(const auto mode : {WakeupCounter::Active, WakeupCounter::Idle})
+	{
+		const auto rate = m_WakeupCounter.wakeupsPerSecond(mode);
+		wakeups << ((0.0 <= rate) ? QString::number(rate, 'f', 1) : QString("-"));
+	}
+
+	lines << QString("Wakeups: %1/s active, %2/s idle").arg(wakeups.at(0)).arg(wakeups.at(1));
+
+	if(true == StallWatchdog::isEnabled())
+	{
+		const auto stalls = StallWatchdog::stalls();
+
+		//only the recent stalls are kept, the longest of them is the one worth looking into
+		auto longest = StallWatchdog::Stall();
+		for(const auto &stall : stalls) if(longest.m_iDuration < stall.m_iDuration) longest = stall;
+
+		if(true == stalls.isEmpty())
 		{
-			m_ui->labelInfo1->setText(m_Player->metaData(i).toString());
-			SetMaximumFontForTextContainer(m_ui->labelInfo1);
+			lines << QString("Stalls: none");
 		}
-
-		if(m_CurrentStation.m_strSecondMetadataKey.toLower() == i.toLower())
+		else
 		{
-			m_ui->labelInfo2->setText(m_Player->metaData(i).toString());
-			SetMaximumFontForTextContainer(m_ui->labelInfo2);
+			const auto where = (true == longest.m_strScope.isEmpty()) ? longest.m_strEvent : longest.m_strScope;
+			lines << QString("Stalls: %1, the longest %2 ms in %3").arg(StallWatchdog::count()).arg(longest.m_iDuration)
+																																.arg(where);
 		}
 	}
+
+	m_ui->labelStatistics->setText(lines.join(QLatin1Char('\n')));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::updateIdle()
+{
+	const auto idleFile = (false == m_strIdleFile.isEmpty()) && (true == QFileInfo::exists(m_strIdleFile));
+
+	setIdle((true == m_bIdleTimedOut) || (true == idleFile));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RadioGui::setIdle(bool idle)
+{
+	if(idle == m_bIdle) return;
+
+	TRACE_SCOPE("setIdle", "power");
+	Tracer::instant("idle", "power", (true == idle) ? QString("enter") : QString("leave"));
+
+	m_bIdle = idle;
+	m_WakeupCounter.setMode((true == m_bIdle) ? WakeupCounter::Idle : WakeupCounter::Active);
+
+	if(true == m_bIdle)
+	{
+		//nothing is repainted, a running metadata update is postponed as well
+		m_ui->centralWidget->setUpdatesEnabled(false);
+
+		m_AudioProbe.setSource(static_cast<QMediaObject*>(nullptr));
+
+		//the probes and the standby players wait until somebody could switch stations
+		m_Core.setIdle(true);
+	}
+	else
+	{
+		//everything deferred is applied in one go, the gui is repainted once at the end
+		if(true == m_bLevelMeter) m_AudioProbe.setSource(m_Core.player());
+
+		const auto logos = m_DeferredLogos;
+		m_DeferredLogos.clear();
+		for(auto it = logos.cbegin(); it != logos.cend(); ++it) requestLogo(it.key(), it.value());
+
+		if(true == m_bMetadataDeferred) applyMetadata();
+		m_bMetadataDeferred = false;
+
+		m_Core.setIdle(false);
+
+		if(m_ui->pageSettings == m_ui->stackedWidget->currentWidget()) updateStatistics();
+
+		m_ui->centralWidget->setUpdatesEnabled(true);
+	}
+
+	emit idleChanged(m_bIdle);
 }
 //----------------------------------------------------------------------------------------------------------------------
@@ -2,10 +2,26 @@
 
 #include <memory>
 
+#include <QAudioProbe>
+#include <QFileSystemWatcher>
 #include <QMainWindow>
+#include <QMap>
 #include <QMediaPlayer>
+#include <QSet>
+#include <QTimer>
 
+#include "AudioAnalyzer.h"
+#include "LogoDecoder.h"
 #include "LogoDownloader.h"
+#include "LogoScaler.h"
+#include "PlaybackCore.h"
+#include "StationSearch.h"
+#include "StationTile.h"
+#include "TextFitter.h"
+#include "WakeupCounter.h"
+
+class QLabel;
+class QPushButton;
 
 namespace Ui
 {
@@ -15,93 +31,163 @@ class RadioGui;
 }
 
 /**
- * @brief The StationInformation struct contains all information to describe a single radtio station stream
+ * @brief The RadioGui class provides the main window for the radio gui
  */
-struct StationInformation
+class RadioGui : public QMainWindow
 {
+	Q_OBJECT
+
+ public:
+
 	/**
-	 * @brief m_strDefaultPublisher The station publisher information, this is usually the station name
-	 *
-	 * @note This string is used as the default title when playing this station. If the first metadata key returns any
-	 * useful string data, that string is displayed instead.
+	 * @brief RadioGui Default constructor
+	 * @param parent
 	 */
-	QString m_strDefaultPublisher;
+	explicit RadioGui(const QString &stationsFileName = QString("stations.json"), QWidget *parent = nullptr);
 
-	//! From where to load the audio, must point to a format understandable by QMediaPlayer
-	QString m_strMediaUrl;
+	/**
+	 * @brief ~RadioGui Default destructor
+	 */
+	virtual ~RadioGui();
 
 	/**
-	 * @brief m_uLogoUrl The RadioGui tries to download the station logo from this url if provided
+	 * @brief start Load the stations and play the first one
 	 *
-	 * @note Must be in a format suitable for QPixmap
+	 * @note Called once the stream buffer, time shift and standby players are configured, so the first station is
+	 * connected only once and with its final settings
+	 */
+	void start();
+
+	/**
+	 * @brief setLogoMemoryBudget Limit the memory used by the station logos, the least recently shown ones are dropped
+	 * @param bytes The budget in bytes, 0 for no limit
+	 */
+	void setLogoMemoryBudget(qint64 bytes);
+
+	/**
+	 * @brief setStandbyPlayers Enable zapping mode, keeping muted players connected to the likely next stations
+	 * @param count The maximum number of standby players, 0 disables zapping mode
+	 * @param memoryBudget The memory the standby players may use in bytes, 0 for no limit
 	 */
-	QUrl m_uLogoUrl;
+	void setStandbyPlayers(int count, qint64 memoryBudget = 0);
 
 	/**
-	 * @brief m_pStationLogo The station logo to display.
+	 * @brief setStreamBuffer Play the streams through a jitter buffer which reconnects broken streams transparently
+	 * @param milliseconds The amount of audio to buffer before playing, 0 to let the players connect themselves
 	 *
-	 * @note If m_uLogoUrl is set, this pixmap is set to the image data downloaded from m_uLogoUrl
+	 * @note The current station is connected again if it is playing
 	 */
-	QPixmap m_pStationLogo;
+	void setStreamBuffer(int milliseconds);
 
 	/**
-	 * @brief m_strFirstMetadataKey The data to display as the title for this stream, if this key can be found in the
-	 * meta data returned from the stream, that string is displayed
+	 * @brief setTimeShift Keep receiving the stream while paused, so playback resumes where it was paused
+	 * @param seconds The longest time shift in seconds, 0 lets pause stop the stream
+	 * @param size The largest time shift file in bytes
+	 *
+	 * @note Only works with a stream buffer, see setStreamBuffer()
 	 */
-	QString m_strFirstMetadataKey;
+	void setTimeShift(int seconds, qint64 size);
 
 	/**
-	 * @brief m_strSecondMetadataKey The secondary information to be displayed below the main metadata string
+	 * @brief setLevelMeter Show the level meter on the playing page, the decoded audio is only analyzed while it is shown
+	 * @param enabled True to show the meter
+	 *
+	 * @note The meter stays at the bottom if the media backend does not support audio probes
 	 */
-	QString m_strSecondMetadataKey;
+	void setLevelMeter(bool enabled);
 
 	/**
-	 * @brief m_cBackgroundColor The background color for the stations button when the button is not checked
+	 * @brief setIdleTimeout Enter the idle mode when nobody used the screen for a while, any input leaves it again
+	 * @param seconds The time without input in seconds, 0 disables the timeout
 	 *
-	 * @note The default color is defined as: rgb(0, 0, 0)
+	 * In the idle mode only the audio keeps running. The gui is not repainted, meta data changes are only noted, logo
+	 * requests, probes and standby players are deferred. All of it is applied at once when the idle mode is left.
 	 */
-	QColor m_cBackgroundColorNormal;
+	void setIdleTimeout(int seconds);
 
 	/**
-	 * @brief m_cBackgroundColorChecked The background color for checked buttons
+	 * @brief setIdleFile Stay in the idle mode while a file exists, e.g. created by the screen blanker
+	 * @param file The file, empty to not watch any file
 	 *
-	 * @note The default color is defined as: rgb(72, 126, 176)
+	 * @note The directory of the file has to exist
 	 */
-	QColor m_cBackgroundColorChecked;
-};
+	void setIdleFile(const QString &file);
 
-/**
- * @brief The RadioGui class provides the main window for the radio gui
- */
-class RadioGui : public QMainWindow
-{
-	Q_OBJECT
+	/**
+	 * @brief isIdle Whether the gui is in the idle mode
+	 * @return True if only the audio is running
+	 */
+	bool isIdle() const;
 
- public:
+	/**
+	 * @brief core The playback core played through the gui, further clients like the control socket share it
+	 * @return The playback core
+	 */
+	PlaybackCore& core();
 
 	/**
-	 * @brief RadioGui Default constructor
-	 * @param parent
+	 * @brief playerState The state of the player of the current station
+	 * @return The player state
 	 */
-	explicit RadioGui(const QString &stationsFileName = QString("stations.json"), QWidget *parent = nullptr);
+	QMediaPlayer::State playerState() const;
 
 	/**
-	 * @brief ~RadioGui Default destructor
+	 * @brief mediaStatus The media status of the player of the current station
+	 * @return The media status
 	 */
-	virtual ~RadioGui();
+	QMediaPlayer::MediaStatus mediaStatus() const;
+
+signals:
+
+	/**
+	 * @brief playerStateChanged Emitted when the state of the player of the current station changes
+	 * @param state The new state
+	 */
+	void playerStateChanged(QMediaPlayer::State state);
+
+	/**
+	 * @brief mediaStatusChanged Emitted when the media status of the player of the current station changes
+	 * @param status The new status
+	 */
+	void mediaStatusChanged(QMediaPlayer::MediaStatus status);
+
+	/**
+	 * @brief metadataDisplayed Emitted when a changed meta data value is displayed on the playing page
+	 * @param text The value
+	 */
+	void metadataDisplayed(const QString &text);
+
+	/**
+	 * @brief idleChanged Emitted when the idle mode is entered or left
+	 * @param idle True if the idle mode was entered
+	 */
+	void idleChanged(bool idle);
 
 private slots:
 
+
 	/**
-	 * @brief loadStations Called during construction to load the stations from the stations.json file
+	 * @brief onLogoEvicted Mark an evicted logo as not loaded, it is loaded again when needed
+	 * @param id The station id
 	 */
-	void loadStations();
+	void onLogoEvicted(int id);
 
 	/**
-	 * @brief on_btnStartStop_clicked Stop playing the current station. Does nothing if no station is playing
+	 * @brief on_btnStartStop_clicked Pause or resume the current station, pausing stops it if time shifting is disabled
 	 */
 	void on_btnStartStop_clicked();
 
+	/**
+	 * @brief on_btnLive_clicked Drop the time shifted audio and continue with the live stream
+	 */
+	void on_btnLive_clicked();
+
+	/**
+	 * @brief on_lineEditSearch_textChanged Show the stations matching the search text, all stations if it is empty
+	 * @param text The search text
+	 */
+	void on_lineEditSearch_textChanged(const QString &text);
+
 	/**
 	 * @brief on_btnLoadLogos_clicked Reload any pending logo files
 	 */
@@ -118,17 +204,169 @@ private slots:
 	void onSourceButtonClicked();
 
 	/**
-	 * @brief onMediaChanged Used to detect when new media is available. This method is used to extract any available
-	 * meta data from the stream and tries to read the meta data keys contained in the station information.
+	 * @brief on_btnPreviousPage_clicked Show the previous page of stations
+	 */
+	void on_btnPreviousPage_clicked();
+
+	/**
+	 * @brief on_btnNextPage_clicked Show the next page of stations
+	 */
+	void on_btnNextPage_clicked();
+
+
+	/**
+	 * @brief onCurrentStationChanged Show another station on the playing page, whoever switched to it
+	 * @param id The station id
+	 */
+	void onCurrentStationChanged(int id);
+
+	/**
+	 * @brief onStationsAboutToReload Note the logos still loading before the changed stations file is merged
+	 */
+	void onStationsAboutToReload();
+
+	/**
+	 * @brief onStationsReloaded Update the stations shown after the changed stations file was merged
+	 * @param changes The changes
+	 */
+	void onStationsReloaded(const StationModel::Changes &changes);
+
+	/**
+	 * @brief onPlayerStateChanged Show whether the current station is playing
+	 * @param state The new player state
+	 */
+	void onPlayerStateChanged(QMediaPlayer::State state);
+
+	/**
+	 * @brief onPlayerChanged Analyze the audio of a promoted standby player
+	 * @param player The new player
+	 */
+	void onPlayerChanged(QMediaPlayer* player);
+
+	/**
+	 * @brief onMetaDataChanged Display the changed meta data, only noted in the idle mode
+	 */
+	void onMetaDataChanged();
+
+	/**
+	 * @brief applyMetadata Extract the available meta data from the stream and display the values for the meta data
+	 * keys contained in the station information
+	 */
+	void applyMetadata();
+
+
+	/**
+	 * @brief onStationProbed Flag the shown stations which are offline
+	 * @param url The probed url
 	 */
-	void onMediaChanged();
+	void onStationProbed(const QString &url);
+
+protected:
+
+	/**
+	 * @brief eventFilter Used to render the station logo again when the station label is resized, and to leave the idle
+	 * mode on input
+	 * @param watched The watched object
+	 * @param event The event
+	 * @return True for the press which woke the gui from the idle mode, so it does not hit a button by accident
+	 */
+	bool eventFilter(QObject* watched, QEvent* event) override;
 
 private:
 
 	/**
-	 * @brief m_strStationsFile From where to load the station information, defaults to "stations.json"
+	 * @brief The DisplayedMetadata struct tracks one of the meta data values shown on the playing page
+	 */
+	struct DisplayedMetadata
+	{
+		//! The meta data key from the station information the value was displayed for
+		QString m_strKey;
+
+		//! The value currently displayed
+		QString m_strValue;
+
+		//! True once a value was displayed for the current station
+		bool m_bDisplayed = false;
+	};
+
+	/**
+	 * @brief updateMetadata Display a meta data value if it changed
+	 * @param key The lower case meta data key from the station information
+	 * @param metadata The state of the displayed value
+	 * @param label Where to display the value
+	 */
+	void updateMetadata(const QString &key, DisplayedMetadata &metadata, QLabel* label);
+
+
+
+
+
+	/**
+	 * @brief updateLiveButton Enable the live button while the current station plays behind the live stream
+	 */
+	void updateLiveButton();
+
+
+
+	/**
+	 * @brief updateSearchIndex Index all stations of the model for the station search
+	 */
+	void updateSearchIndex();
+
+	/**
+	 * @brief showPage Assign the stations of a page to the station buttons and request their logos
+	 * @param page The page, clamped to the available pages
+	 */
+	void showPage(int page);
+
+	/**
+	 * @brief requestLogo Start decoding or downloading the logo of a station unless it is already loading
+	 * @param id The station id
+	 * @param priority The download priority
+	 */
+	void requestLogo(int id, int priority);
+
+	/**
+	 * @brief showButtonLogo Display the logo of a station on a station button
+	 * @param button The station button
+	 * @param id The station id, the button is left alone once it shows another station
+	 */
+	void showButtonLogo(StationTile* button, int id);
+
+	/**
+	 * @brief setStationLogo Publish a decoded or downloaded logo for a station
+	 * @param id The station id, ignored if the station no longer exists
+	 * @param logo The logo, if null the station name is displayed instead
+	 */
+	void setStationLogo(int id, const QImage &logo);
+
+	/**
+	 * @brief maximumLogoSize The largest size a logo is displayed at
+	 * @return The size in device pixels
+	 */
+	QSize maximumLogoSize() const;
+
+	/**
+	 * @brief showStationLogo Display the logo of the current station on the playing page
+	 */
+	void showStationLogo();
+
+	/**
+	 * @brief updateStatistics Show the current runtime statistics on the settings page
+	 */
+	void updateStatistics();
+
+	/**
+	 * @brief updateIdle Enter or leave the idle mode depending on the timeout and the idle file
+	 */
+	void updateIdle();
+
+	/**
+	 * @brief setIdle Enter the idle mode, or leave it and apply the deferred work
+	 * @param idle True to enter the idle mode
 	 */
-	const QString m_strStationsFile;
+	void setIdle(bool idle);
+
 
 	/**
 	 * @brief ui The user interface
@@ -136,20 +374,135 @@ private:
 	Ui::RadioGui* m_ui;
 
 	/**
-	 * @brief m_CurrentMedia The currently selected media
+	 * @brief m_Core Loads and plays the stations, the gui only shows them
+	 */
+	PlaybackCore m_Core;
+
+
+
+
+	/**
+	 * @brief m_StationSearch The search index over the stations of m_Core
+	 */
+	StationSearch m_StationSearch;
+
+	/**
+	 * @brief m_SearchResults The rows matching the search text, the best match first
+	 */
+	QVector<int> m_SearchResults;
+
+	/**
+	 * @brief m_SourceButtons The station buttons on the select source page, in page order. Each button keeps the id of
+	 * the station it shows in its "station" property
+	 */
+	QList<StationTile*> m_SourceButtons;
+
+	/**
+	 * @brief m_iPage The page of stations currently shown on the select source page
+	 */
+	int m_iPage;
+
+
+
+
+
+
+
+
+	/**
+	 * @brief m_bLevelMeter True if the level meter is shown
+	 */
+	bool m_bLevelMeter;
+
+	/**
+	 * @brief m_AudioAnalyzer Measures the decoded audio for the level meter
 	 */
-	StationInformation m_CurrentStation;
+	AudioAnalyzer m_AudioAnalyzer;
 
 	/**
-	 * @brief m_Player The instance used to play the media urls
+	 * @brief m_AudioProbe Passes the decoded audio of the current player to m_AudioAnalyzer
 	 */
-	std::shared_ptr<QMediaPlayer> m_Player;
+	QAudioProbe m_AudioProbe;
 
 	/**
 	 * @brief m_LogoDownLoader Used when station logos need to be downloaded
 	 */
 	std::shared_ptr<LogoDownloader> m_LogoDownLoader;
-};
 
-//we want to store StationInformation values as properties in QObject instances
-Q_DECLARE_METATYPE(StationInformation)
+	/**
+	 * @brief m_LogoDecoder Used to decode embedded and file logos off the gui thread
+	 */
+	std::shared_ptr<LogoDecoder> m_LogoDecoder;
+
+	/**
+	 * @brief m_LogoScaler Keeps pre-scaled renditions of the station logos for the label and the buttons
+	 */
+	std::shared_ptr<LogoScaler> m_LogoScaler;
+
+	/**
+	 * @brief m_TextFitter Finds the font sizes for the station and metadata texts
+	 */
+	TextFitter m_TextFitter;
+
+
+
+
+	/**
+	 * @brief m_bIdle True while in the idle mode
+	 */
+	bool m_bIdle;
+
+	/**
+	 * @brief m_bIdleTimedOut True if there was no input for the idle timeout
+	 */
+	bool m_bIdleTimedOut;
+
+	/**
+	 * @brief m_IdleTimer Expires when there was no input for the idle timeout
+	 */
+	QTimer m_IdleTimer;
+
+	/**
+	 * @brief m_strIdleFile The gui stays in the idle mode while this file exists, empty if no file is watched
+	 */
+	QString m_strIdleFile;
+
+	/**
+	 * @brief m_IdleFileWatcher Watches the directory of m_strIdleFile
+	 */
+	QFileSystemWatcher m_IdleFileWatcher;
+
+	/**
+	 * @brief m_bMetadataDeferred True if the meta data changed during the idle mode
+	 */
+	bool m_bMetadataDeferred;
+
+
+
+	/**
+	 * @brief m_DeferredLogos The logos requested during the idle mode, by station id, with their priority
+	 */
+	QMap<int, int> m_DeferredLogos;
+
+	/**
+	 * @brief m_ReloadingLogos The ids of the stations whose logos were loading when the stations file changed
+	 */
+	QSet<int> m_ReloadingLogos;
+
+	/**
+	 * @brief m_WakeupCounter Measures the wakeups in the active and the idle mode
+	 */
+	WakeupCounter m_WakeupCounter;
+
+
+
+	/**
+	 * @brief m_FirstMetadata The state of the first meta data value
+	 */
+	DisplayedMetadata m_FirstMetadata;
+
+	/**
+	 * @brief m_SecondMetadata The state of the second meta data value
+	 */
+	DisplayedMetadata m_SecondMetadata;
+};
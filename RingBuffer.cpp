@@ -0,0 +1,92 @@
+#include "RingBuffer.h"
+
+#include <cstring>
+
+RingBuffer::RingBuffer(qint64 capacity)
+	: m_Data()
+	, m_iMask(0)
+	, m_uWritePosition(0)
+	, m_uReadPosition(0)
+{
+	qint64 size = 1;
+	while(size < capacity) size <<= 1;
+
+	m_Data.resize(static_cast<int>(size));
+	m_iMask = size - 1;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 RingBuffer::capacity() const
+{
+	return m_iMask + 1;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 RingBuffer::size() const
+{
+	return static_cast<qint64>(m_uWritePosition.load() - m_uReadPosition.load());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 RingBuffer::free() const
+{
+	return capacity() - size();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 RingBuffer::writePosition() const
+{
+	return m_uWritePosition.load();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 RingBuffer::readPosition() const
+{
+	return m_uReadPosition.load();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 RingBuffer::write(const char* data, qint64 length)
+{
+	const auto position = m_uWritePosition.load(std::memory_order_relaxed);
+	const auto count = qMin(length, capacity() - static_cast<qint64>(position - m_uReadPosition.load()));
+	if(0 >= count) return 0;
+
+	//the data may wrap around the end of the storage
+	const auto index = static_cast<qint64>(position) & m_iMask;
+	const auto first = qMin(count, capacity() - index);
+
+	std::memcpy(m_Data.data() + index, data, static_cast<size_t>(first));
+	std::memcpy(m_Data.data(), data + first, static_cast<size_t>(count - first));
+
+	//publishing the position hands the bytes over to the consumer
+	m_uWritePosition.store(position + static_cast<quint64>(count));
+
+	return count;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 RingBuffer::read(char* data, qint64 length)
+{
+	const auto position = m_uReadPosition.load(std::memory_order_relaxed);
+	const auto count = qMin(length, static_cast<qint64>(m_uWritePosition.load() - position));
+	if(0 >= count) return 0;
+
+	const auto index = static_cast<qint64>(position) & m_iMask;
+	const auto first = qMin(count, capacity() - index);
+
+	std::memcpy(data, m_Data.constData() + index, static_cast<size_t>(first));
+	std::memcpy(data + first, m_Data.constData(), static_cast<size_t>(count - first));
+
+	//publishing the position hands the space back to the producer
+	m_uReadPosition.store(position + static_cast<quint64>(count));
+
+	return count;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void RingBuffer::clear()
+{
+	m_uReadPosition.store(m_uWritePosition.load());
+}
+//----------------------------------------------------------------------------------------------------------------------
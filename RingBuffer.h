@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief The RingBuffer class is a lock-free byte queue between a single producer and a single consumer thread
+ *
+ * The producer only calls write(), the consumer only calls read() and clear(). Both may query the fill level at any
+ * time. The read and write positions grow monotonically, so a full buffer is told apart from an empty one without
+ * wasting a byte.
+ */
+class RingBuffer
+{
+public:
+
+	/**
+	 * @brief RingBuffer Default constructor
+	 * @param capacity The minimum capacity in bytes, rounded up to the next power of two
+	 */
+	explicit RingBuffer(qint64 capacity);
+
+	/**
+	 * @brief capacity The number of bytes the buffer holds at most
+	 * @return The capacity in bytes
+	 */
+	qint64 capacity() const;
+
+	/**
+	 * @brief size The number of buffered bytes
+	 * @return The fill level in bytes
+	 */
+	qint64 size() const;
+
+	/**
+	 * @brief free The number of bytes which can be written without blocking
+	 * @return The free space in bytes
+	 */
+	qint64 free() const;
+
+	/**
+	 * @brief writePosition The number of bytes written since the buffer was created
+	 * @return The stream position of the next byte written
+	 */
+	quint64 writePosition() const;
+
+	/**
+	 * @brief readPosition The number of bytes read or cleared since the buffer was created
+	 * @return The stream position of the next byte read
+	 */
+	quint64 readPosition() const;
+
+	/**
+	 * @brief write Append data, producer only
+	 * @param data The data
+	 * @param length The number of bytes to append
+	 * @return The number of bytes appended, less than length if the buffer is full
+	 */
+	qint64 write(const char* data, qint64 length);
+
+	/**
+	 * @brief read Take data from the front, consumer only
+	 * @param data Receives the data
+	 * @param length The maximum number of bytes to take
+	 * @return The number of bytes taken
+	 */
+	qint64 read(char* data, qint64 length);
+
+	/**
+	 * @brief clear Drop all buffered data, consumer only
+	 */
+	void clear();
+
+private:
+
+	/**
+	 * @brief m_Data The storage
+	 */
+	QVector<char> m_Data;
+
+	/**
+	 * @brief m_iMask Maps a position to an index into m_Data
+	 */
+	qint64 m_iMask;
+
+	/**
+	 * @brief m_uWritePosition The number of bytes written so far, only modified by the producer
+	 */
+	std::atomic<quint64> m_uWritePosition;
+
+	/**
+	 * @brief m_uReadPosition The number of bytes read so far, only modified by the consumer
+	 */
+	std::atomic<quint64> m_uReadPosition;
+};
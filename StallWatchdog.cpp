@@ -0,0 +1,561 @@
+#include "StallWatchdog.h"
+#include "Tracer.h"
+
+#include <QAbstractEventDispatcher>
+#include <QElapsedTimer>
+#include <QMetaEnum>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+
+#if defined(Q_OS_UNIX)
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#else
+#include <QSemaphore>
+#endif
+
+namespace
+{
+
+//how many stalls are kept for the report
+const int ciRecentStalls = 32;
+
+//the deepest nesting of TRACE_SCOPE regions named in a stall, deeper regions are left out
+const int ciMaxDepth = 16;
+
+//set in the start of an event delivery once the watchdog reported it as a stall
+const qint64 ciStalledFlag = Q_INT64_C(1) << 62;
+
+//written to the wakeup pipe when the watchdog thread has to look at the gui thread again
+const char ccWake = 'w';
+
+//written to the wakeup pipe by the signal handler to request a report
+const char ccDump = 'd';
+
+/**
+ * @brief The Delivery struct describes an event delivery on the gui thread
+ */
+struct Delivery
+{
+	//! The class name of the receiver
+	const char* m_pReceiver;
+
+	//! The event type
+	int m_iType;
+
+	//! True if the delivery is timed, false if it counts to the delivery it was sent from
+	bool m_bTimed;
+
+	//! True once the delivery runs an event loop of its own, e.g. of a modal dialog
+	bool m_bNestedLoop;
+};
+
+//the event deliveries on this thread are watched
+thread_local bool t_bWatched = false;
+
+//the running event deliveries on this thread, the outermost first
+thread_local QVector<Delivery> t_Deliveries;
+
+/**
+ * @brief The WatchdogThread class checks the event deliveries of the gui thread
+ */
+class WatchdogThread : public QThread
+{
+protected:
+
+	void run() override;
+};
+
+/**
+ * @brief The WatchdogState struct holds what the gui thread and the watchdog thread share
+ *
+ * The gui thread only writes the atomics, so it never waits for the watchdog thread. The mutex guards the stalls.
+ */
+struct WatchdogState
+{
+	QMutex m_Mutex;
+	QElapsedTimer m_Clock;
+	qint64 m_iThreshold;
+	std::atomic<bool> m_bStopped;
+	std::atomic<qint64> m_iBusySince;
+	std::atomic<bool> m_bSleeping;
+	std::atomic<const char*> m_pReceiver;
+	std::atomic<int> m_iEventType;
+	std::atomic<int> m_iDepth;
+	std::atomic<const char*> m_Names[ciMaxDepth];
+	StallWatchdog::Stall m_Pending;
+	QVector<StallWatchdog::Stall> m_Stalls;
+	int m_iNextStall;
+	quint64 m_uCount;
+	WatchdogThread* m_pThread;
+	QMetaObject::Connection m_Awake;
+	QMetaObject::Connection m_AboutToBlock;
+#if defined(Q_OS_UNIX)
+	int m_Pipe[2];
+#else
+	QSemaphore m_Wakeup;
+#endif
+};
+
+WatchdogState& State()
+{
+	static WatchdogState state;
+	return state;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Wake Wake the watchdog thread up
+ * @param reason ccWake or ccDump
+ *
+ * @note Async signal safe on Unix
+ */
+void Wake(char reason)
+{
+	auto &state = State();
+
+#if defined(Q_OS_UNIX)
+	//a full pipe already holds a wakeup
+	const auto written = write(state.m_Pipe[1], &reason, 1);
+	Q_UNUSED(written);
+#else
+	Q_UNUSED(reason);
+	state.m_Wakeup.release();
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Wait Sleep on the watchdog thread until woken up or a timeout
+ * @param timeout The timeout in milliseconds, negative to wait until woken up
+ * @return True if a report was requested meanwhile
+ */
+bool Wait(int timeout)
+{
+	auto &state = State();
+
+#if defined(Q_OS_UNIX)
+	pollfd fd{state.m_Pipe[0], POLLIN, 0};
+	if(0 >= poll(&fd, 1, timeout)) return false;
+
+	auto dump = false;
+	char buffer[16];
+	for(ssize_t n = 0; 0 < (n = read(state.m_Pipe[0], buffer, sizeof(buffer)));)
+	{
+		for(auto i = 0; i < n; ++i) dump |= (ccDump == buffer[i]);
+	}
+
+	return dump;
+#else
+	state.m_Wakeup.tryAcquire(1, timeout);
+	return false;
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+#if defined(Q_OS_UNIX)
+/**
+ * @brief OnDumpSignal Request a report from the watchdog thread
+ */
+void OnDumpSignal(int)
+{
+	Wake(ccDump);
+}
+//----------------------------------------------------------------------------------------------------------------------
+#endif
+
+/**
+ * @brief CurrentScope Describe the TRACE_SCOPE regions running on the gui thread
+ * @return The region names, the outermost first, separated by " > "
+ */
+QString CurrentScope()
+{
+	auto &state = State();
+
+	QStringList names;
+	const auto depth = qMin(state.m_iDepth.load(), ciMaxDepth);
+	for(auto i = 0; i < depth; ++i)
+	{
+		//the region may have ended meanwhile, then its slot is cleared or already reused
+		const auto name = state.m_Names[i].load();
+		if(nullptr != name) names << QString::fromLatin1(name);
+	}
+
+	return names.join(QStringLiteral(" > "));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief CurrentEvent Describe the event being delivered on the gui thread
+ * @return E.g. "MetaCall to LogoDownloader"
+ */
+QString CurrentEvent()
+{
+	auto &state = State();
+
+	const auto type = state.m_iEventType.load();
+	const auto key = QMetaEnum::fromType<QEvent::Type>().valueToKey(type);
+	const auto receiver = state.m_pReceiver.load();
+
+	return QString("%1 to %2").arg((nullptr != key) ? QString::fromLatin1(key) : QString::number(type),
+																 (nullptr != receiver) ? QString::fromLatin1(receiver) : QString("?"));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Line Describe a stall for the report
+ * @param kind "stall" or "stalling"
+ * @param stall The stall
+ * @return The report line
+ */
+QString Line(const QString &kind, const StallWatchdog::Stall &stall)
+{
+	return QString("%1 %2\t%3 ms\t%4\t%5").arg(kind, stall.m_dtStart.toString(Qt::ISODateWithMs),
+																						 QString::number(stall.m_iDuration), stall.m_strScope, stall.m_strEvent);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Capture Note what the gui thread is busy with, on the watchdog thread
+ * @param since When the stalled event delivery started
+ * @param busy For how long the delivery is running yet, in milliseconds
+ */
+void Capture(qint64 since, qint64 busy)
+{
+	auto &state = State();
+
+	StallWatchdog::Stall stall;
+	stall.m_dtStart = QDateTime::currentDateTime().addMSecs(-busy);
+	stall.m_iDuration = busy;
+	stall.m_strScope = CurrentScope();
+	stall.m_strEvent = CurrentEvent();
+
+	QMutexLocker lock(&state.m_Mutex);
+	state.m_Pending = stall;
+
+	//nothing is recorded if the delivery ended meanwhile
+	state.m_iBusySince.compare_exchange_strong(since, since | ciStalledFlag);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Finish Record a stall once its event delivery ended, on the gui thread
+ * @param start When the delivery started
+ * @param end When the delivery ended
+ */
+void Finish(qint64 start, qint64 end)
+{
+	auto &state = State();
+
+	QMutexLocker lock(&state.m_Mutex);
+
+	auto stall = state.m_Pending;
+	stall.m_iDuration = end - start;
+
+	if(ciRecentStalls > state.m_Stalls.size()) state.m_Stalls.append(stall);
+	else state.m_Stalls[state.m_iNextStall] = stall;
+
+	state.m_iNextStall = (state.m_iNextStall + 1) % ciRecentStalls;
+	++state.m_uCount;
+
+	lock.unlock();
+
+	Tracer::instant("stall", "watchdog", Line(QString("stall"), stall));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Start Time an event delivery, on the gui thread
+ * @param delivery The delivery
+ * @param now The start of the delivery
+ */
+void Start(const Delivery &delivery, qint64 now)
+{
+	auto &state = State();
+
+	state.m_pReceiver.store(delivery.m_pReceiver, std::memory_order_relaxed);
+	state.m_iEventType.store(delivery.m_iType, std::memory_order_relaxed);
+	state.m_iBusySince.store(now);
+
+	//the watchdog thread went to sleep after the previous delivery, it checks the start after announcing that
+	if((true == state.m_bSleeping.load()) && (true == state.m_bSleeping.exchange(false))) Wake(ccWake);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Stop Stop timing the current event delivery and record it if it stalled, on the gui thread
+ * @param now The end of the delivery
+ */
+void Stop(qint64 now)
+{
+	const auto since = State().m_iBusySince.exchange(-1);
+	if((0 <= since) && (0 != (since & ciStalledFlag))) Finish(since & ~ciStalledFlag, now);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief OnAwake Note that the delivery running right now runs an event loop, on the gui thread
+ */
+void OnAwake()
+{
+	if(false == t_Deliveries.isEmpty()) t_Deliveries.last().m_bNestedLoop = true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief OnAboutToBlock Stop timing while a nested event loop waits for events, on the gui thread
+ */
+void OnAboutToBlock()
+{
+	if(true == t_Deliveries.isEmpty()) return;
+
+	t_Deliveries.last().m_bNestedLoop = true;
+	Stop(State().m_Clock.elapsed());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void WatchdogThread::run()
+{
+	auto &state = State();
+
+	while(false == state.m_bStopped.load())
+	{
+		const auto since = state.m_iBusySince.load();
+		auto timeout = static_cast<int>(state.m_iThreshold);
+
+		if(0 > since)
+		{
+			//between two deliveries nothing can stall, the next one wakes this thread up
+			state.m_bSleeping.store(true);
+			if((0 <= state.m_iBusySince.load()) && (true == state.m_bSleeping.exchange(false))) continue;
+
+			timeout = -1;
+		}
+		else if(0 == (since & ciStalledFlag))
+		{
+			const auto busy = state.m_Clock.elapsed() - since;
+			if(busy < state.m_iThreshold) timeout = static_cast<int>(state.m_iThreshold - busy);
+			else Capture(since, busy);
+		}
+
+		if(true == Wait(timeout)) QTextStream(stderr) << StallWatchdog::report().join(QLatin1Char('\n')) << endl;
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+std::atomic<bool> StallWatchdog::s_bEnabled(false);
+
+bool StallWatchdog::start(int threshold)
+{
+	if((0 >= threshold) || (true == isEnabled())) return false;
+
+	auto &state = State();
+
+#if defined(Q_OS_UNIX)
+	if(0 != pipe(state.m_Pipe)) return false;
+
+	for(auto fd : state.m_Pipe) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#endif
+
+	{
+		QMutexLocker lock(&state.m_Mutex);
+		state.m_Stalls.clear();
+		state.m_Stalls.reserve(ciRecentStalls);
+		state.m_iNextStall = 0;
+		state.m_uCount = 0;
+	}
+
+	state.m_Clock.start();
+	state.m_iThreshold = threshold;
+	state.m_bStopped.store(false);
+	state.m_iBusySince.store(-1);
+	state.m_bSleeping.store(false);
+	state.m_pReceiver.store(nullptr);
+	state.m_iEventType.store(QEvent::None);
+	state.m_iDepth.store(0);
+
+	t_bWatched = true;
+	t_Deliveries.clear();
+
+	//a nested event loop must not count as a single delivery, see OnAboutToBlock()
+	const auto dispatcher = QAbstractEventDispatcher::instance();
+	if(nullptr != dispatcher)
+	{
+		state.m_Awake = QObject::connect(dispatcher, &QAbstractEventDispatcher::awake, &OnAwake);
+		state.m_AboutToBlock = QObject::connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, &OnAboutToBlock);
+	}
+
+	state.m_pThread = new WatchdogThread();
+	state.m_pThread->start(QThread::HighPriority);
+
+#if defined(Q_OS_UNIX)
+	struct sigaction action = {};
+	action.sa_handler = OnDumpSignal;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGUSR1, &action, nullptr);
+#endif
+
+	s_bEnabled.store(true);
+
+	//the regions of the gui thread name the place a stall happened in
+	Tracer::setScopeHooks(&StallWatchdog::enter, &StallWatchdog::leave);
+
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StallWatchdog::stop()
+{
+	if(false == s_bEnabled.exchange(false)) return;
+
+	Tracer::setScopeHooks(nullptr, nullptr);
+
+	auto &state = State();
+
+	QObject::disconnect(state.m_Awake);
+	QObject::disconnect(state.m_AboutToBlock);
+
+#if defined(Q_OS_UNIX)
+	signal(SIGUSR1, SIG_DFL);
+#endif
+
+	state.m_bStopped.store(true);
+	Wake(ccWake);
+
+	state.m_pThread->wait();
+	delete state.m_pThread;
+	state.m_pThread = nullptr;
+
+#if defined(Q_OS_UNIX)
+	close(state.m_Pipe[0]);
+	close(state.m_Pipe[1]);
+#endif
+
+	t_bWatched = false;
+	t_Deliveries.clear();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QList<StallWatchdog::Stall> StallWatchdog::stalls()
+{
+	auto &state = State();
+
+	QMutexLocker lock(&state.m_Mutex);
+
+	//once the ring is full the oldest stall is the one overwritten next
+	QList<Stall> stalls;
+	const auto first = (ciRecentStalls > state.m_Stalls.size()) ? 0 : state.m_iNextStall;
+	for(auto i = 0; i < state.m_Stalls.size(); ++i) stalls << state.m_Stalls.at((first + i) % state.m_Stalls.size());
+
+	return stalls;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 StallWatchdog::count()
+{
+	auto &state = State();
+
+	QMutexLocker lock(&state.m_Mutex);
+	return state.m_uCount;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QStringList StallWatchdog::report()
+{
+	QStringList lines;
+	for(const auto &stall : stalls()) lines << Line(QString("stall"), stall);
+
+	if(false == isEnabled()) return lines;
+
+	auto &state = State();
+
+	const auto since = state.m_iBusySince.load();
+	if((0 <= since) && (0 != (since & ciStalledFlag)))
+	{
+		QMutexLocker lock(&state.m_Mutex);
+
+		auto stall = state.m_Pending;
+		stall.m_iDuration = state.m_Clock.elapsed() - (since & ~ciStalledFlag);
+		lines << Line(QString("stalling"), stall);
+	}
+
+	return lines;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StallWatchdog::leave()
+{
+	auto &state = State();
+
+	const auto depth = state.m_iDepth.load(std::memory_order_relaxed) - 1;
+	if(0 > depth) return;
+
+	if(ciMaxDepth > depth) state.m_Names[depth].store(nullptr, std::memory_order_relaxed);
+	state.m_iDepth.store(depth, std::memory_order_release);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StallWatchdog::endEvent()
+{
+	if(true == t_Deliveries.isEmpty()) return;
+
+	const auto delivery = t_Deliveries.takeLast();
+	if(false == delivery.m_bTimed) return;
+
+	const auto now = State().m_Clock.elapsed();
+	Stop(now);
+
+	//the delivery running the nested event loop goes on, it is timed again from now on
+	if(false == t_Deliveries.isEmpty())
+	{
+		t_Deliveries.last().m_bTimed = true;
+		Start(t_Deliveries.last(), now);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StallWatchdog::begin(QObject* receiver, QEvent* event)
+{
+	if(false == t_bWatched) return false;
+
+	Delivery delivery{receiver->metaObject()->className(), event->type(), false, false};
+
+	//events sent from within a delivery count to it, the deliveries of a nested event loop are timed on their own
+	if((true == t_Deliveries.isEmpty()) || (true == t_Deliveries.last().m_bNestedLoop))
+	{
+		const auto now = State().m_Clock.elapsed();
+		Stop(now);
+		Start(delivery, now);
+
+		delivery.m_bTimed = true;
+	}
+
+	t_Deliveries.append(delivery);
+
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StallWatchdog::push(const char* name, const char* category)
+{
+	Q_UNUSED(category);
+
+	if(false == t_bWatched) return false;
+
+	auto &state = State();
+
+	const auto depth = state.m_iDepth.load(std::memory_order_relaxed);
+	if(ciMaxDepth > depth) state.m_Names[depth].store(name, std::memory_order_relaxed);
+	state.m_iDepth.store(depth + 1, std::memory_order_release);
+
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
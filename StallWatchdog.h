@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+
+#include <QDateTime>
+#include <QEvent>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief The StallWatchdog class detects when the gui thread does not get back to its event loop
+ *
+ * The application reports the start and the end of each event it delivers on the gui thread, see WatchedApplication,
+ * and a watchdog thread checks that no delivery takes longer than the threshold. Each event handler, timer and slot
+ * called through a queued connection runs within such a delivery. A stall is attributed to the event being delivered
+ * and to the TRACE_SCOPE regions running on the gui thread when the watchdog noticed it. The most recent stalls are
+ * kept and written to stderr on SIGUSR1, the control socket and the settings page show them as well.
+ *
+ * The watchdog thread sleeps while no event is delivered and wakes up at most twice per threshold otherwise. The gui
+ * thread pays a clock read per event and a few relaxed atomic stores per TRACE_SCOPE.
+ *
+ * A delivery running a nested event loop, e.g. of a modal dialog or QEventLoop::exec(), is not timed while the loop
+ * waits for events, and each delivery of the nested loop is timed on its own.
+ *
+ * @note Code running outside of an event delivery, e.g. the construction of the gui in main(), is not watched. All
+ * functions are thread safe, start() and stop() have to be called on the gui thread.
+ */
+class StallWatchdog
+{
+public:
+
+	/**
+	 * @brief The Stall struct describes a single stall
+	 */
+	struct Stall
+	{
+		//! When the stalled event delivery started
+		QDateTime m_dtStart;
+
+		//! How long the delivery took in milliseconds
+		qint64 m_iDuration = 0;
+
+		//! The TRACE_SCOPE regions running when the stall was noticed, the outermost first, separated by " > "
+		QString m_strScope;
+
+		//! The event being delivered, e.g. "MetaCall to LogoDownloader"
+		QString m_strEvent;
+	};
+
+	/**
+	 * @brief start Watch the event deliveries on the calling thread
+	 * @param threshold The longest event delivery not considered a stall, in milliseconds
+	 * @return False if the watchdog is already running or the threshold is not positive
+	 */
+	static bool start(int threshold);
+
+	/**
+	 * @brief stop Stop watching, the recorded stalls are kept
+	 */
+	static void stop();
+
+	/**
+	 * @brief isEnabled Check if the event loop is watched
+	 * @return True while watching
+	 */
+	static bool isEnabled()
+	{
+		return s_bEnabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief stalls The most recent stalls
+	 * @return The stalls, the oldest first
+	 */
+	static QList<Stall> stalls();
+
+	/**
+	 * @brief count The number of stalls since the watchdog was started
+	 * @return The number of stalls, including the ones no longer kept
+	 */
+	static quint64 count();
+
+	/**
+	 * @brief report Describe the most recent stalls and a stall still running
+	 * @return One "stall <start>\t<duration> ms\t<scope>\t<event>" line per stall, the oldest first, followed by a
+	 * "stalling" line of the same form if the gui thread is stalled right now
+	 */
+	static QStringList report();
+
+	/**
+	 * @brief enter Mark the start of a TRACE_SCOPE region, installed as a scope hook of the Tracer while watching
+	 * @param name The region name, must be a string literal
+	 * @param category The category, must be a string literal
+	 * @return True if the region was marked and leave() has to be called at its end
+	 */
+	static bool enter(const char* name, const char* category)
+	{
+		return (true == isEnabled()) && (true == push(name, category));
+	}
+
+	/**
+	 * @brief leave Mark the end of the region marked last by enter()
+	 */
+	static void leave();
+
+	/**
+	 * @brief beginEvent Mark the start of an event delivery, see WatchedApplication
+	 * @param receiver The receiver of the event
+	 * @param event The event
+	 * @return True if the delivery was marked and endEvent() has to be called at its end
+	 */
+	static bool beginEvent(QObject* receiver, QEvent* event)
+	{
+		return (true == isEnabled()) && (true == begin(receiver, event));
+	}
+
+	/**
+	 * @brief endEvent Mark the end of the event delivery marked last by beginEvent()
+	 */
+	static void endEvent();
+
+private:
+
+	/**
+	 * @brief begin Note the start of an event delivery if called on the watched thread
+	 * @param receiver The receiver of the event
+	 * @param event The event
+	 * @return True if the delivery was noted
+	 */
+	static bool begin(QObject* receiver, QEvent* event);
+
+	/**
+	 * @brief push Put a region on the scope stack if called on the watched thread
+	 * @param name The region name
+	 * @param category The category
+	 * @return True if the region was put on the stack
+	 */
+	static bool push(const char* name, const char* category);
+
+	/**
+	 * @brief s_bEnabled True while watching
+	 */
+	static std::atomic<bool> s_bEnabled;
+};
+
+/**
+ * @brief The WatchedApplication class reports the event deliveries of an application to the StallWatchdog
+ *
+ * @note Use it in place of QApplication or QCoreApplication
+ */
+template<typename T>
+class WatchedApplication : public T
+{
+public:
+
+	/**
+	 * @brief WatchedApplication Default constructor
+	 * @param argc The number of command line arguments
+	 * @param argv The command line arguments
+	 */
+	WatchedApplication(int &argc, char** argv)
+		: T(argc, argv)
+	{
+	}
+
+	bool notify(QObject* receiver, QEvent* event) override
+	{
+		const auto watched = StallWatchdog::beginEvent(receiver, event);
+		const auto result = T::notify(receiver, event);
+		if(true == watched) StallWatchdog::endEvent();
+
+		return result;
+	}
+};
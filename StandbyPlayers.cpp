@@ -0,0 +1,154 @@
+#include "StandbyPlayers.h"
+
+#include <algorithm>
+
+#include "StreamReader.h"
+
+namespace
+{
+
+//the estimated memory used by a single running player for network and decoder buffers, in bytes
+const qint64 ciEstimatedPlayerMemory = 4 * 1024 * 1024;
+
+}
+
+StandbyPlayers::StandbyPlayers()
+	: QObject(nullptr)
+	, m_iCapacity(0)
+	, m_iStreamBuffer(0)
+	, m_Players()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StandbyPlayers::Player StandbyPlayers::createPlayer()
+{
+	return Player(new QMediaPlayer(), [](QMediaPlayer* p) { p->deleteLater(); });
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StandbyPlayers::setCapacity(int count, qint64 memoryBudget)
+{
+	m_iCapacity = qMax(0, count);
+
+	if(0 < memoryBudget)
+	{
+		m_iCapacity = qMin(m_iCapacity, static_cast<int>(memoryBudget / ciEstimatedPlayerMemory));
+	}
+
+	trim();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StandbyPlayers::setStreamBuffer(int milliseconds)
+{
+	m_iStreamBuffer = qMax(0, milliseconds);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int StandbyPlayers::capacity() const
+{
+	return m_iCapacity;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StandbyPlayers::prepare(const QStringList &urls)
+{
+	QStringList wanted;
+	for(const auto &url : urls)
+	{
+		if(wanted.size() >= m_iCapacity) break;
+		if((false == url.isEmpty()) && (false == wanted.contains(url))) wanted.append(url);
+	}
+
+	//players for stations which are no longer likely are stopped and reused
+	for(auto &standby : m_Players)
+	{
+		if((false == standby.m_strUrl.isEmpty()) && (false == wanted.contains(standby.m_strUrl)))
+		{
+			standby.m_Player->stop();
+			StreamReader::attach(standby.m_Player.get(), QString(), m_iStreamBuffer);
+			standby.m_strUrl.clear();
+		}
+	}
+
+	for(const auto &url : wanted)
+	{
+		auto it = std::find_if(m_Players.begin(), m_Players.end(), [&](const Standby &s) { return url == s.m_strUrl; });
+		if(m_Players.end() != it) continue;
+
+		it = std::find_if(m_Players.begin(), m_Players.end(), [](const Standby &s) { return s.m_strUrl.isEmpty(); });
+		if(m_Players.end() == it)
+		{
+			m_Players.append(Standby{QString(), createPlayer()});
+			it = m_Players.end() - 1;
+		}
+
+		it->m_strUrl = url;
+		it->m_Player->setMuted(true);
+		StreamReader::attach(it->m_Player.get(), url, m_iStreamBuffer);
+		it->m_Player->play();
+	}
+
+	trim();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StandbyPlayers::Player StandbyPlayers::take(const QString &url)
+{
+	for(auto it = m_Players.begin(); it != m_Players.end(); ++it)
+	{
+		if(url != it->m_strUrl) continue;
+
+		//a player which failed is of no use, the caller has to start from scratch
+		if((QMediaPlayer::PlayingState != it->m_Player->state()) || (QMediaPlayer::NoError != it->m_Player->error()))
+		{
+			return Player();
+		}
+
+		auto player = it->m_Player;
+		m_Players.erase(it);
+
+		return player;
+	}
+
+	return Player();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StandbyPlayers::adopt(const Player &player, const QString &url)
+{
+	if(nullptr == player) return;
+
+	//a stopped player has no connection worth keeping
+	if((0 == m_iCapacity) || (QMediaPlayer::PlayingState != player->state()))
+	{
+		player->stop();
+		return;
+	}
+
+	player->setMuted(true);
+
+	//the adopted player is the most likely one, the next call to prepare() sorts out the rest
+	m_Players.prepend(Standby{url, player});
+
+	trim();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StandbyPlayers::trim()
+{
+	//idle players go first
+	for(auto it = m_Players.begin(); (it != m_Players.end()) && (m_Players.size() > m_iCapacity);)
+	{
+		if(true == it->m_strUrl.isEmpty()) it = m_Players.erase(it);
+		else ++it;
+	}
+
+	while(m_Players.size() > m_iCapacity)
+	{
+		m_Players.last().m_Player->stop();
+		m_Players.removeLast();
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
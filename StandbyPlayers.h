@@ -0,0 +1,115 @@
+#pragma once
+
+#include <memory>
+
+#include <QObject>
+
+#include <QList>
+#include <QMediaPlayer>
+#include <QStringList>
+
+/**
+ * @brief The StandbyPlayers class keeps a pool of muted players connected to the stations most likely played next
+ *
+ * Switching to a station with a standby player only needs to unmute the player, connecting and buffering was already
+ * done in the background.
+ *
+ * @note Each standby player keeps its stream running, so the pool costs bandwidth and decoder time. It is disabled
+ * unless a capacity is set.
+ */
+class StandbyPlayers : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	typedef std::shared_ptr<QMediaPlayer> Player;
+
+	/**
+	 * @brief StandbyPlayers Default constructor, the pool is empty and disabled
+	 */
+	explicit StandbyPlayers();
+
+	/**
+	 * @brief createPlayer Create a player which is deleted on the event loop when the last reference is gone
+	 * @return The new player
+	 */
+	static Player createPlayer();
+
+	/**
+	 * @brief setCapacity Set the number of standby players
+	 * @param count The maximum number of standby players, 0 disables the pool
+	 * @param memoryBudget The memory the pool may use in bytes, 0 for no limit
+	 *
+	 * @note The backends do not report their buffer sizes, the budget is applied using an estimate per player
+	 */
+	void setCapacity(int count, qint64 memoryBudget = 0);
+
+	/**
+	 * @brief setStreamBuffer Connect the players through a jitter buffer, see StreamReader
+	 * @param milliseconds The amount of audio to buffer, 0 to let the players connect themselves
+	 *
+	 * @note Applies to the players connected from now on
+	 */
+	void setStreamBuffer(int milliseconds);
+
+	/**
+	 * @brief capacity The number of standby players
+	 * @return The effective capacity after applying the memory budget
+	 */
+	int capacity() const;
+
+	/**
+	 * @brief prepare Connect standby players to the given stations, players for other stations are stopped
+	 * @param urls The media urls, the most likely one first. Only the first capacity() urls are used.
+	 */
+	void prepare(const QStringList &urls);
+
+	/**
+	 * @brief take Remove the standby player for a station from the pool
+	 * @param url The media url
+	 * @return The player, still muted, or null if no running player is available for the url
+	 */
+	Player take(const QString &url);
+
+	/**
+	 * @brief adopt Keep a player which is no longer needed running muted in the pool, e.g. the previous station
+	 * @param player The player
+	 * @param url The media url the player is connected to
+	 */
+	void adopt(const Player &player, const QString &url);
+
+private:
+
+	/**
+	 * @brief The Standby struct describes a single standby player
+	 */
+	struct Standby
+	{
+		//! The media url the player is connected to, empty if idle
+		QString m_strUrl;
+
+		//! The player
+		Player m_Player;
+	};
+
+	/**
+	 * @brief trim Drop players until the pool fits its capacity, idle players are dropped first
+	 */
+	void trim();
+
+	/**
+	 * @brief m_iCapacity The maximum number of standby players
+	 */
+	int m_iCapacity;
+
+	/**
+	 * @brief m_iStreamBuffer The jitter buffer of the players in milliseconds, 0 if the players connect themselves
+	 */
+	int m_iStreamBuffer;
+
+	/**
+	 * @brief m_Players All standby players
+	 */
+	QList<Standby> m_Players;
+};
@@ -0,0 +1,434 @@
+#include "StationCatalog.h"
+
+#include <cstring>
+#include <limits>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include "Tracer.h"
+
+namespace
+{
+
+//identifies a catalog file
+const QByteArray cbaMagic = QByteArrayLiteral("RADIOCAT");
+
+//incremented whenever the layout changes, catalogs of other versions are ignored
+const quint32 ciVersion = 3;
+
+//the header size in bytes, the sections follow in the order index, strings and logos
+const qint64 ciHeaderSize = 64;
+
+//the offsets of the header fields in bytes
+const qint64 ciVersionOffset = 8;
+const qint64 ciCountOffset = 12;
+const qint64 ciIndexOffset = 16;
+const qint64 ciStringsOffset = 20;
+const qint64 ciStringsSizeOffset = 24;
+const qint64 ciLogosOffset = 28;
+const qint64 ciLogosSizeOffset = 32;
+const qint64 ciHashOffset = 36;
+
+//the size of the source hash in bytes
+const int ciHashSize = 20;
+
+//the number of 32 bit words of an index record
+const int ciRecordWords = 27;
+
+//the index of the first word of each field in an index record, strings take two words: offset and length
+const int ciNameWord = 0;
+const int ciMediaUrlWord = 2;
+const int ciGenreWord = 4;
+const int ciFirstMetadataKeyWord = 6;
+const int ciSecondMetadataKeyWord = 8;
+const int ciLogoUrlWord = 10;
+const int ciLogoFileWord = 12;
+const int ciColorNormalWord = 14;
+const int ciColorCheckedWord = 15;
+const int ciLogoOffsetWord = 16;
+const int ciLogoWidthWord = 17;
+const int ciLogoHeightWord = 18;
+const int ciLogoBytesPerLineWord = 19;
+const int ciMirrorUrlsWord = 20;
+const int ciLogoSourceWord = 22;
+
+//sections start at this alignment, so strings and pixels can be read in place
+const int ciAlignment = 16;
+
+/**
+ * @brief Align Pad a buffer to the section alignment
+ * @param data The buffer
+ */
+void Align(QByteArray &data)
+{
+	while(0 != (data.size() % ciAlignment)) data.append('\0');
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief AppendWord Append a little endian integer
+ * @param data The buffer
+ * @param value The value
+ */
+void AppendWord(QByteArray &data, quint32 value)
+{
+	uchar word[sizeof(quint32)];
+	qToLittleEndian(value, word);
+	data.append(reinterpret_cast<const char*>(word), sizeof(word));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief SetWord Overwrite a little endian integer
+ * @param data The buffer
+ * @param offset The offset in bytes
+ * @param value The value
+ */
+void SetWord(QByteArray &data, qint64 offset, quint32 value)
+{
+	qToLittleEndian(value, reinterpret_cast<uchar*>(data.data() + offset));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief LoadLogo Decode the logo of a station
+ * @param station The station
+ * @param loaded Receives false if the logo source could not be read, so the station must keep it
+ * @return The logo, null if there is none
+ */
+QImage LoadLogo(const StationInformation &station, bool &loaded)
+{
+	loaded = true;
+
+	//like at runtime, an embedded logo which cannot be decoded leaves the station without a logo
+	if(false == station.m_baLogoData.isEmpty()) return QImage::fromData(QByteArray::fromBase64(station.m_baLogoData));
+
+	if(false == station.m_strLogoFile.isEmpty())
+	{
+		const QImage logo(station.m_strLogoFile);
+		loaded = (false == logo.isNull());
+		return logo;
+	}
+
+	//downloads happen at runtime only
+	loaded = (false == station.m_uLogoUrl.isValid());
+	return QImage();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+StationCatalog::StationCatalog()
+	: m_File()
+	, m_pData(nullptr)
+	, m_iSize(0)
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StationCatalog::write(const QString &file, const QList<StationInformation> &stations, const QByteArray &sourceHash,
+													 const QSize &logoSize, QString* error)
+{
+	QByteArray index;
+	QByteArray strings;
+	QByteArray logos;
+	QHash<QString, quint32> stringOffsets;
+
+	const auto appendString = [&](const QString &s)
+	{
+		//repeated strings, e.g. the metadata keys, are stored once
+		if(false == stringOffsets.contains(s))
+		{
+			stringOffsets.insert(s, static_cast<quint32>(strings.size()));
+			for(const auto &c : s)
+			{
+				uchar unit[sizeof(quint16)];
+				qToLittleEndian<quint16>(c.unicode(), unit);
+				strings.append(reinterpret_cast<const char*>(unit), sizeof(unit));
+			}
+		}
+
+		AppendWord(index, stringOffsets.value(s));
+		AppendWord(index, static_cast<quint32>(s.size()));
+	};
+
+	for(const auto &station : stations)
+	{
+		bool loaded = true;
+		auto logo = LoadLogo(station, loaded);
+
+		if((false == logo.isNull()) && (false == logoSize.isEmpty()) &&
+			 ((logo.width() > logoSize.width()) || (logo.height() > logoSize.height())))
+		{
+			logo = logo.scaled(logoSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+		}
+
+		logo = logo.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+		appendString(station.m_strDefaultPublisher);
+		appendString(station.m_strMediaUrl);
+		appendString(station.m_strGenre);
+		appendString(station.m_strFirstMetadataKey);
+		appendString(station.m_strSecondMetadataKey);
+		appendString((false == loaded) ? station.m_uLogoUrl.toString() : QString());
+		appendString((false == loaded) ? station.m_strLogoFile : QString());
+		AppendWord(index, station.m_cBackgroundColorNormal.rgba());
+		AppendWord(index, station.m_cBackgroundColorChecked.rgba());
+
+		if(true == logo.isNull())
+		{
+			for(auto i = 0; i < 4; ++i) AppendWord(index, 0);
+			appendString(station.m_MirrorUrls.join(QLatin1Char('\n')));
+			index.append(station.m_baLogoSource.left(ciHashSize).leftJustified(ciHashSize, '\0'));
+			continue;
+		}
+
+		AppendWord(index, static_cast<quint32>(logos.size()));
+		AppendWord(index, static_cast<quint32>(logo.width()));
+		AppendWord(index, static_cast<quint32>(logo.height()));
+		AppendWord(index, static_cast<quint32>(logo.bytesPerLine()));
+
+		//urls cannot contain line breaks, so the mirrors are stored as a single string
+		appendString(station.m_MirrorUrls.join(QLatin1Char('\n')));
+
+		//the logo source is kept even though the logo is stored, so reloading the json file can tell whether it changed
+		index.append(station.m_baLogoSource.left(ciHashSize).leftJustified(ciHashSize, '\0'));
+
+		//ARGB32 pixels are 32 bit words in host order, the catalog is little endian
+		for(auto y = 0; y < logo.height(); ++y)
+		{
+			const auto line = reinterpret_cast<const quint32*>(logo.constScanLine(y));
+			for(auto x = 0; x < logo.bytesPerLine() / 4; ++x) AppendWord(logos, line[x]);
+		}
+	}
+
+	QByteArray header(ciHeaderSize, '\0');
+	header.replace(0, cbaMagic.size(), cbaMagic);
+	header.replace(ciHashOffset, ciHashSize, sourceHash.left(ciHashSize).leftJustified(ciHashSize, '\0'));
+
+	const auto indexOffset = header.size();
+	Align(index);
+	const auto stringsOffset = indexOffset + index.size();
+	const auto stringsSize = strings.size();
+	Align(strings);
+	const auto logosOffset = stringsOffset + strings.size();
+
+	SetWord(header, ciVersionOffset, ciVersion);
+	SetWord(header, ciCountOffset, static_cast<quint32>(stations.size()));
+	SetWord(header, ciIndexOffset, static_cast<quint32>(indexOffset));
+	SetWord(header, ciStringsOffset, static_cast<quint32>(stringsOffset));
+	SetWord(header, ciStringsSizeOffset, static_cast<quint32>(stringsSize));
+	SetWord(header, ciLogosOffset, static_cast<quint32>(logosOffset));
+	SetWord(header, ciLogosSizeOffset, static_cast<quint32>(logos.size()));
+
+	//a running radio may still map the previous catalog, it is replaced and not overwritten
+	QSaveFile f(file);
+	if((false == f.open(QIODevice::WriteOnly)) || (header.size() != f.write(header)) ||
+		 (index.size() != f.write(index)) || (strings.size() != f.write(strings)) || (logos.size() != f.write(logos)) ||
+		 (false == f.commit()))
+	{
+		if(nullptr != error) *error = f.errorString();
+		return false;
+	}
+
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QByteArray StationCatalog::hash(const QString &file)
+{
+	QFile f(file);
+	if(false == f.open(QIODevice::ReadOnly)) return QByteArray();
+
+	QCryptographicHash h(QCryptographicHash::Sha1);
+	if(false == h.addData(&f)) return QByteArray();
+
+	return h.result();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StationCatalog::open(const QString &file)
+{
+	TRACE_SCOPE("openCatalog", "catalog");
+
+	close();
+
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+	//strings and pixels are read in place, which needs the byte order of the catalog
+	Q_UNUSED(file)
+	return false;
+#else
+	m_File.setFileName(file);
+	if(false == m_File.open(QIODevice::ReadOnly)) return false;
+
+	m_iSize = m_File.size();
+	if(ciHeaderSize <= m_iSize) m_pData = m_File.map(0, m_iSize);
+
+	const auto valid = [&]()
+	{
+		if(nullptr == m_pData) return false;
+		if(0 != std::memcmp(m_pData, cbaMagic.constData(), cbaMagic.size())) return false;
+		if(ciVersion != word(ciVersionOffset)) return false;
+
+		const qint64 count = word(ciCountOffset);
+		const qint64 indexOffset = word(ciIndexOffset);
+		const qint64 stringsOffset = word(ciStringsOffset);
+		const qint64 logosOffset = word(ciLogosOffset);
+
+		//the sections must be aligned, so nothing is read across their boundaries
+		if((0 != (indexOffset % 4)) || (0 != (stringsOffset % 4)) || (0 != (logosOffset % 4))) return false;
+
+		return (indexOffset + count * ciRecordWords * 4 <= m_iSize) &&
+					 (stringsOffset + word(ciStringsSizeOffset) <= m_iSize) &&
+					 (logosOffset + word(ciLogosSizeOffset) <= m_iSize);
+	};
+
+	if(true == valid()) return true;
+
+	close();
+	return false;
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StationCatalog::openFor(const QString &file)
+{
+	const QFileInfo fi(file);
+	const auto name = fi.completeBaseName() + QStringLiteral(".catalog");
+
+	const QStringList candidates = {fi.absoluteDir().filePath(name),
+																	QDir(QCoreApplication::applicationDirPath()).filePath(name)};
+
+	//without its json file, a catalog is used as it is
+	const auto sourceHash = hash(file);
+
+	for(const auto &candidate : candidates)
+	{
+		if(false == open(candidate)) continue;
+		if((true == sourceHash.isEmpty()) || (sourceHash == this->sourceHash())) return true;
+	}
+
+	close();
+	return false;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationCatalog::close()
+{
+	if(nullptr != m_pData) m_File.unmap(const_cast<uchar*>(m_pData));
+	m_File.close();
+
+	m_pData = nullptr;
+	m_iSize = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StationCatalog::isOpen() const
+{
+	return nullptr != m_pData;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QByteArray StationCatalog::sourceHash() const
+{
+	if(nullptr == m_pData) return QByteArray();
+
+	return QByteArray(reinterpret_cast<const char*>(m_pData + ciHashOffset), ciHashSize);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QList<StationInformation> StationCatalog::stations() const
+{
+	TRACE_SCOPE("readCatalog", "catalog");
+
+	QList<StationInformation> stations;
+	if(nullptr == m_pData) return stations;
+
+	const qint64 count = word(ciCountOffset);
+	const qint64 indexOffset = word(ciIndexOffset);
+
+	stations.reserve(static_cast<int>(count));
+
+	for(qint64 i = 0; i < count; ++i)
+	{
+		const auto record = indexOffset + i * ciRecordWords * 4;
+		const auto field = [&](int w) { return word(record + w * 4); };
+		const auto text = [&](int w) { return string(field(w), field(w + 1)); };
+
+		StationInformation station;
+		station.m_strDefaultPublisher = text(ciNameWord);
+		station.m_strMediaUrl = text(ciMediaUrlWord);
+		station.m_strGenre = text(ciGenreWord);
+		station.m_strFirstMetadataKey = text(ciFirstMetadataKeyWord);
+		station.m_strSecondMetadataKey = text(ciSecondMetadataKeyWord);
+		station.m_uLogoUrl = text(ciLogoUrlWord);
+		station.m_strLogoFile = text(ciLogoFileWord);
+		station.m_MirrorUrls = text(ciMirrorUrlsWord).split(QLatin1Char('\n'), QString::SkipEmptyParts);
+		station.m_cBackgroundColorNormal = QColor::fromRgba(field(ciColorNormalWord));
+		station.m_cBackgroundColorChecked = QColor::fromRgba(field(ciColorCheckedWord));
+
+		if(0 != field(ciLogoBytesPerLineWord)) station.m_iCatalogLogo = static_cast<int>(i);
+
+		const QByteArray logoSource(reinterpret_cast<const char*>(m_pData + record + ciLogoSourceWord * 4), ciHashSize);
+		if(logoSource != QByteArray(ciHashSize, '\0')) station.m_baLogoSource = logoSource;
+
+		stations.append(station);
+	}
+
+	return stations;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QImage StationCatalog::logo(int index) const
+{
+	if((nullptr == m_pData) || (0 > index) || (word(ciCountOffset) <= static_cast<quint32>(index))) return QImage();
+
+	const auto record = word(ciIndexOffset) + static_cast<qint64>(index) * ciRecordWords * 4;
+	const auto field = [&](int w) { return word(record + w * 4); };
+
+	const qint64 offset = field(ciLogoOffsetWord);
+	const qint64 width = field(ciLogoWidthWord);
+	const qint64 height = field(ciLogoHeightWord);
+	const qint64 bytesPerLine = field(ciLogoBytesPerLineWord);
+
+	if((0 == bytesPerLine) || (0 != (offset % 4)) || (width * 4 > bytesPerLine) ||
+		 (offset + bytesPerLine * height > word(ciLogosSizeOffset)))
+	{
+		return QImage();
+	}
+
+	//the pixels are wrapped in place and copied, so the logo outlives the mapping
+	const QImage logo(m_pData + word(ciLogosOffset) + offset, static_cast<int>(width), static_cast<int>(height),
+										static_cast<int>(bytesPerLine), QImage::Format_ARGB32_Premultiplied);
+
+	return logo.copy();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString StationCatalog::string(quint32 offset, quint32 length) const
+{
+	//widened before multiplying, a length of 2^31 or more would otherwise wrap around in 32 bits
+	const auto bytes = static_cast<qint64>(length) * 2;
+	const qint64 size = word(ciStringsSizeOffset);
+
+	if((0 != (offset % 2)) || (length > static_cast<quint32>(std::numeric_limits<int>::max())) || (bytes > size) ||
+		 (static_cast<qint64>(offset) + bytes > size))
+	{
+		return QString();
+	}
+
+	return QString(reinterpret_cast<const QChar*>(m_pData + word(ciStringsOffset) + offset), static_cast<int>(length));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint32 StationCatalog::word(qint64 offset) const
+{
+	return qFromLittleEndian<quint32>(m_pData + offset);
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QImage>
+#include <QList>
+#include <QSize>
+#include <QString>
+
+#include "StationInformation.h"
+
+/**
+ * @brief The StationCatalog class reads and writes the compiled, binary form of the stations file
+ *
+ * The catalog is produced by the catalog-compiler tool from the json stations file. It starts with a versioned header,
+ * followed by an index holding one fixed size record per station, a table of UTF-16 strings and the logos, already
+ * decoded and downscaled to premultiplied ARGB32 pixels. All integers are little endian and all offsets are relative to
+ * their section, so the file is mapped into memory and read in place, nothing needs to be parsed or decoded.
+ *
+ * The header holds the hash of the json file the catalog was compiled from. A catalog is only used in place of a json
+ * file if the hashes match, so an edited json file is never shadowed by an outdated catalog.
+ *
+ * @note The json file stays the source format and the fallback, e.g. on big endian hosts catalogs are never opened
+ */
+class StationCatalog
+{
+public:
+
+	/**
+	 * @brief StationCatalog Default constructor, no catalog is opened
+	 */
+	StationCatalog();
+
+	/**
+	 * @brief write Compile stations into a catalog file
+	 * @param file The catalog file to write
+	 * @param stations The stations, embedded logos and logo files are decoded and downscaled here
+	 * @param sourceHash The hash of the json file the stations were read from, see hash()
+	 * @param logoSize The logos are downscaled to fit into this size in device pixels
+	 * @param error If set, receives the reason if writing failed
+	 * @return True if the catalog was written
+	 *
+	 * @note Relative logo files are resolved against the current directory, logos which cannot be loaded keep their
+	 * source and are loaded when shown like for a json file
+	 */
+	static bool write(const QString &file, const QList<StationInformation> &stations, const QByteArray &sourceHash,
+										const QSize &logoSize, QString* error = nullptr);
+
+	/**
+	 * @brief hash Compute the hash identifying a json stations file
+	 * @param file The json file
+	 * @return The hash, empty if the file cannot be read
+	 */
+	static QByteArray hash(const QString &file);
+
+	/**
+	 * @brief open Map a catalog file, closes the previous catalog
+	 * @param file The catalog file
+	 * @return True if the file is a valid catalog of the supported version
+	 */
+	bool open(const QString &file);
+
+	/**
+	 * @brief openFor Map the catalog compiled from a json stations file, if there is an up to date one
+	 * @param file The json stations file
+	 * @return True if a catalog matching the json file was opened
+	 *
+	 * @note The catalog is looked for next to the json file and next to the application
+	 */
+	bool openFor(const QString &file);
+
+	/**
+	 * @brief close Unmap the catalog
+	 */
+	void close();
+
+	/**
+	 * @brief isOpen Check if a catalog is mapped
+	 * @return True if a catalog is mapped
+	 */
+	bool isOpen() const;
+
+	/**
+	 * @brief sourceHash The hash of the json file the catalog was compiled from
+	 * @return The hash, empty if no catalog is mapped
+	 */
+	QByteArray sourceHash() const;
+
+	/**
+	 * @brief stations Read all stations from the catalog
+	 * @return The stations in catalog order, pre-scaled logos are referenced by StationInformation::m_iCatalogLogo
+	 */
+	QList<StationInformation> stations() const;
+
+	/**
+	 * @brief logo Copy a pre-scaled logo out of the catalog
+	 * @param index The logo index as given in StationInformation::m_iCatalogLogo
+	 * @return The logo, null if there is no such logo
+	 */
+	QImage logo(int index) const;
+
+private:
+
+	/**
+	 * @brief string Read a string from the string table
+	 * @param offset The offset in bytes relative to the string table
+	 * @param length The length in UTF-16 code units
+	 * @return The string, empty if it lies outside of the table
+	 */
+	QString string(quint32 offset, quint32 length) const;
+
+	/**
+	 * @brief word Read a little endian integer
+	 * @param offset The offset in bytes relative to the start of the catalog
+	 * @return The value
+	 */
+	quint32 word(qint64 offset) const;
+
+	/**
+	 * @brief m_File The mapped catalog file
+	 */
+	QFile m_File;
+
+	/**
+	 * @brief m_pData The mapped catalog, nullptr if no catalog is mapped
+	 */
+	const uchar* m_pData;
+
+	/**
+	 * @brief m_iSize The size of the mapped catalog in bytes
+	 */
+	qint64 m_iSize;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QByteArray>
+#include <QColor>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+/**
+ * @brief The StationInformation struct contains all information to describe a single radtio station stream
+ */
+struct StationInformation
+{
+	/**
+	 * @brief m_strDefaultPublisher The station publisher information, this is usually the station name
+	 *
+	 * @note This string is used as the default title when playing this station. If the first metadata key returns any
+	 * useful string data, that string is displayed instead.
+	 */
+	QString m_strDefaultPublisher;
+
+	//! From where to load the audio, must point to a format understandable by QMediaPlayer
+	QString m_strMediaUrl;
+
+	/**
+	 * @brief m_MirrorUrls Further urls of the same stream, the one answering fastest is played
+	 *
+	 * @note Read from a "url" array in the stations file, its first entry becomes m_strMediaUrl
+	 */
+	QStringList m_MirrorUrls;
+
+	//! The optional genre of the station, only used to search for stations
+	QString m_strGenre;
+
+	/**
+	 * @brief m_uLogoUrl The RadioGui tries to download the station logo from this url if provided
+	 *
+	 * @note Must be in a format suitable for QPixmap
+	 */
+	QUrl m_uLogoUrl;
+
+	/**
+	 * @brief m_baLogoData The base64 encoded logo as read from the stations file
+	 *
+	 * @note Decoded in the background when the station is shown, the result is kept by the LogoScaler
+	 */
+	QByteArray m_baLogoData;
+
+	/**
+	 * @brief m_strLogoFile The path of the logo file as read from the stations file
+	 *
+	 * @note Loaded in the background when the station is shown, the result is kept by the LogoScaler
+	 */
+	QString m_strLogoFile;
+
+	/**
+	 * @brief m_iCatalogLogo The index of the pre-scaled logo in the binary station catalog, -1 if there is none
+	 *
+	 * @note Only set for stations read from a StationCatalog, the logo is copied out of the catalog when shown
+	 */
+	int m_iCatalogLogo = -1;
+
+	/**
+	 * @brief m_baLogoSource A hash of the logo source as given in the stations file, empty if there is no logo
+	 *
+	 * @note Kept by the StationCatalog, so a station has the same fingerprint whether read from json or from a catalog
+	 */
+	QByteArray m_baLogoSource;
+
+	/**
+	 * @brief m_strFirstMetadataKey The data to display as the title for this stream, if this key can be found in the
+	 * meta data returned from the stream, that string is displayed
+	 *
+	 * @note The key is stored in lower case, the keys reported by the backend are compared case insensitive
+	 */
+	QString m_strFirstMetadataKey;
+
+	/**
+	 * @brief m_strSecondMetadataKey The secondary information to be displayed below the main metadata string
+	 *
+	 * @note The key is stored in lower case, the keys reported by the backend are compared case insensitive
+	 */
+	QString m_strSecondMetadataKey;
+
+	/**
+	 * @brief m_cBackgroundColor The background color for the stations button when the button is not checked
+	 *
+	 * @note The default color is defined as: rgb(0, 0, 0)
+	 */
+	QColor m_cBackgroundColorNormal;
+
+	/**
+	 * @brief m_cBackgroundColorChecked The background color for checked buttons
+	 *
+	 * @note The default color is defined as: rgb(72, 126, 176)
+	 */
+	QColor m_cBackgroundColorChecked;
+};
+
+//we want to store StationInformation values in QVariant instances
+Q_DECLARE_METATYPE(StationInformation)
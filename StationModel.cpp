@@ -0,0 +1,207 @@
+#include "StationModel.h"
+
+#include <QSet>
+
+StationModel::StationModel(QObject* parent)
+	: QAbstractListModel(parent)
+	, m_Registry()
+	, m_Ids()
+	, m_Rows()
+	, m_LogoStates()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationModel::setStations(const QList<StationInformation> &stations)
+{
+	beginResetModel();
+
+	m_Registry.clear();
+	m_Ids.clear();
+	m_LogoStates.clear();
+
+	m_Ids.reserve(stations.size());
+	for(const auto &station : stations)
+	{
+		const auto id = m_Registry.insert(station);
+
+		m_Ids.append(id);
+		m_LogoStates.insert(id, LogoNotLoaded);
+	}
+
+	updateRows();
+
+	endResetModel();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StationModel::Changes StationModel::update(const QList<StationInformation> &stations)
+{
+	Changes changes;
+
+	QSet<QString> names;
+	names.reserve(stations.size());
+	for(const auto &station : stations) names.insert(station.m_strDefaultPublisher);
+
+	//removed from the back, so the rows still to be checked do not move
+	for(auto row = m_Ids.size() - 1; row >= 0; --row)
+	{
+		const auto id = m_Ids.at(row);
+		const auto previous = m_Registry.station(id);
+		if(true == names.contains(previous->m_strDefaultPublisher)) continue;
+
+		beginRemoveRows(QModelIndex(), row, row);
+		m_Ids.remove(row);
+		m_LogoStates.remove(id);
+		m_Registry.remove(id);
+		endRemoveRows();
+
+		changes.m_Removed.insert(id, previous);
+	}
+
+	//all rows before the current one are final, so each station is either in place, further down or new
+	for(auto row = 0; row < stations.size(); ++row)
+	{
+		const auto &station = stations.at(row);
+		auto id = m_Registry.id(station.m_strDefaultPublisher);
+
+		if((m_Ids.size() <= row) || (id != m_Ids.at(row)))
+		{
+			if(0 > id)
+			{
+				beginInsertRows(QModelIndex(), row, row);
+				id = m_Registry.insert(station);
+				m_Ids.insert(row, id);
+				m_LogoStates.insert(id, LogoNotLoaded);
+				endInsertRows();
+
+				changes.m_Added << id;
+				continue;
+			}
+
+			const auto from = m_Ids.indexOf(id, row + 1);
+
+			beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+			m_Ids.move(from, row);
+			endMoveRows();
+		}
+
+		const auto previous = m_Registry.station(id);
+
+		//compared by fingerprint, a station read from the catalog has its logo pre-scaled instead of data, file or url
+		const auto logoChanged = previous->m_baLogoSource != station.m_baLogoSource;
+
+		const auto colorsChanged = (previous->m_cBackgroundColorNormal != station.m_cBackgroundColorNormal) ||
+															 (previous->m_cBackgroundColorChecked != station.m_cBackgroundColorChecked);
+
+		const auto changed = logoChanged || colorsChanged ||
+												 (previous->m_strMediaUrl != station.m_strMediaUrl) ||
+												 (previous->m_MirrorUrls != station.m_MirrorUrls) ||
+												 (previous->m_strGenre != station.m_strGenre) ||
+												 (previous->m_strFirstMetadataKey != station.m_strFirstMetadataKey) ||
+												 (previous->m_strSecondMetadataKey != station.m_strSecondMetadataKey);
+
+		if(false == changed) continue;
+
+		//the loaded logo is still valid as long as it comes from the same source
+		if(true == logoChanged)
+		{
+			m_LogoStates[id] = LogoNotLoaded;
+			changes.m_LogoChanged.insert(id, previous);
+		}
+
+		if(true == colorsChanged) changes.m_ColorsChanged << id;
+		changes.m_Changed << id;
+
+		m_Registry.insert(station);
+
+		const auto i = index(row);
+		emit dataChanged(i, i);
+	}
+
+	updateRows();
+
+	return changes;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int StationModel::id(int row) const
+{
+	return m_Ids.value(row, -1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int StationModel::row(int id) const
+{
+	return m_Rows.value(id, -1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int StationModel::find(const QString &name) const
+{
+	return m_Registry.id(name);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StationRecord StationModel::station(int id) const
+{
+	return m_Registry.station(id);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StationModel::LogoState StationModel::logoState(int id) const
+{
+	return m_LogoStates.value(id, LogoNotLoaded);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationModel::setLogoState(int id, LogoState state)
+{
+	if((false == m_LogoStates.contains(id)) || (state == m_LogoStates.value(id))) return;
+
+	m_LogoStates[id] = state;
+
+	const auto i = index(row(id));
+	emit dataChanged(i, i, QVector<int>() << LogoStateRole);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationModel::updateRows()
+{
+	m_Rows.clear();
+	m_Rows.reserve(m_Ids.size());
+	for(auto i = 0; i < m_Ids.size(); ++i) m_Rows.insert(m_Ids.at(i), i);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int StationModel::rowCount(const QModelIndex &parent) const
+{
+	return (true == parent.isValid()) ? 0 : m_Ids.size();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QVariant StationModel::data(const QModelIndex &index, int role) const
+{
+	if((false == index.isValid()) || (m_Ids.size() <= index.row())) return QVariant();
+
+	const auto id = m_Ids.at(index.row());
+	const auto station = m_Registry.station(id);
+
+	switch(role)
+	{
+		case Qt::DisplayRole:
+			return station->m_strDefaultPublisher;
+
+		case StationRole:
+			return QVariant::fromValue(*station);
+
+		case LogoStateRole:
+			return m_LogoStates.value(id, LogoNotLoaded);
+
+		case IdRole:
+			return id;
+	}
+
+	return QVariant();
+}
+//----------------------------------------------------------------------------------------------------------------------
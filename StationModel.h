@@ -0,0 +1,174 @@
+#pragma once
+
+#include <QAbstractListModel>
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include "StationRegistry.h"
+
+/**
+ * @brief The StationModel class provides the station catalog to the views
+ *
+ * The stations are kept in a StationRegistry, the model only orders their ids. Views refer to stations by id, which
+ * stays valid while rows are inserted, removed or moved.
+ *
+ * Logos are not loaded up front, the views request them for the items they actually show. The model only tracks how
+ * far loading the logo of each station got.
+ */
+class StationModel : public QAbstractListModel
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief The Roles enum lists the additional data roles
+	 */
+	enum Roles
+	{
+		//! The complete StationInformation
+		StationRole = Qt::UserRole + 1,
+
+		//! The LogoState of the station
+		LogoStateRole,
+
+		//! The station id
+		IdRole
+	};
+
+	/**
+	 * @brief The LogoState enum describes how far loading the logo of a station got
+	 */
+	enum LogoState
+	{
+		//! The logo was not requested yet
+		LogoNotLoaded,
+
+		//! The logo is being decoded or downloaded
+		LogoLoading,
+
+		//! The logo was loaded and handed to the LogoScaler
+		LogoLoaded,
+
+		//! The station has no logo or loading it failed, the station name is displayed instead
+		LogoMissing
+	};
+
+	/**
+	 * @brief The Changes struct lists the stations affected by update()
+	 */
+	struct Changes
+	{
+		//! The ids of the stations which were not in the catalog before
+		QList<int> m_Added;
+
+		//! The last records of the stations which are no longer in the catalog, by their ids
+		QHash<int, StationRecord> m_Removed;
+
+		//! The ids of the stations with any changed information
+		QList<int> m_Changed;
+
+		//! The previous records of the stations with a changed logo source by their ids, their logos must be loaded again
+		QHash<int, StationRecord> m_LogoChanged;
+
+		//! The ids of the stations with changed colors
+		QList<int> m_ColorsChanged;
+	};
+
+	/**
+	 * @brief StationModel Default constructor
+	 * @param parent
+	 */
+	explicit StationModel(QObject* parent = nullptr);
+
+	/**
+	 * @brief setStations Replace the whole catalog
+	 * @param stations The stations
+	 */
+	void setStations(const QList<StationInformation> &stations);
+
+	/**
+	 * @brief update Merge a new version of the catalog, matching the stations by name
+	 * @param stations The stations
+	 * @return The affected stations
+	 *
+	 * @note Only the affected rows are inserted, removed, moved or changed. The stations keep their ids, loaded logos
+	 * are kept unless their source changed.
+	 */
+	Changes update(const QList<StationInformation> &stations);
+
+	/**
+	 * @brief id The id of the station in a row
+	 * @param row The row
+	 * @return The station id, -1 if the row is invalid
+	 */
+	int id(int row) const;
+
+	/**
+	 * @brief row The row of a station
+	 * @param id The station id
+	 * @return The row, -1 if there is no such station
+	 */
+	int row(int id) const;
+
+	/**
+	 * @brief find Find a station by its name
+	 * @param name The station name
+	 * @return The station id, -1 if there is no such station
+	 */
+	int find(const QString &name) const;
+
+	/**
+	 * @brief station The current record of a station
+	 * @param id The station id
+	 * @return The record, nullptr if there is no such station
+	 */
+	StationRecord station(int id) const;
+
+	/**
+	 * @brief logoState The loading state of a station logo
+	 * @param id The station id
+	 * @return The logo state
+	 */
+	LogoState logoState(int id) const;
+
+	/**
+	 * @brief setLogoState Update how far loading the logo of a station got
+	 * @param id The station id
+	 * @param state The logo state
+	 */
+	void setLogoState(int id, LogoState state);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+
+	/**
+	 * @brief updateRows Index the rows of all stations by id
+	 */
+	void updateRows();
+
+	/**
+	 * @brief m_Registry All stations
+	 */
+	StationRegistry m_Registry;
+
+	/**
+	 * @brief m_Ids The station ids in catalog order
+	 */
+	QVector<int> m_Ids;
+
+	/**
+	 * @brief m_Rows The row of each station, keyed by id
+	 */
+	QHash<int, int> m_Rows;
+
+	/**
+	 * @brief m_LogoStates The logo state of each station, keyed by id
+	 */
+	QHash<int, LogoState> m_LogoStates;
+};
@@ -0,0 +1,464 @@
+#include "StationProber.h"
+
+#include <limits>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHostInfo>
+#include <QSaveFile>
+#include <QSslSocket>
+#include <QStandardPaths>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+
+#include "Tracer.h"
+
+namespace
+{
+
+//the number of probes running at once when not throttled
+const int ciDefaultConcurrency = 4;
+
+//the pause between two probes while throttled, in milliseconds
+const int ciThrottledDelay = 2000;
+
+//the delay before checking again whether the playback still needs the bandwidth, in milliseconds
+const int ciBusyDelay = 1000;
+
+//the time after which a probe is recorded as failed, in milliseconds
+const int ciProbeTimeout = 8000;
+
+//the largest response header accepted, the connection is closed afterwards anyway
+const int ciMaxHeaderSize = 16 * 1024;
+
+//the socket data buffered beyond the header, keeps the stream from flowing in before the connection is closed
+const qint64 ciReadBufferSize = 4 * 1024;
+
+//how many redirects are followed
+const int ciMaxRedirects = 3;
+
+/**
+ * @brief AddTime Add the duration of a phase, a phase of a redirect adds to the same phase of the previous request
+ * @param phase The phase time, -1 if not reached yet
+ * @param milliseconds The duration
+ */
+void AddTime(qint64 &phase, qint64 milliseconds)
+{
+	phase = qMax<qint64>(0, phase) + milliseconds;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+StationProber::StationProber(const QString &file)
+	: QObject(nullptr)
+	, m_strFile(file)
+	, m_Results()
+	, m_Pending()
+	, m_Running()
+	, m_ScheduleTimer()
+	, m_fBusy()
+	, m_iConcurrency(ciDefaultConcurrency)
+	, m_bThrottled(false)
+{
+	if(true == m_strFile.isEmpty())
+	{
+		m_strFile = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/station-health.json");
+	}
+
+	QDir().mkpath(QFileInfo(m_strFile).absolutePath());
+
+	m_ScheduleTimer.setSingleShot(true);
+	connect(&m_ScheduleTimer, &QTimer::timeout, this, &StationProber::schedule);
+
+	loadResults();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StationProber::~StationProber()
+{
+	//unfinished probes are not recorded, they are repeated on the next run
+	for(auto probe : m_Running)
+	{
+		if(-1 != probe->m_iLookupId) QHostInfo::abortHostLookup(probe->m_iLookupId);
+		if(nullptr != probe->m_pSocket) probe->m_pSocket->disconnect(this);
+
+		delete probe;
+	}
+
+	saveResults();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::setConcurrency(int count)
+{
+	m_iConcurrency = qMax(1, count);
+	schedule();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::setThrottled(bool throttled)
+{
+	if(throttled == m_bThrottled) return;
+
+	m_bThrottled = throttled;
+
+	//the pause between throttled probes is not needed anymore
+	if(false == m_bThrottled)
+	{
+		m_ScheduleTimer.stop();
+		schedule();
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::setBusyCheck(const BusyCheck &check)
+{
+	m_fBusy = check;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::probe(const QStringList &urls, qint64 maxAge)
+{
+	const auto now = QDateTime::currentDateTimeUtc();
+
+	for(const auto &url : urls)
+	{
+		if((true == url.isEmpty()) || (true == m_Pending.contains(url))) continue;
+
+		auto running = false;
+		for(auto probe : m_Running) running = running || (url == probe->m_strUrl);
+		if(true == running) continue;
+
+		const auto probed = m_Results.value(url).m_tProbed;
+		if((0 < maxAge) && (true == probed.isValid()) && (maxAge > probed.secsTo(now))) continue;
+
+		m_Pending.append(url);
+	}
+
+	schedule();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StationProber::isIdle() const
+{
+	return (true == m_Pending.isEmpty()) && (true == m_Running.isEmpty());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StationProber::Result StationProber::result(const QString &url) const
+{
+	return m_Results.value(url);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StationProber::isDead(const QStringList &urls) const
+{
+	if(true == urls.isEmpty()) return false;
+
+	for(const auto &url : urls)
+	{
+		const auto it = m_Results.constFind(url);
+		if((m_Results.constEnd() == it) || (true == it->isAlive())) return false;
+	}
+
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString StationProber::fastest(const QStringList &urls) const
+{
+	QString best;
+	auto bestLatency = std::numeric_limits<qint64>::max();
+
+	for(const auto &url : urls)
+	{
+		const auto it = m_Results.constFind(url);
+		if((m_Results.constEnd() == it) || (false == it->isAlive()) || (bestLatency <= it->latency())) continue;
+
+		best = url;
+		bestLatency = it->latency();
+	}
+
+	if(false == best.isEmpty()) return best;
+
+	//nothing is known to be alive, an url which was not probed yet may still work
+	for(const auto &url : urls)
+	{
+		if(false == m_Results.contains(url)) return url;
+	}
+
+	return urls.value(0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::schedule()
+{
+	//a pause between throttled probes or a busy player delays all probes
+	if(true == m_ScheduleTimer.isActive()) return;
+
+	const auto limit = (true == m_bThrottled) ? 1 : m_iConcurrency;
+
+	while((false == m_Pending.isEmpty()) && (limit > m_Running.size()))
+	{
+		if((nullptr != m_fBusy) && (true == m_fBusy()))
+		{
+			m_ScheduleTimer.start(ciBusyDelay);
+			return;
+		}
+
+		auto probe = new Probe();
+		probe->m_strUrl = m_Pending.takeFirst();
+		probe->m_uRequest = QUrl(probe->m_strUrl);
+		probe->m_pTimeout = new QTimer(this);
+		probe->m_pTimeout->setSingleShot(true);
+
+		connect(probe->m_pTimeout, &QTimer::timeout, this, [=]() { finish(probe, QStringLiteral("Timeout")); });
+
+		m_Running.append(probe);
+
+		Tracer::asyncBegin("probeStation", "network", reinterpret_cast<quintptr>(probe), probe->m_strUrl);
+
+		probe->m_pTimeout->start(ciProbeTimeout);
+		request(probe);
+
+		if(true == m_bThrottled)
+		{
+			m_ScheduleTimer.start(ciThrottledDelay);
+			return;
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::request(Probe* probe)
+{
+	const auto url = probe->m_uRequest;
+	const auto scheme = url.scheme().toLower();
+
+	if((QStringLiteral("http") != scheme) && (QStringLiteral("https") != scheme))
+	{
+		finish(probe, QStringLiteral("Unsupported scheme"));
+		return;
+	}
+
+	if((QStringLiteral("https") == scheme) && (false == QSslSocket::supportsSsl()))
+	{
+		finish(probe, QStringLiteral("No SSL support"));
+		return;
+	}
+
+	probe->m_Clock.start();
+
+	//the lookup is done separately, so its time is not hidden in the connect
+	probe->m_iLookupId = QHostInfo::lookupHost(url.host(), this, [=](const QHostInfo &info)
+	{
+		probe->m_iLookupId = -1;
+
+		if((QHostInfo::NoError != info.error()) || (true == info.addresses().isEmpty()))
+		{
+			finish(probe, info.errorString());
+			return;
+		}
+
+		AddTime(probe->m_Result.m_iLookupTime, probe->m_Clock.restart());
+
+		const auto https = (QStringLiteral("https") == scheme);
+		const auto port = static_cast<quint16>(url.port(https ? 443 : 80));
+
+		auto socket = (true == https) ? new QSslSocket(this) : new QTcpSocket(this);
+		probe->m_pSocket = socket;
+
+		//only the header is of interest, the stream must not take the bandwidth of the playing station
+		socket->setReadBufferSize(ciReadBufferSize);
+
+		connect(socket, &QTcpSocket::readyRead, this, [=]() { onReadyRead(probe); });
+		connect(socket, static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error), this,
+						[=]() { finish(probe, socket->errorString()); });
+
+		if(true == https)
+		{
+			auto sslSocket = static_cast<QSslSocket*>(socket);
+			connect(sslSocket, &QSslSocket::encrypted, this, [=]() { onConnected(probe); });
+			sslSocket->connectToHostEncrypted(info.addresses().first().toString(), port, url.host());
+		}
+		else
+		{
+			connect(socket, &QTcpSocket::connected, this, [=]() { onConnected(probe); });
+			socket->connectToHost(info.addresses().first(), port);
+		}
+	});
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::onConnected(Probe* probe)
+{
+	AddTime(probe->m_Result.m_iConnectTime, probe->m_Clock.restart());
+
+	const auto url = probe->m_uRequest;
+
+	auto path = url.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority | QUrl::RemoveFragment);
+	if(true == path.isEmpty()) path = "/";
+
+	auto host = url.host(QUrl::FullyEncoded).toLatin1();
+	if(-1 != url.port()) host += ':' + QByteArray::number(url.port());
+
+	//http 1.0 keeps the response free of chunked encoding, the server closes the connection after the stream
+	QByteArray request;
+	request += "GET " + path + " HTTP/1.0\r\n";
+	request += "Host: " + host + "\r\n";
+	request += "User-Agent: radio-ui\r\n";
+	request += "Icy-MetaData: 1\r\n";
+	request += "\r\n";
+
+	probe->m_pSocket->write(request);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::onReadyRead(Probe* probe)
+{
+	auto socket = probe->m_pSocket;
+
+	if(true == probe->m_baHeader.isEmpty()) AddTime(probe->m_Result.m_iFirstByteTime, probe->m_Clock.restart());
+
+	probe->m_baHeader += socket->read(ciMaxHeaderSize - probe->m_baHeader.size());
+
+	const auto end = probe->m_baHeader.indexOf("\r\n\r\n");
+	if(-1 == end)
+	{
+		if(ciMaxHeaderSize <= probe->m_baHeader.size()) finish(probe, QStringLiteral("Response header too large"));
+		return;
+	}
+
+	const auto lines = probe->m_baHeader.left(end).split('\n');
+
+	//shoutcast servers answer with "ICY 200 OK" instead of a http status line
+	const auto statusLine = lines.first().simplified().split(' ');
+	const auto status = statusLine.value(1).toInt();
+
+	QMap<QByteArray, QByteArray> headers;
+	for(auto i = 1; i < lines.size(); ++i)
+	{
+		const auto colon = lines.at(i).indexOf(':');
+		if(0 < colon) headers.insert(lines.at(i).left(colon).trimmed().toLower(), lines.at(i).mid(colon + 1).trimmed());
+	}
+
+	if((300 <= status) && (400 > status) && (true == headers.contains("location")) && (ciMaxRedirects > probe->m_iRedirects))
+	{
+		++probe->m_iRedirects;
+
+		probe->m_pSocket = nullptr;
+		probe->m_baHeader.clear();
+		probe->m_uRequest = probe->m_uRequest.resolved(QUrl::fromEncoded(headers.value("location")));
+
+		socket->disconnect(this);
+		socket->abort();
+		socket->deleteLater();
+
+		request(probe);
+		return;
+	}
+
+	probe->m_Result.m_iStatus = status;
+	probe->m_Result.m_strContentType = QString::fromLatin1(headers.value("content-type"));
+	probe->m_Result.m_iBitrate = headers.value("icy-br").split(',').first().trimmed().toInt();
+
+	finish(probe, (0 == status) ? QStringLiteral("Invalid response") : QString());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::finish(Probe* probe, const QString &error)
+{
+	m_Running.removeOne(probe);
+
+	if(-1 != probe->m_iLookupId) QHostInfo::abortHostLookup(probe->m_iLookupId);
+
+	if(nullptr != probe->m_pSocket)
+	{
+		probe->m_pSocket->disconnect(this);
+		probe->m_pSocket->abort();
+		probe->m_pSocket->deleteLater();
+	}
+
+	//the probe may be finished by its own timeout
+	probe->m_pTimeout->stop();
+	probe->m_pTimeout->deleteLater();
+
+	auto result = probe->m_Result;
+	result.m_strError = error;
+	result.m_tProbed = QDateTime::currentDateTimeUtc();
+
+	const auto url = probe->m_strUrl;
+	m_Results.insert(url, result);
+
+	Tracer::asyncEnd("probeStation", "network", reinterpret_cast<quintptr>(probe));
+
+	delete probe;
+
+	emit resultChanged(url);
+
+	schedule();
+
+	if(false == isIdle()) return;
+
+	//the results are written once per run, not after every probe
+	saveResults();
+	emit finished();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::loadResults()
+{
+	QFile f(m_strFile);
+	if(false == f.open(QFile::ReadOnly)) return;
+
+	const auto jsonObj = QJsonDocument::fromJson(f.readAll()).object();
+
+	for(const auto &url : jsonObj.keys())
+	{
+		const auto resultObject = jsonObj.value(url).toObject();
+
+		Result r;
+		r.m_iLookupTime = static_cast<qint64>(resultObject.value("lookup").toDouble(-1));
+		r.m_iConnectTime = static_cast<qint64>(resultObject.value("connect").toDouble(-1));
+		r.m_iFirstByteTime = static_cast<qint64>(resultObject.value("first-byte").toDouble(-1));
+		r.m_iStatus = resultObject.value("status").toInt();
+		r.m_strContentType = resultObject.value("content-type").toString();
+		r.m_iBitrate = resultObject.value("bitrate").toInt();
+		r.m_strError = resultObject.value("error").toString();
+		r.m_tProbed = QDateTime::fromString(resultObject.value("probed").toString(), Qt::ISODate);
+
+		if(true == r.m_tProbed.isValid()) m_Results.insert(url, r);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationProber::saveResults() const
+{
+	QJsonObject jsonObj;
+
+	for(auto it = m_Results.cbegin(); it != m_Results.cend(); ++it)
+	{
+		QJsonObject resultObject;
+		resultObject.insert("lookup", static_cast<double>(it->m_iLookupTime));
+		resultObject.insert("connect", static_cast<double>(it->m_iConnectTime));
+		resultObject.insert("first-byte", static_cast<double>(it->m_iFirstByteTime));
+		resultObject.insert("status", it->m_iStatus);
+		resultObject.insert("content-type", it->m_strContentType);
+		resultObject.insert("bitrate", it->m_iBitrate);
+		resultObject.insert("error", it->m_strError);
+		resultObject.insert("probed", it->m_tProbed.toString(Qt::ISODate));
+
+		jsonObj.insert(it.key(), resultObject);
+	}
+
+	QSaveFile f(m_strFile);
+	if(false == f.open(QFile::WriteOnly)) return;
+
+	f.write(QJsonDocument(jsonObj).toJson(QJsonDocument::Compact));
+	f.commit();
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <functional>
+
+#include <QObject>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QStringList>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+
+/**
+ * @brief The StationProber class checks the station urls in the background
+ *
+ * Each url is requested once without following the stream: the name lookup, the connect and the first byte of the
+ * response are timed, the status, content type and announced bitrate are taken from the response header and the
+ * connection is closed right after the header. Redirects are followed, their times add up. Only a limited number of
+ * probes run at once.
+ *
+ * While a station is playing the prober is throttled to a single probe with a pause in between, and no probe is
+ * started while the busy check reports that the player needs the bandwidth, e.g. while filling its jitter buffer.
+ *
+ * @note The results are kept in a json file in the cache location, so dead and slow urls are known right after startup
+ */
+class StationProber : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief The Result struct describes the last probe of an url
+	 */
+	struct Result
+	{
+		//! The time needed to resolve the host names in milliseconds, -1 if not reached
+		qint64 m_iLookupTime = -1;
+
+		//! The time needed to connect after the lookup, including the encryption, in milliseconds, -1 if not reached
+		qint64 m_iConnectTime = -1;
+
+		//! The time from sending the request to the first byte of the response in milliseconds, -1 if not reached
+		qint64 m_iFirstByteTime = -1;
+
+		//! The http status of the final response, 0 if there was none
+		int m_iStatus = 0;
+
+		//! The content type of the final response
+		QString m_strContentType;
+
+		//! The bitrate announced by the server in kbit/s, 0 if unknown
+		int m_iBitrate = 0;
+
+		//! Why the probe failed, empty if a response was received
+		QString m_strError;
+
+		//! When the probe finished, invalid if the url was never probed
+		QDateTime m_tProbed;
+
+		/**
+		 * @brief isAlive Check if the url delivered a stream
+		 * @return True for a successful response
+		 */
+		bool isAlive() const { return (true == m_strError.isEmpty()) && (200 <= m_iStatus) && (300 > m_iStatus); }
+
+		/**
+		 * @brief latency The time until the stream started to arrive
+		 * @return The sum of all phases in milliseconds
+		 */
+		qint64 latency() const { return m_iLookupTime + m_iConnectTime + m_iFirstByteTime; }
+	};
+
+	/**
+	 * @brief BusyCheck Tells whether the playback needs the bandwidth right now
+	 */
+	typedef std::function<bool()> BusyCheck;
+
+	/**
+	 * @brief StationProber Default constructor, loads the results of earlier runs
+	 * @param file Where to keep the results, the default location is used if empty
+	 */
+	explicit StationProber(const QString &file = QString());
+
+	/**
+	 * @brief ~StationProber Aborts the running probes and saves the results
+	 */
+	virtual ~StationProber();
+
+	/**
+	 * @brief setConcurrency Limit the number of probes running at once
+	 * @param count The limit, at least 1
+	 */
+	void setConcurrency(int count);
+
+	/**
+	 * @brief setThrottled Run a single probe at a time with a pause in between, used while a station is playing
+	 * @param throttled True to throttle
+	 */
+	void setThrottled(bool throttled);
+
+	/**
+	 * @brief setBusyCheck Hold back new probes while the check returns true
+	 * @param check The check, nullptr to never hold back
+	 */
+	void setBusyCheck(const BusyCheck &check);
+
+	/**
+	 * @brief probe Queue urls for probing
+	 * @param urls The urls
+	 * @param maxAge Urls probed less than this many seconds ago are skipped, 0 probes all urls
+	 */
+	void probe(const QStringList &urls, qint64 maxAge = 0);
+
+	/**
+	 * @brief isIdle Check if all queued urls were probed
+	 * @return True if no probe is running or pending
+	 */
+	bool isIdle() const;
+
+	/**
+	 * @brief result The last result for an url
+	 * @param url The url
+	 * @return The result, its probe time is invalid if the url was never probed
+	 */
+	Result result(const QString &url) const;
+
+	/**
+	 * @brief isDead Check if all urls of a station failed their last probe
+	 * @param urls The urls of the station
+	 * @return True if every url was probed and none of them is alive
+	 */
+	bool isDead(const QStringList &urls) const;
+
+	/**
+	 * @brief fastest Pick the url to play
+	 * @param urls The urls of a station, the first one is preferred while nothing is known
+	 * @return The alive url with the lowest latency, else the first url not known to be dead, else the first url
+	 */
+	QString fastest(const QStringList &urls) const;
+
+signals:
+
+	/**
+	 * @brief resultChanged Emitted when a probe finished
+	 * @param url The probed url
+	 */
+	void resultChanged(const QString &url);
+
+	/**
+	 * @brief finished Emitted when all queued urls were probed
+	 */
+	void finished();
+
+private:
+
+	/**
+	 * @brief The Probe struct describes a running probe
+	 */
+	struct Probe
+	{
+		//! The url queued for probing
+		QString m_strUrl;
+
+		//! The url of the current request, differs from m_strUrl after a redirect
+		QUrl m_uRequest;
+
+		//! The result collected so far
+		Result m_Result;
+
+		//! The running host name lookup, -1 if none
+		int m_iLookupId = -1;
+
+		//! The connection, null while looking up the host name
+		QTcpSocket* m_pSocket = nullptr;
+
+		//! The response header received so far
+		QByteArray m_baHeader;
+
+		//! Measures the current phase
+		QElapsedTimer m_Clock;
+
+		//! The number of redirects followed so far
+		int m_iRedirects = 0;
+
+		//! Limits the time of the whole probe
+		QTimer* m_pTimeout = nullptr;
+	};
+
+	/**
+	 * @brief schedule Start pending probes as far as the limits allow
+	 */
+	void schedule();
+
+	/**
+	 * @brief request Look up the host of the current request and connect to it
+	 * @param probe The probe
+	 */
+	void request(Probe* probe);
+
+	/**
+	 * @brief onConnected Time the connect and send the request
+	 * @param probe The probe
+	 */
+	void onConnected(Probe* probe);
+
+	/**
+	 * @brief onReadyRead Collect the response header, finish the probe or follow a redirect once it is complete
+	 * @param probe The probe
+	 */
+	void onReadyRead(Probe* probe);
+
+	/**
+	 * @brief finish Record the result of a probe and start the next one
+	 * @param probe The probe, deleted
+	 * @param error Why the probe failed, empty if a response was received
+	 */
+	void finish(Probe* probe, const QString &error = QString());
+
+	/**
+	 * @brief loadResults Read the results of earlier runs
+	 */
+	void loadResults();
+
+	/**
+	 * @brief saveResults Write all results
+	 */
+	void saveResults() const;
+
+	/**
+	 * @brief m_strFile Where the results are kept
+	 */
+	QString m_strFile;
+
+	/**
+	 * @brief m_Results The last result of each url
+	 */
+	QMap<QString, Result> m_Results;
+
+	/**
+	 * @brief m_Pending The urls waiting to be probed, in order
+	 */
+	QStringList m_Pending;
+
+	/**
+	 * @brief m_Running The running probes
+	 */
+	QList<Probe*> m_Running;
+
+	/**
+	 * @brief m_ScheduleTimer Delays the next probe while throttled or busy
+	 */
+	QTimer m_ScheduleTimer;
+
+	/**
+	 * @brief m_fBusy Holds back new probes while it returns true
+	 */
+	BusyCheck m_fBusy;
+
+	/**
+	 * @brief m_iConcurrency The number of probes running at once when not throttled
+	 */
+	int m_iConcurrency;
+
+	/**
+	 * @brief m_bThrottled True while a single probe runs at a time, with a pause in between
+	 */
+	bool m_bThrottled;
+};
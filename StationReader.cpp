@@ -0,0 +1,245 @@
+#include "StationReader.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+
+#include "PoolTask.h"
+#include "Tracer.h"
+
+namespace
+{
+
+//changes within this interval are parsed together, in milliseconds
+const int ciReloadDelay = 250;
+
+/**
+ * @brief LogoSource Hash the logo source of a station
+ * @param station The station as read from the stations file
+ * @return The hash, empty if the station has no logo
+ */
+QByteArray LogoSource(const StationInformation &station)
+{
+	QCryptographicHash h(QCryptographicHash::Sha1);
+
+	//the kind is hashed as well, so a path can never match the same url
+	if(false == station.m_baLogoData.isEmpty()) h.addData(QByteArrayLiteral("logo\n") + station.m_baLogoData);
+	else if(false == station.m_strLogoFile.isEmpty()) h.addData("logo-file\n" + station.m_strLogoFile.toUtf8());
+	else if(false == station.m_uLogoUrl.isEmpty()) h.addData("logo-url\n" + station.m_uLogoUrl.toEncoded());
+	else return QByteArray();
+
+	return h.result();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+StationReader::StationReader()
+	: QObject(nullptr)
+	, m_strFile()
+	, m_Receiver()
+	, m_uGeneration(0)
+	, m_Watcher()
+	, m_Timer()
+	, m_Pool()
+{
+	m_Pool.setMaxThreadCount(1);
+
+	qRegisterMetaType<QList<StationInformation>>();
+
+	m_Timer.setSingleShot(true);
+	m_Timer.setInterval(ciReloadDelay);
+
+	connect(&m_Timer, &QTimer::timeout, this, &StationReader::reload);
+	connect(&m_Watcher, &QFileSystemWatcher::fileChanged, this, &StationReader::onFileChanged);
+	connect(&m_Watcher, &QFileSystemWatcher::directoryChanged, this, &StationReader::onDirectoryChanged);
+
+	//the signal is emitted from the worker, the receiver must be called on our own thread
+	connect(this, &StationReader::stationsRead, this, &StationReader::onStationsRead, Qt::QueuedConnection);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StationReader::~StationReader()
+{
+	m_Pool.clear();
+	m_Pool.waitForDone();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QList<StationInformation> StationReader::readFile(const QString &file, bool* valid)
+{
+	TRACE_SCOPE("readStations", "catalog");
+
+	QList<StationInformation> stations;
+
+	if(nullptr != valid) *valid = false;
+
+	QFileInfo fi(file);
+	if(false == fi.exists()) return stations;
+
+	QFile f(fi.absoluteFilePath());
+	if(true == f.open(QFile::ReadOnly))
+	{
+		QTextStream s(&f);
+		QJsonParseError error;
+		QJsonDocument jsonDocument = QJsonDocument::fromJson(s.readAll().toUtf8(), &error);
+
+		if((nullptr != valid) && (QJsonParseError::NoError == error.error)) *valid = jsonDocument.isObject();
+
+		const auto jsonObj = jsonDocument.object();
+
+		//all top-level keys are used as  the station names (which may get overwritten when meta-data is found)
+		for(const auto &stationName : jsonObj.keys())
+		{
+			const auto stationObject = jsonObj.value(stationName).toObject();
+
+			bool validLogo = (stationObject.contains("logo") ||
+												stationObject.contains("logo-file") ||
+												stationObject.contains("logo-url"));
+
+			bool valid = stationObject.contains("url") &&
+									 validLogo &&
+									 stationObject.contains("meta_key_1") &&
+									 stationObject.contains("meta_key_2");
+
+			if(false == valid) continue;
+
+			StationInformation station;
+			station.m_strDefaultPublisher = stationName;
+			station.m_strMediaUrl = stationObject.value("url").toString();
+
+			//a station may list mirrors of its stream, the first url is the one played until they were probed
+			if(true == stationObject.value("url").isArray())
+			{
+				for(const auto &url : stationObject.value("url").toArray())
+				{
+					if(false == url.toString().isEmpty()) station.m_MirrorUrls << url.toString();
+				}
+
+				if(false == station.m_MirrorUrls.isEmpty()) station.m_strMediaUrl = station.m_MirrorUrls.takeFirst();
+			}
+			station.m_strGenre = stationObject.value("genre").toString();
+			station.m_strFirstMetadataKey = stationObject.value("meta_key_1").toString().toLower();
+			station.m_strSecondMetadataKey = stationObject.value("meta_key_2").toString().toLower();
+
+			//we expect the logo data as base64 data, decoding is done later in the background
+			if(true == stationObject.contains("logo"))
+			{
+				station.m_baLogoData = stationObject.value(QString("logo")).toString().toLatin1();
+			}
+			//alternatively we allow the logo-file point to a valid image file
+			else if(true == stationObject.contains("logo-file"))
+			{
+				station.m_strLogoFile = stationObject.value(QString("logo-file")).toString();
+			}
+			else if(true == stationObject.contains("logo-url"))
+			{
+				//only store the url, download needs to be performed when needed
+				station.m_uLogoUrl = stationObject.value(QString("logo-url")).toString();
+			}
+
+			station.m_baLogoSource = LogoSource(station);
+
+			{
+				station.m_cBackgroundColorNormal = Qt::black;
+
+				if(true == stationObject.contains("background-color-normal"))
+				{
+					auto backgroundColor = stationObject.value(QString("background-color-normal")).toString();
+
+					QColor c(backgroundColor);
+					if(true == c.isValid())
+					{
+						station.m_cBackgroundColorNormal = c;
+					}
+				}
+			}
+
+			{
+				station.m_cBackgroundColorChecked = QColor(72, 126, 176);
+
+				if(true == stationObject.contains("background-color-checked"))
+				{
+					auto backgroundColor = stationObject.value(QString("background-color-checked")).toString();
+
+					QColor c(backgroundColor);
+					if(true == c.isValid())
+					{
+						station.m_cBackgroundColorChecked = c;
+					}
+				}
+			}
+
+			stations.append(station);
+		}
+	}
+
+	return stations;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationReader::watch(const QString &file, const StationsReceiver &receiver)
+{
+	if(false == m_Watcher.files().isEmpty()) m_Watcher.removePaths(m_Watcher.files());
+	if(false == m_Watcher.directories().isEmpty()) m_Watcher.removePaths(m_Watcher.directories());
+
+	m_strFile = QFileInfo(file).absoluteFilePath();
+	m_Receiver = receiver;
+
+	m_Watcher.addPath(QFileInfo(m_strFile).absolutePath());
+	if(true == QFileInfo::exists(m_strFile)) m_Watcher.addPath(m_strFile);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationReader::onFileChanged()
+{
+	//a file replaced on save is no longer watched, the new one is in place already as the replace is atomic
+	if((false == m_Watcher.files().contains(m_strFile)) && (true == QFileInfo::exists(m_strFile)))
+	{
+		m_Watcher.addPath(m_strFile);
+	}
+
+	m_Timer.start();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationReader::onDirectoryChanged()
+{
+	//while the file is watched, its own changes are reported by onFileChanged()
+	if((true == m_Watcher.files().contains(m_strFile)) || (false == QFileInfo::exists(m_strFile))) return;
+
+	m_Watcher.addPath(m_strFile);
+	m_Timer.start();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationReader::reload()
+{
+	const auto generation = ++m_uGeneration;
+	const auto file = m_strFile;
+
+	m_Pool.start(new PoolTask([=]()
+	{
+		//the file may be caught in the middle of a save, it is parsed again on the next change
+		bool valid = false;
+		const auto stations = readFile(file, &valid);
+
+		if(true == valid) emit stationsRead(generation, stations);
+	}));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationReader::onStationsRead(quint64 generation, QList<StationInformation> stations)
+{
+	//a later change is already being parsed
+	if(generation != m_uGeneration) return;
+
+	if(nullptr != m_Receiver) m_Receiver(stations);
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <functional>
+
+#include <QObject>
+
+#include <QFileSystemWatcher>
+#include <QList>
+#include <QThreadPool>
+#include <QTimer>
+
+#include "StationInformation.h"
+
+/**
+ * @brief The StationReader class reads the stations file and watches it for changes
+ *
+ * When the watched file changes, it is parsed again on a worker thread. Editors often save by replacing the file, so
+ * the file watch is restored after each change. The directory is watched as well, but only to notice the file being
+ * created again after it was deleted, other files written there, e.g. the catalog, do not cause a parse.
+ *
+ * @note The receiver is called on the thread owning the reader, only with the result of the most recent parse.
+ */
+class StationReader : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	typedef std::function<void(QList<StationInformation>)> StationsReceiver;
+
+	/**
+	 * @brief StationReader Default constructor
+	 */
+	explicit StationReader();
+
+	/**
+	 * @brief ~StationReader Drops a pending parse and waits for a running one
+	 */
+	virtual ~StationReader();
+
+	/**
+	 * @brief readFile Import station descriptions from a UTF-8 encoded json file
+	 * @param file The file to import
+	 * @param valid If set, receives false if the file is missing or is no valid json object
+	 * @return The found stations
+	 *
+	 * @note Only the metadata is read, embedded logos and logo files are not decoded here
+	 */
+	static QList<StationInformation> readFile(const QString &file, bool* valid = nullptr);
+
+	/**
+	 * @brief watch Parse the file again whenever it changes
+	 * @param file The stations file
+	 * @param receiver Called with the stations after each change
+	 */
+	void watch(const QString &file, const StationsReceiver &receiver);
+
+signals:
+
+	/**
+	 * @brief stationsRead Emitted from the worker thread when the file was parsed
+	 * @param generation The parse this result belongs to
+	 * @param stations The found stations
+	 */
+	void stationsRead(quint64 generation, QList<StationInformation> stations);
+
+private slots:
+
+	/**
+	 * @brief onFileChanged Restore the file watch if the file was replaced and schedule a parse
+	 */
+	void onFileChanged();
+
+	/**
+	 * @brief onDirectoryChanged Watch the file and schedule a parse if it was created again, ignores all other changes
+	 */
+	void onDirectoryChanged();
+
+	/**
+	 * @brief reload Parse the file on the worker thread
+	 */
+	void reload();
+
+	/**
+	 * @brief onStationsRead Pass the result of the most recent parse to the receiver
+	 * @param generation The parse this result belongs to
+	 * @param stations The found stations
+	 */
+	void onStationsRead(quint64 generation, QList<StationInformation> stations);
+
+private:
+
+	/**
+	 * @brief m_strFile The watched stations file
+	 */
+	QString m_strFile;
+
+	/**
+	 * @brief m_Receiver Called with the stations after each change
+	 */
+	StationsReceiver m_Receiver;
+
+	/**
+	 * @brief m_uGeneration The most recent parse, older results are dropped
+	 */
+	quint64 m_uGeneration;
+
+	/**
+	 * @brief m_Watcher Reports changes of the file and its directory
+	 */
+	QFileSystemWatcher m_Watcher;
+
+	/**
+	 * @brief m_Timer Coalesces the bursts of changes caused by a single save
+	 */
+	QTimer m_Timer;
+
+	/**
+	 * @brief m_Pool The worker thread, declared last so the worker is gone before anything else is destroyed
+	 */
+	QThreadPool m_Pool;
+};
@@ -0,0 +1,50 @@
+#include "StationRegistry.h"
+
+StationRegistry::StationRegistry()
+	: m_iNextId(0)
+	, m_Stations()
+	, m_Ids()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationRegistry::clear()
+{
+	m_Stations.clear();
+	m_Ids.clear();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int StationRegistry::insert(const StationInformation &station)
+{
+	auto id = m_Ids.value(station.m_strDefaultPublisher, -1);
+	if(0 > id)
+	{
+		id = m_iNextId++;
+		m_Ids.insert(station.m_strDefaultPublisher, id);
+	}
+
+	m_Stations.insert(id, std::make_shared<const StationInformation>(station));
+
+	return id;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationRegistry::remove(int id)
+{
+	const auto station = m_Stations.take(id);
+	if(nullptr != station) m_Ids.remove(station->m_strDefaultPublisher);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+int StationRegistry::id(const QString &name) const
+{
+	return m_Ids.value(name, -1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StationRecord StationRegistry::station(int id) const
+{
+	return m_Stations.value(id);
+}
+//----------------------------------------------------------------------------------------------------------------------
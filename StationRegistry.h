@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+
+#include <QHash>
+#include <QString>
+
+#include "StationInformation.h"
+
+/**
+ * @brief StationRecord An immutable station, shared by everyone referring to it
+ */
+typedef std::shared_ptr<const StationInformation> StationRecord;
+
+/**
+ * @brief The StationRegistry class owns all stations and identifies them by stable integer ids
+ *
+ * A station keeps its id as long as it stays in the registry, the ids are not reused. Records are never modified, an
+ * update publishes a new record in place of the old one, so a record once taken stays consistent. The logos are not
+ * part of the records, they are kept by the LogoScaler within its memory budget.
+ *
+ * @note Not thread safe, the registry is used from the gui thread only
+ */
+class StationRegistry
+{
+public:
+
+	/**
+	 * @brief StationRegistry Default constructor
+	 */
+	StationRegistry();
+
+	/**
+	 * @brief clear Remove all stations
+	 */
+	void clear();
+
+	/**
+	 * @brief insert Add a station or replace the record of the station with the same name
+	 * @param station The station
+	 * @return The id of the station
+	 */
+	int insert(const StationInformation &station);
+
+	/**
+	 * @brief remove Remove a station
+	 * @param id The station id
+	 */
+	void remove(int id);
+
+	/**
+	 * @brief id Find a station by name
+	 * @param name The station name
+	 * @return The station id, -1 if there is no such station
+	 */
+	int id(const QString &name) const;
+
+	/**
+	 * @brief station Access the current record of a station
+	 * @param id The station id
+	 * @return The record, nullptr if there is no such station
+	 */
+	StationRecord station(int id) const;
+
+private:
+
+	/**
+	 * @brief m_iNextId The id given to the next new station
+	 */
+	int m_iNextId;
+
+	/**
+	 * @brief m_Stations The current record of each station, keyed by id
+	 */
+	QHash<int, StationRecord> m_Stations;
+
+	/**
+	 * @brief m_Ids The id of each station, keyed by name
+	 */
+	QHash<QString, int> m_Ids;
+};
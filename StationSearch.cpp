@@ -0,0 +1,173 @@
+#include "StationSearch.h"
+
+#include <algorithm>
+
+#include "Tracer.h"
+
+StationSearch::StationSearch()
+	: m_Texts()
+	, m_Postings()
+	, m_strQuery()
+	, m_QueryTrigrams()
+	, m_Counts()
+	, m_Candidates()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationSearch::clear()
+{
+	m_Texts.clear();
+	m_Postings.clear();
+	m_strQuery.clear();
+	m_QueryTrigrams.clear();
+	m_Counts.clear();
+	m_Candidates.clear();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationSearch::addStation(const QStringList &texts)
+{
+	const auto row = m_Texts.size();
+
+	QStringList normalized;
+	for(const auto &text : texts) normalized << normalize(text) + QLatin1Char(' ');
+
+	const auto joined = normalized.join(QLatin1Char('\n'));
+
+	for(auto i = 0; i + 3 <= joined.size(); ++i)
+	{
+		//trigrams spanning two texts would match queries no single text matches
+		if(true == joined.midRef(i, 3).contains(QLatin1Char('\n'))) continue;
+
+		auto &rows = m_Postings[trigram(joined, i)];
+		if((true == rows.isEmpty()) || (row != rows.last())) rows.append(row);
+	}
+
+	m_Texts.append(joined);
+	m_Counts.append(0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QVector<int> StationSearch::search(const QString &query)
+{
+	TRACE_SCOPE("searchStations", "search");
+
+	const auto q = normalize(query);
+
+	//only a grown query can reuse the previous counts
+	int from = 0;
+	if((false == m_strQuery.isEmpty()) && (true == q.startsWith(m_strQuery)))
+	{
+		from = qMax(0, m_strQuery.size() - 2);
+	}
+	else
+	{
+		for(auto row : m_Candidates) m_Counts[row] = 0;
+		m_Candidates.clear();
+		m_QueryTrigrams.clear();
+	}
+
+	m_strQuery = q;
+
+	QVector<int> results;
+	if(true == q.trimmed().isEmpty())
+	{
+		m_strQuery.clear();
+		return results;
+	}
+
+	accumulate(from);
+
+	QVector<QPair<int, int>> ranked;
+
+	//a single character has no trigram, only stations with a word starting with it match
+	if(true == m_QueryTrigrams.isEmpty())
+	{
+		for(auto row = 0; row < m_Texts.size(); ++row)
+		{
+			const auto &text = m_Texts.at(row);
+			if(true == text.contains(q)) ranked.append(qMakePair(text.startsWith(q) ? 1 : 0, row));
+		}
+	}
+	else
+	{
+		//at least half of the trigrams must match, so a typo does not hide the station
+		const auto threshold = (m_QueryTrigrams.size() + 1) / 2;
+
+		for(auto row : m_Candidates)
+		{
+			const auto count = m_Counts.at(row);
+			if(threshold > count) continue;
+
+			const auto &text = m_Texts.at(row);
+
+			auto score = count * 4;
+			if(true == text.contains(q)) score += 2;
+			if(true == text.startsWith(q)) score += 1;
+
+			ranked.append(qMakePair(score, row));
+		}
+	}
+
+	std::sort(ranked.begin(), ranked.end(), [](const QPair<int, int> &a, const QPair<int, int> &b)
+	{
+		return (a.first != b.first) ? (a.first > b.first) : (a.second < b.second);
+	});
+
+	results.reserve(ranked.size());
+	for(const auto &r : ranked) results.append(r.second);
+
+	return results;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString StationSearch::normalize(const QString &text)
+{
+	QString normalized(QLatin1Char(' '));
+	normalized.reserve(text.size() + 1);
+
+	for(const auto &c : text)
+	{
+		if(true == c.isLetterOrNumber())
+		{
+			normalized.append(c.toLower());
+		}
+		else if(QLatin1Char(' ') != normalized.at(normalized.size() - 1))
+		{
+			normalized.append(QLatin1Char(' '));
+		}
+	}
+
+	return normalized;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 StationSearch::trigram(const QString &text, int i)
+{
+	return (static_cast<quint64>(text.at(i).unicode()) << 32) |
+				 (static_cast<quint64>(text.at(i + 1).unicode()) << 16) |
+				 static_cast<quint64>(text.at(i + 2).unicode());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationSearch::accumulate(int from)
+{
+	for(auto i = from; i + 3 <= m_strQuery.size(); ++i)
+	{
+		const auto key = trigram(m_strQuery, i);
+
+		//repeated trigrams in the query are counted once, like in the index
+		if(true == m_QueryTrigrams.contains(key)) continue;
+		m_QueryTrigrams.append(key);
+
+		const auto rows = m_Postings.constFind(key);
+		if(m_Postings.constEnd() == rows) continue;
+
+		for(auto row : rows.value())
+		{
+			if(0 == m_Counts[row]++) m_Candidates.append(row);
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
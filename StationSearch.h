@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief The StationSearch class finds stations by fragments of their name, genre or url
+ *
+ * All texts of a station are normalized to lower case words and indexed by their trigrams. A query matches a station
+ * if at least half of the query trigrams occur in the station texts, so small typos are tolerated. The results are
+ * ranked by the number of matching trigrams, stations containing the query or starting with it come first.
+ *
+ * Searching is incremental: while the query only grows, just the trigrams of the added characters are looked up and
+ * accumulated onto the previous counts.
+ */
+class StationSearch
+{
+public:
+
+	/**
+	 * @brief StationSearch Default constructor
+	 */
+	StationSearch();
+
+	/**
+	 * @brief clear Drop the index
+	 */
+	void clear();
+
+	/**
+	 * @brief addStation Index the texts of a station, the stations must be added in row order
+	 * @param texts The texts to search, the first one is the station name
+	 */
+	void addStation(const QStringList &texts);
+
+	/**
+	 * @brief search Find the stations matching a query
+	 * @param query The query as typed
+	 * @return The matching rows, the best match first. Empty for an empty query
+	 */
+	QVector<int> search(const QString &query);
+
+private:
+
+	/**
+	 * @brief normalize Reduce a text to lower case words separated by single spaces, starting with a space
+	 * @param text The text
+	 * @return The normalized text
+	 */
+	static QString normalize(const QString &text);
+
+	/**
+	 * @brief trigram The trigram starting at a position
+	 * @param text The normalized text
+	 * @param i The position, there must be at least three characters left
+	 * @return The trigram packed into a single key
+	 */
+	static quint64 trigram(const QString &text, int i);
+
+	/**
+	 * @brief accumulate Count the matches of the query trigrams from a position on
+	 * @param from The first trigram position of m_strQuery to look up
+	 */
+	void accumulate(int from);
+
+	/**
+	 * @brief m_Texts The normalized texts of each station, joined by line breaks
+	 */
+	QVector<QString> m_Texts;
+
+	/**
+	 * @brief m_Postings The rows containing each trigram, in ascending order
+	 */
+	QHash<quint64, QVector<int>> m_Postings;
+
+	/**
+	 * @brief m_strQuery The normalized previous query
+	 */
+	QString m_strQuery;
+
+	/**
+	 * @brief m_QueryTrigrams The distinct trigrams of the previous query
+	 */
+	QVector<quint64> m_QueryTrigrams;
+
+	/**
+	 * @brief m_Counts The number of query trigrams found for each station
+	 */
+	QVector<int> m_Counts;
+
+	/**
+	 * @brief m_Candidates The rows with a non zero count
+	 */
+	QVector<int> m_Candidates;
+};
@@ -0,0 +1,151 @@
+#include "StationTile.h"
+
+#include <QPainter>
+#include <QPixmapCache>
+
+#include "Tracer.h"
+
+namespace
+{
+
+//the width of the border in pixels
+const qreal cdBorderWidth = 3.0;
+
+//the radius of the outer border corners in pixels
+const qreal cdBorderRadius = 15.0;
+
+//the border and text color of a tile which is not checked
+const QColor ccAccentNormal = QColor(72, 126, 176);
+
+//the border and text color of a checked tile
+const QColor ccAccentChecked = QColor(255, 255, 255);
+
+//the opacity of the logo or name of an offline station
+const qreal cdOfflineOpacity = 0.35;
+
+//the color of the offline mark
+const QColor ccOfflineMark = QColor(220, 50, 47);
+
+//the diameter of the offline mark in pixels
+const qreal cdOfflineMarkSize = 8.0;
+
+}
+
+StationTile::StationTile(QWidget* parent)
+	: QPushButton(parent)
+	, m_cBackgroundColorNormal(Qt::black)
+	, m_cBackgroundColorChecked(ccAccentNormal)
+	, m_Logo()
+	, m_bOffline(false)
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationTile::setColors(const QColor &normal, const QColor &checked)
+{
+	if((normal == m_cBackgroundColorNormal) && (checked == m_cBackgroundColorChecked)) return;
+
+	m_cBackgroundColorNormal = normal;
+	m_cBackgroundColorChecked = checked;
+
+	update();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationTile::setLogo(const QPixmap &logo)
+{
+	if((true == logo.isNull()) && (true == m_Logo.isNull())) return;
+
+	m_Logo = logo;
+
+	update();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationTile::setOffline(bool offline)
+{
+	if(offline == m_bOffline) return;
+
+	m_bOffline = offline;
+
+	update();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StationTile::paintEvent(QPaintEvent* event)
+{
+	Q_UNUSED(event)
+
+	TRACE_SCOPE("paintStationTile", "paint");
+
+	const auto checked = isChecked();
+
+	QPainter p(this);
+	p.drawPixmap(0, 0, background(checked));
+
+	if(true == m_bOffline) p.setOpacity(cdOfflineOpacity);
+
+	if(false == m_Logo.isNull())
+	{
+		const auto size = m_Logo.size() / m_Logo.devicePixelRatio();
+		const auto x = (width() - size.width()) / 2;
+		const auto y = (height() - size.height()) / 2;
+
+		p.drawPixmap(x, y, m_Logo);
+	}
+	else if(false == text().isEmpty())
+	{
+		p.setPen((true == checked) ? ccAccentChecked : ccAccentNormal);
+		p.setFont(font());
+		p.drawText(rect(), Qt::AlignCenter, text());
+	}
+
+	if(true == m_bOffline)
+	{
+		//the mark sits in the top right corner, inside of the rounded border
+		const auto margin = cdBorderRadius - cdOfflineMarkSize / 2.0;
+
+		p.setOpacity(1.0);
+		p.setRenderHint(QPainter::Antialiasing);
+		p.setPen(Qt::NoPen);
+		p.setBrush(ccOfflineMark);
+		p.drawEllipse(QRectF(width() - margin - cdOfflineMarkSize, margin, cdOfflineMarkSize, cdOfflineMarkSize));
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QPixmap StationTile::background(bool checked) const
+{
+	const auto dpr = devicePixelRatioF();
+	const auto color = (true == checked) ? m_cBackgroundColorChecked : m_cBackgroundColorNormal;
+
+	//tiles of the same size and colors share their backgrounds
+	const auto key = QString("StationTile:%1x%2@%3:%4:%5").arg(width()).arg(height()).arg(dpr)
+											 .arg(checked ? 1 : 0).arg(color.rgba());
+
+	QPixmap pixmap;
+	if(true == QPixmapCache::find(key, &pixmap)) return pixmap;
+
+	TRACE_SCOPE("renderStationTile", "paint");
+
+	pixmap = QPixmap(size() * dpr);
+	pixmap.setDevicePixelRatio(dpr);
+	pixmap.fill(Qt::transparent);
+
+	{
+		QPainter p(&pixmap);
+		p.setRenderHint(QPainter::Antialiasing);
+		p.setPen(QPen((true == checked) ? ccAccentChecked : ccAccentNormal, cdBorderWidth));
+		p.setBrush(color);
+
+		//the pen is centered on the path, the border has to stay inside of the tile
+		const auto inset = cdBorderWidth / 2.0;
+		p.drawRoundedRect(QRectF(rect()).adjusted(inset, inset, -inset, -inset),
+											cdBorderRadius - inset, cdBorderRadius - inset);
+	}
+
+	QPixmapCache::insert(key, pixmap);
+
+	return pixmap;
+}
+//----------------------------------------------------------------------------------------------------------------------
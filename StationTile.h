@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QColor>
+#include <QPixmap>
+#include <QPushButton>
+
+/**
+ * @brief The StationTile class is a station button painted without the style sheet engine
+ *
+ * The tile draws the rounded border, the background color of its state, the station logo or the station name directly
+ * in paintEvent(). The border and background are rendered once per size, state and color into a pixmap shared by all
+ * tiles through QPixmapCache, so a repaint only blits two pixmaps.
+ *
+ * A station whose stream did not answer is flagged offline, its logo or name is dimmed and marked with a red dot.
+ *
+ * @note The text is painted as set, fitting it to the tile is left to the caller
+ */
+class StationTile : public QPushButton
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief StationTile Default constructor
+	 * @param parent The parent widget
+	 */
+	explicit StationTile(QWidget* parent = nullptr);
+
+	/**
+	 * @brief setColors Set the background colors of the station
+	 * @param normal The background color when the tile is not checked
+	 * @param checked The background color when the tile is checked
+	 */
+	void setColors(const QColor &normal, const QColor &checked);
+
+	/**
+	 * @brief setLogo Set the logo shown in place of the text
+	 * @param logo The logo, already scaled to the icon size. The text is shown if the logo is null.
+	 */
+	void setLogo(const QPixmap &logo);
+
+	/**
+	 * @brief setOffline Flag the station as not reachable
+	 * @param offline True if none of the station urls answered their last probe
+	 */
+	void setOffline(bool offline);
+
+protected:
+
+	void paintEvent(QPaintEvent* event) override;
+
+private:
+
+	/**
+	 * @brief background Get the rendered border and background for the current size
+	 * @param checked Which state to render
+	 * @return The background, taken from the pixmap cache if it was rendered before
+	 */
+	QPixmap background(bool checked) const;
+
+	/**
+	 * @brief m_cBackgroundColorNormal The background color when the tile is not checked
+	 */
+	QColor m_cBackgroundColorNormal;
+
+	/**
+	 * @brief m_cBackgroundColorChecked The background color when the tile is checked
+	 */
+	QColor m_cBackgroundColorChecked;
+
+	/**
+	 * @brief m_Logo The logo shown in place of the text, may be null
+	 */
+	QPixmap m_Logo;
+
+	/**
+	 * @brief m_bOffline True if the station is flagged as not reachable
+	 */
+	bool m_bOffline;
+};
@@ -0,0 +1,247 @@
+#include "StreamConnection.h"
+
+#include <QNetworkRequest>
+
+#include "Tracer.h"
+
+namespace
+{
+
+//the delay before the first reconnect, doubled for each further attempt, in milliseconds
+const int ciRetryDelay = 250;
+
+//the longest delay between two reconnects, in milliseconds
+const int ciMaxRetryDelay = 8000;
+
+//a connection which delivered nothing for this long is considered broken, in milliseconds
+const int ciStallTimeout = 10000;
+
+//the socket data kept by the network stack beyond the ring buffer, in bytes
+const qint64 ciReadBufferSize = 16 * 1024;
+
+}
+
+StreamConnection::StreamConnection(const QUrl &url, RingBuffer* buffer)
+	: QObject(nullptr)
+	, m_uUrl(url)
+	, m_pBuffer(buffer)
+	, m_pManager(new QNetworkAccessManager(this))
+	, m_pReply(nullptr)
+	, m_pRetryTimer(new QTimer(this))
+	, m_pStallTimer(new QTimer(this))
+	, m_Demuxer()
+	, m_iRetryDelay(ciRetryDelay)
+	, m_iReceived(0)
+	, m_iSkip(0)
+	, m_bResumable(false)
+	, m_bStopped(false)
+	, m_bWaiting(false)
+	, m_uReconnects(0)
+{
+	m_pRetryTimer->setSingleShot(true);
+	m_pStallTimer->setSingleShot(true);
+	m_pStallTimer->setInterval(ciStallTimeout);
+
+	connect(m_pRetryTimer, &QTimer::timeout, this, &StreamConnection::reconnect);
+	connect(m_pStallTimer, &QTimer::timeout, this, [=]()
+	{
+		if(nullptr != m_pReply) m_pReply->abort();
+	});
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StreamConnection::isWaiting() const
+{
+	return m_bWaiting;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 StreamConnection::reconnects() const
+{
+	return m_uReconnects;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamConnection::setStallTimeout(int milliseconds)
+{
+	m_pStallTimer->setInterval(milliseconds);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamConnection::start()
+{
+	m_bStopped = false;
+	connectStream();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamConnection::stop()
+{
+	m_bStopped = true;
+
+	m_pRetryTimer->stop();
+	m_pStallTimer->stop();
+
+	if(nullptr != m_pReply)
+	{
+		auto reply = m_pReply;
+		m_pReply = nullptr;
+
+		reply->abort();
+		reply->deleteLater();
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamConnection::drain()
+{
+	if(nullptr == m_pReply) return;
+
+	//called again once the consumer made room, the flag is only set again if the buffer is still full
+	m_bWaiting = false;
+
+	char chunk[4096];
+	qint64 written = 0;
+
+	const auto audio = [&](const char* data, qint64 length)
+	{
+		//a server which ignored the range of a resumed request repeats the bytes we already have
+		const auto skipped = qMin(m_iSkip, length);
+		m_iSkip -= skipped;
+
+		written += m_pBuffer->write(data + skipped, length - skipped);
+	};
+
+	const auto metadata = [&](const QVariantMap &m) { emit metadataReceived(m_pBuffer->writePosition(), m); };
+
+	while(0 < m_pReply->bytesAvailable())
+	{
+		auto room = m_pBuffer->free();
+		if(0 == room)
+		{
+			m_bWaiting = true;
+
+			//the consumer may have made room before it could see the flag
+			room = m_pBuffer->free();
+			if(0 == room) break;
+
+			m_bWaiting = false;
+		}
+
+		//the demuxed audio is never larger than the raw stream, so it fits as well
+		const auto count = m_pReply->read(chunk, qMin<qint64>(room, sizeof(chunk)));
+		if(0 >= count) break;
+
+		m_Demuxer.feed(chunk, count, audio, metadata);
+	}
+
+	//a full buffer is no stall, the stream continues once the consumer made room
+	if(true == m_bWaiting) m_pStallTimer->stop();
+	else m_pStallTimer->start();
+
+	if(0 == written) return;
+
+	m_iReceived += written;
+	m_iRetryDelay = ciRetryDelay;
+
+	emit dataReceived();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamConnection::onMetaDataChanged()
+{
+	if(nullptr == m_pReply) return;
+
+	const auto status = m_pReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+	const auto length = m_pReply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+
+	if((206 != status) && (0 < m_iReceived))
+	{
+		//a live stream continues at the current position, a file starts from the beginning again
+		m_iSkip = (true == m_bResumable) ? m_iReceived : 0;
+	}
+
+	const auto metaInterval = m_pReply->rawHeader("icy-metaint").trimmed().toInt();
+
+	//with interleaved metadata the received audio does not tell the byte position in the file
+	if(206 != status)
+	{
+		m_bResumable = (0 < length) && (0 == metaInterval) &&
+									 ("bytes" == m_pReply->rawHeader("Accept-Ranges").trimmed().toLower());
+	}
+
+	m_Demuxer.reset(metaInterval);
+
+	QVariantMap metadata;
+	for(const auto &header : m_pReply->rawHeaderPairs()) IcyDemuxer::parseHeader(header.first, header.second, metadata);
+	if(false == metadata.isEmpty()) emit metadataReceived(m_pBuffer->writePosition(), metadata);
+
+	emit connected(m_pReply->rawHeader("icy-br").split(',').first().trimmed().toInt());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamConnection::onFinished()
+{
+	auto reply = qobject_cast<QNetworkReply*>(sender());
+	if(nullptr == reply) return;
+
+	reply->deleteLater();
+
+	//stop() already dropped the reply
+	if(reply != m_pReply) return;
+
+	//whatever arrived before the connection broke is still played
+	drain();
+
+	m_pReply = nullptr;
+	m_pStallTimer->stop();
+	m_bWaiting = false;
+
+	if(true == m_bStopped) return;
+
+	Tracer::instant("streamDisconnected", "stream", reply->errorString());
+	emit disconnected(reply->errorString());
+
+	m_pRetryTimer->start(m_iRetryDelay);
+	m_iRetryDelay = qMin(m_iRetryDelay * 2, ciMaxRetryDelay);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamConnection::reconnect()
+{
+	if(true == m_bStopped) return;
+
+	++m_uReconnects;
+	connectStream();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamConnection::connectStream()
+{
+	TRACE_SCOPE("connectStream", "stream");
+
+	QNetworkRequest request(m_uUrl);
+	request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+
+	//the titles are interleaved with the audio only on request
+	request.setRawHeader("Icy-MetaData", "1");
+
+	if((true == m_bResumable) && (0 < m_iReceived))
+	{
+		request.setRawHeader("Range", QByteArray("bytes=") + QByteArray::number(m_iReceived) + "-");
+	}
+
+	m_iSkip = 0;
+	m_Demuxer.reset(0);
+	m_pReply = m_pManager->get(request);
+
+	//the network stack must not buffer the stream on its own, otherwise the server is never throttled
+	m_pReply->setReadBufferSize(ciReadBufferSize);
+
+	connect(m_pReply, &QNetworkReply::metaDataChanged, this, &StreamConnection::onMetaDataChanged);
+	connect(m_pReply, &QNetworkReply::readyRead, this, &StreamConnection::drain);
+	connect(m_pReply, &QNetworkReply::finished, this, &StreamConnection::onFinished);
+
+	m_pStallTimer->start();
+}
+//----------------------------------------------------------------------------------------------------------------------
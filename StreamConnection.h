@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+
+#include <QObject>
+
+#include <QByteArray>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTimer>
+#include <QUrl>
+#include <QVariantMap>
+
+#include "IcyDemuxer.h"
+#include "RingBuffer.h"
+
+/**
+ * @brief The StreamConnection class downloads a stream into a ring buffer and reconnects whenever the stream breaks
+ *
+ * The connection lives on the network thread of its StreamReader. A lost connection is retried with a growing delay
+ * until stop() is called. Streams of known length which accept range requests are resumed at the first missing byte,
+ * live streams simply continue at the current position.
+ *
+ * Nothing is read from the socket while the ring buffer is full, so the server is throttled by the TCP flow control.
+ * The consumer calls drain() once it made room.
+ *
+ * The stream is requested with ICY metadata, which is stripped from the audio by an IcyDemuxer. Each metadata change
+ * is reported with the ring buffer position it belongs to, so it can be shown when the audio around it is played.
+ */
+class StreamConnection : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief StreamConnection Default constructor
+	 * @param url The stream url
+	 * @param buffer Receives the stream data, must outlive the connection
+	 */
+	explicit StreamConnection(const QUrl &url, RingBuffer* buffer);
+
+	/**
+	 * @brief isWaiting Check if the connection stopped reading because the ring buffer is full, thread safe
+	 * @return True if drain() must be called after making room
+	 */
+	bool isWaiting() const;
+
+	/**
+	 * @brief reconnects The number of reconnects since the connection was started, thread safe
+	 * @return The reconnect counter
+	 */
+	quint64 reconnects() const;
+
+	/**
+	 * @brief setStallTimeout Set how long a connection may deliver nothing before it is considered broken
+	 * @param milliseconds The timeout, 10 s by default
+	 *
+	 * @note Takes effect the next time data arrives or the ring buffer was drained
+	 */
+	void setStallTimeout(int milliseconds);
+
+public slots:
+
+	/**
+	 * @brief start Connect to the stream
+	 */
+	void start();
+
+	/**
+	 * @brief stop Disconnect and stop reconnecting
+	 */
+	void stop();
+
+	/**
+	 * @brief drain Move the data received so far into the ring buffer, as far as it fits
+	 */
+	void drain();
+
+signals:
+
+	/**
+	 * @brief connected Emitted when the server accepted the request
+	 * @param bitrate The bitrate announced by the server in kbit/s, 0 if unknown
+	 */
+	void connected(int bitrate);
+
+	/**
+	 * @brief dataReceived Emitted when new data was written to the ring buffer
+	 */
+	void dataReceived();
+
+	/**
+	 * @brief metadataReceived Emitted when the response headers or a metadata block of the stream were received
+	 * @param position The ring buffer write position at which the metadata applies
+	 * @param metadata The metadata with lower case keys, see IcyDemuxer
+	 */
+	void metadataReceived(quint64 position, QVariantMap metadata);
+
+	/**
+	 * @brief disconnected Emitted when the connection broke, a reconnect is scheduled
+	 * @param error The reason
+	 */
+	void disconnected(QString error);
+
+private slots:
+
+	/**
+	 * @brief onMetaDataChanged Evaluate the response headers
+	 */
+	void onMetaDataChanged();
+
+	/**
+	 * @brief onFinished Schedule a reconnect, a stream is never expected to end
+	 */
+	void onFinished();
+
+	/**
+	 * @brief reconnect Connect to the stream again
+	 */
+	void reconnect();
+
+private:
+
+	/**
+	 * @brief connectStream Send the request, resuming at the first missing byte if possible
+	 */
+	void connectStream();
+
+	/**
+	 * @brief m_uUrl The stream url
+	 */
+	QUrl m_uUrl;
+
+	/**
+	 * @brief m_pBuffer Receives the stream data
+	 */
+	RingBuffer* m_pBuffer;
+
+	/**
+	 * @brief m_pManager Sends the requests, created as a child so it moves to the network thread with the connection
+	 */
+	QNetworkAccessManager* m_pManager;
+
+	/**
+	 * @brief m_pReply The running request, nullptr while waiting for a reconnect
+	 */
+	QNetworkReply* m_pReply;
+
+	/**
+	 * @brief m_pRetryTimer Delays the next reconnect
+	 */
+	QTimer* m_pRetryTimer;
+
+	/**
+	 * @brief m_pStallTimer Aborts a connection which stopped delivering data
+	 */
+	QTimer* m_pStallTimer;
+
+	/**
+	 * @brief m_Demuxer Strips the metadata blocks from the audio
+	 */
+	IcyDemuxer m_Demuxer;
+
+	/**
+	 * @brief m_iRetryDelay The delay before the next reconnect in milliseconds
+	 */
+	int m_iRetryDelay;
+
+	/**
+	 * @brief m_iReceived The number of stream bytes written to the ring buffer
+	 */
+	qint64 m_iReceived;
+
+	/**
+	 * @brief m_iSkip The number of bytes to drop, when a server ignored the range of a resumed request
+	 */
+	qint64 m_iSkip;
+
+	/**
+	 * @brief m_bResumable True if the stream has a known length and the server accepts range requests
+	 */
+	bool m_bResumable;
+
+	/**
+	 * @brief m_bStopped True once stop() was called, no more reconnects are made
+	 */
+	bool m_bStopped;
+
+	/**
+	 * @brief m_bWaiting True while nothing is read because the ring buffer is full
+	 */
+	std::atomic<bool> m_bWaiting;
+
+	/**
+	 * @brief m_uReconnects The reconnect counter
+	 */
+	std::atomic<quint64> m_uReconnects;
+};
@@ -0,0 +1,395 @@
+#include "StreamReader.h"
+
+#include "StreamConnection.h"
+#include "Tracer.h"
+
+namespace
+{
+
+//the ring buffer is sized for this bitrate, in kbit/s
+const qint64 ciMaxBitrate = 320;
+
+//the bitrate assumed for streams which do not announce one, in kbit/s
+const qint64 ciDefaultBitrate = 128;
+
+//the smallest ring buffer, in bytes
+const qint64 ciMinBufferSize = 64 * 1024;
+
+//the ring buffer is moved into the time shift file in batches of this size, in bytes
+const qint64 ciSpillBatch = 64 * 1024;
+
+}
+
+StreamReader::StreamReader(const QUrl &url, int jitterBuffer, QObject* parent)
+	: QIODevice(parent)
+	, m_uUrl(url)
+	, m_iJitterBuffer(qMax(0, jitterBuffer))
+	, m_iBufferTarget(0)
+	, m_iBitrate(ciDefaultBitrate)
+	, m_iTimeShiftSeconds(0)
+	, m_iTimeShiftSize(0)
+	, m_bPaused(false)
+	, m_bBuffering(true)
+	, m_bConnected(false)
+	, m_uUnderruns(0)
+	, m_MetaData()
+	, m_PendingMetaData()
+	, m_Buffer(qMax(ciMinBufferSize, 2 * m_iJitterBuffer * ciMaxBitrate / 8))
+	, m_TimeShift()
+	, m_baSpill()
+	, m_pConnection(new StreamConnection(url, &m_Buffer))
+	, m_Thread()
+{
+	m_iBufferTarget = qMin(m_iJitterBuffer * ciDefaultBitrate / 8, m_Buffer.capacity() / 2);
+
+	m_Thread.setObjectName("StreamReader");
+	m_pConnection->moveToThread(&m_Thread);
+
+	//the connection signals from the network thread, the player reads on our own thread
+	connect(m_pConnection, &StreamConnection::connected, this, &StreamReader::onConnected, Qt::QueuedConnection);
+	connect(m_pConnection, &StreamConnection::dataReceived, this, &StreamReader::onDataReceived, Qt::QueuedConnection);
+	connect(m_pConnection, &StreamConnection::disconnected, this, &StreamReader::onDisconnected, Qt::QueuedConnection);
+	connect(m_pConnection, &StreamConnection::metadataReceived, this, &StreamReader::onMetadataReceived,
+					Qt::QueuedConnection);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StreamReader::~StreamReader()
+{
+	close();
+
+	//the network thread is gone, nothing touches the connection anymore
+	delete m_pConnection;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::attach(QMediaPlayer* player, const QString &url, int jitterBuffer)
+{
+	auto previous = find(player);
+
+	if(true == url.isEmpty())
+	{
+		player->setMedia(QMediaContent());
+	}
+	else if(0 >= jitterBuffer)
+	{
+		player->setMedia(QMediaContent(QUrl(url)));
+	}
+	else
+	{
+		auto reader = new StreamReader(QUrl(url), jitterBuffer, player);
+		reader->open(QIODevice::ReadOnly);
+
+		//the url only tells the backend what to expect, the data comes from the reader
+		player->setMedia(QMediaContent(QUrl(url)), reader);
+	}
+
+	//the player let go of the previous reader when the new media was set
+	if(nullptr != previous)
+	{
+		previous->setParent(nullptr);
+		previous->close();
+		previous->deleteLater();
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StreamReader* StreamReader::find(const QMediaPlayer* player)
+{
+	return player->findChild<StreamReader*>(QString(), Qt::FindDirectChildrenOnly);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StreamReader::open(OpenMode mode)
+{
+	if(true == isOpen()) return false;
+
+	//the data is only buffered in the ring buffer, QIODevice must not buffer it again
+	if(false == QIODevice::open(mode | QIODevice::Unbuffered)) return false;
+
+	m_bBuffering = true;
+	m_Thread.start();
+	QMetaObject::invokeMethod(m_pConnection, "start", Qt::QueuedConnection);
+
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::close()
+{
+	if(true == m_Thread.isRunning())
+	{
+		QMetaObject::invokeMethod(m_pConnection, "stop", Qt::BlockingQueuedConnection);
+		m_Thread.quit();
+		m_Thread.wait();
+	}
+
+	m_Buffer.clear();
+	m_TimeShift.close();
+	m_bPaused = false;
+	m_bConnected = false;
+	m_PendingMetaData.clear();
+
+	QIODevice::close();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StreamReader::isSequential() const
+{
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StreamReader::atEnd() const
+{
+	//a radio stream does not end, while reconnecting there is just no data yet
+	return (false == isOpen());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 StreamReader::bytesAvailable() const
+{
+	if(true == m_bBuffering) return QIODevice::bytesAvailable();
+
+	return m_TimeShift.size() + m_Buffer.size() + QIODevice::bytesAvailable();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 StreamReader::bufferFill() const
+{
+	return m_Buffer.size();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 StreamReader::bufferTarget() const
+{
+	return m_iBufferTarget;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StreamReader::isBuffering() const
+{
+	return m_bBuffering;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 StreamReader::reconnects() const
+{
+	return m_pConnection->reconnects();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 StreamReader::underruns() const
+{
+	return m_uUnderruns;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::setTimeShift(int seconds, qint64 size)
+{
+	m_iTimeShiftSeconds = qMax(0, seconds);
+	m_iTimeShiftSize = qMax<qint64>(0, size);
+
+	//the file is created again with the new size at the next pause
+	if(false == isTimeShifted()) m_TimeShift.close();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StreamReader::pause()
+{
+	if((false == isOpen()) || (0 == m_iTimeShiftSeconds) || (0 == m_iTimeShiftSize)) return false;
+
+	if(false == m_TimeShift.isOpen())
+	{
+		const auto capacity = qMin(m_iTimeShiftSize, m_iTimeShiftSeconds * m_iBitrate * 1000 / 8);
+		if(false == m_TimeShift.open(capacity))
+		{
+			Tracer::instant("timeShiftFailed", "stream", m_uUrl.toString());
+			return false;
+		}
+	}
+
+	m_bPaused = true;
+	spill();
+
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::resume()
+{
+	m_bPaused = false;
+
+	if(0 < bytesAvailable()) emit readyRead();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::jumpToLive()
+{
+	m_bPaused = false;
+	m_TimeShift.clear();
+
+	//the titles sent during the skipped audio are caught up at once
+	if(false == m_PendingMetaData.isEmpty()) publishMetadata();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StreamReader::isTimeShifted() const
+{
+	return (true == m_bPaused) || (0 < m_TimeShift.size());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 StreamReader::timeShift() const
+{
+	return (m_TimeShift.size() + m_Buffer.size()) * 8 / m_iBitrate;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QVariant StreamReader::metaData(const QString &key) const
+{
+	return m_MetaData.value(key);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QStringList StreamReader::availableMetaData() const
+{
+	return m_MetaData.keys();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 StreamReader::readData(char* data, qint64 maxSize)
+{
+	if(true == m_bBuffering) return 0;
+
+	//the time shift file holds the older audio, the ring buffer is only read once the file is empty
+	auto count = m_TimeShift.read(data, maxSize);
+	count += m_Buffer.read(data + count, maxSize - count);
+
+	if(false == m_PendingMetaData.isEmpty()) publishMetadata();
+
+	//running empty while the stream is down means the outage outlasted the buffer, it is refilled before playing on
+	if((0 == m_Buffer.size()) && (0 == m_TimeShift.size()) && (false == m_bConnected))
+	{
+		Tracer::instant("streamUnderrun", "stream", m_uUrl.toString());
+
+		m_bBuffering = true;
+		++m_uUnderruns;
+	}
+
+	if((0 < count) && (true == m_pConnection->isWaiting()))
+	{
+		QMetaObject::invokeMethod(m_pConnection, "drain", Qt::QueuedConnection);
+	}
+
+	return count;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 StreamReader::writeData(const char* data, qint64 maxSize)
+{
+	Q_UNUSED(data)
+	Q_UNUSED(maxSize)
+
+	return -1;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::onConnected(int bitrate)
+{
+	m_bConnected = true;
+
+	m_iBitrate = (0 < bitrate) ? static_cast<qint64>(bitrate) : ciDefaultBitrate;
+
+	//the buffer must be able to hold the target with room to spare, or filling it would never finish
+	m_iBufferTarget = qMin(m_iJitterBuffer * m_iBitrate / 8, m_Buffer.capacity() / 2);
+
+	onDataReceived();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::onDataReceived()
+{
+	if(false == isOpen()) return;
+
+	spill();
+
+	if(true == m_bBuffering)
+	{
+		if(m_iBufferTarget > m_TimeShift.size() + m_Buffer.size()) return;
+
+		Tracer::instant("streamBuffered", "stream", m_uUrl.toString());
+		m_bBuffering = false;
+	}
+
+	if((false == m_bPaused) && (0 < bytesAvailable())) emit readyRead();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::onMetadataReceived(quint64 position, QVariantMap metadata)
+{
+	m_PendingMetaData.append(qMakePair(position, metadata));
+	publishMetadata();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::publishMetadata()
+{
+	//the audio moved into the time shift file has not been played yet
+	const auto position = m_Buffer.readPosition() - static_cast<quint64>(m_TimeShift.size());
+
+	auto changed = false;
+	while((false == m_PendingMetaData.isEmpty()) && (m_PendingMetaData.first().first <= position))
+	{
+		const auto metadata = m_PendingMetaData.takeFirst().second;
+		for(auto it = metadata.constBegin(); it != metadata.constEnd(); ++it)
+		{
+			if(it.value() == m_MetaData.value(it.key())) continue;
+
+			m_MetaData.insert(it.key(), it.value());
+			changed = true;
+		}
+	}
+
+	if(false == changed) return;
+
+	Tracer::instant("streamMetadata", "metadata", m_MetaData.value("title").toString());
+	emit metaDataChanged();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::spill()
+{
+	if((false == isTimeShifted()) || (false == m_TimeShift.isOpen())) return;
+
+	//the network chunks are collected in the ring buffer, the file is only written in large sequential batches
+	const auto batch = qMin(ciSpillBatch, m_Buffer.capacity() / 2);
+	if(batch > m_Buffer.size()) return;
+
+	TRACE_SCOPE("spillTimeShift", "stream");
+
+	m_baSpill.resize(static_cast<int>(batch));
+	while(batch <= m_Buffer.size())
+	{
+		const auto count = m_Buffer.read(m_baSpill.data(), batch);
+		m_TimeShift.write(m_baSpill.constData(), count);
+	}
+
+	if(true == m_pConnection->isWaiting())
+	{
+		QMetaObject::invokeMethod(m_pConnection, "drain", Qt::QueuedConnection);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamReader::onDisconnected()
+{
+	m_bConnected = false;
+
+	if((false == m_bBuffering) && (0 == m_Buffer.size()) && (0 == m_TimeShift.size()))
+	{
+		m_bBuffering = true;
+		++m_uUnderruns;
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <QIODevice>
+
+#include <QList>
+#include <QMediaPlayer>
+#include <QPair>
+#include <QStringList>
+#include <QThread>
+#include <QUrl>
+#include <QVariantMap>
+
+#include "RingBuffer.h"
+#include "TimeShiftFile.h"
+
+class StreamConnection;
+
+/**
+ * @brief The StreamReader class feeds a network stream to a QMediaPlayer through a jitter buffer
+ *
+ * The stream is downloaded on a network thread into a lock-free ring buffer and read by the player through this
+ * device. Playback only starts once the jitter buffer is filled, so short network drops are bridged by the buffered
+ * data. A broken connection is reconnected transparently, the player never sees the end of the stream. If the buffer
+ * ran empty while reconnecting, the jitter buffer is filled again before the player gets more data.
+ *
+ * The ICY metadata of the stream is demuxed by the reader itself, independent of the media backend. A title change is
+ * published as soon as the player read the audio up to the position the title was sent at.
+ *
+ * With time shifting enabled, pause() keeps the stream running. The audio the player does not read meanwhile is moved
+ * from the ring buffer into a TimeShiftFile in large batches, and played from there after resume() until the player
+ * caught up or jumpToLive() dropped the backlog.
+ *
+ * @note The reader is meant to be owned by its player, see attach()
+ */
+class StreamReader : public QIODevice
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief StreamReader Default constructor, call open() to connect
+	 * @param url The stream url
+	 * @param jitterBuffer The amount of audio to buffer before playing in milliseconds
+	 * @param parent The owner, usually the player
+	 */
+	explicit StreamReader(const QUrl &url, int jitterBuffer, QObject* parent = nullptr);
+
+	/**
+	 * @brief ~StreamReader Disconnects and waits for the network thread
+	 */
+	virtual ~StreamReader();
+
+	/**
+	 * @brief attach Let a player play a url, through a new stream reader owned by the player
+	 * @param player The player
+	 * @param url The media url, empty to clear the media
+	 * @param jitterBuffer The jitter buffer in milliseconds, 0 to let the player connect to the url itself
+	 *
+	 * @note The reader the player used before is closed and deleted
+	 */
+	static void attach(QMediaPlayer* player, const QString &url, int jitterBuffer);
+
+	/**
+	 * @brief find Get the stream reader a player is currently reading from
+	 * @param player The player
+	 * @return The reader, nullptr if the player connects to its url itself
+	 */
+	static StreamReader* find(const QMediaPlayer* player);
+
+	bool open(OpenMode mode) override;
+	void close() override;
+	bool isSequential() const override;
+	bool atEnd() const override;
+	qint64 bytesAvailable() const override;
+
+	/**
+	 * @brief bufferFill The amount of stream data waiting to be played
+	 * @return The fill level in bytes
+	 */
+	qint64 bufferFill() const;
+
+	/**
+	 * @brief bufferTarget The fill level the jitter buffer is filled to before playback starts
+	 * @return The target in bytes, derived from the jitter buffer duration and the stream bitrate
+	 */
+	qint64 bufferTarget() const;
+
+	/**
+	 * @brief isBuffering Check if the jitter buffer is being filled
+	 * @return True while the player is held back
+	 */
+	bool isBuffering() const;
+
+	/**
+	 * @brief reconnects The number of reconnects since the reader was opened
+	 * @return The reconnect counter
+	 */
+	quint64 reconnects() const;
+
+	/**
+	 * @brief underruns The number of times the buffer ran empty while reconnecting
+	 * @return The underrun counter
+	 */
+	quint64 underruns() const;
+
+	/**
+	 * @brief setTimeShift Configure how much audio is kept while paused, both limits apply
+	 * @param seconds The longest time shift in seconds, 0 disables time shifting
+	 * @param size The largest time shift file in bytes, 0 disables time shifting
+	 *
+	 * @note Takes effect with the next pause()
+	 */
+	void setTimeShift(int seconds, qint64 size);
+
+	/**
+	 * @brief pause Keep receiving the stream into the time shift file until resume() is called
+	 * @return False if time shifting is disabled or the file could not be created, the player must stop then
+	 */
+	bool pause();
+
+	/**
+	 * @brief resume Let the player continue where it paused
+	 */
+	void resume();
+
+	/**
+	 * @brief jumpToLive Drop the audio kept in the time shift file, the player continues with the live stream
+	 */
+	void jumpToLive();
+
+	/**
+	 * @brief isTimeShifted Check if the player is behind the live stream
+	 * @return True while paused or while audio from the time shift file is played
+	 */
+	bool isTimeShifted() const;
+
+	/**
+	 * @brief timeShift How far the player is behind the live stream
+	 * @return The delay in milliseconds, estimated from the stream bitrate
+	 */
+	qint64 timeShift() const;
+
+	/**
+	 * @brief metaData Get a metadata value of the stream
+	 * @param key The lower case key, see IcyDemuxer
+	 * @return The value, invalid if the stream did not send it
+	 */
+	QVariant metaData(const QString &key) const;
+
+	/**
+	 * @brief availableMetaData The keys of all metadata values sent by the stream
+	 * @return The lower case keys
+	 */
+	QStringList availableMetaData() const;
+
+signals:
+
+	/**
+	 * @brief metaDataChanged Emitted when the player reached audio with new metadata
+	 */
+	void metaDataChanged();
+
+protected:
+
+	qint64 readData(char* data, qint64 maxSize) override;
+	qint64 writeData(const char* data, qint64 maxSize) override;
+
+private slots:
+
+	/**
+	 * @brief onConnected Derive the jitter buffer size from the bitrate of the stream
+	 * @param bitrate The bitrate announced by the server in kbit/s, 0 if unknown
+	 */
+	void onConnected(int bitrate);
+
+	/**
+	 * @brief onDataReceived Tell the player about new data, unless the jitter buffer is still being filled
+	 */
+	void onDataReceived();
+
+	/**
+	 * @brief onMetadataReceived Queue metadata until the player reached its position
+	 * @param position The ring buffer position at which the metadata applies
+	 * @param metadata The metadata
+	 */
+	void onMetadataReceived(quint64 position, QVariantMap metadata);
+
+	/**
+	 * @brief onDisconnected Remember that the stream is down, so running empty starts buffering again
+	 */
+	void onDisconnected();
+
+private:
+
+	/**
+	 * @brief publishMetadata Publish the queued metadata the player has reached
+	 */
+	void publishMetadata();
+
+	/**
+	 * @brief spill Move the ring buffer into the time shift file while the player is behind the live stream
+	 */
+	void spill();
+
+	/**
+	 * @brief m_uUrl The stream url
+	 */
+	QUrl m_uUrl;
+
+	/**
+	 * @brief m_iJitterBuffer The amount of audio to buffer before playing in milliseconds
+	 */
+	int m_iJitterBuffer;
+
+	/**
+	 * @brief m_iBufferTarget The jitter buffer in bytes
+	 */
+	qint64 m_iBufferTarget;
+
+	/**
+	 * @brief m_iBitrate The bitrate of the stream in kbit/s
+	 */
+	qint64 m_iBitrate;
+
+	/**
+	 * @brief m_iTimeShiftSeconds The longest time shift in seconds
+	 */
+	int m_iTimeShiftSeconds;
+
+	/**
+	 * @brief m_iTimeShiftSize The largest time shift file in bytes
+	 */
+	qint64 m_iTimeShiftSize;
+
+	/**
+	 * @brief m_bPaused True while the player is paused and the stream is kept in the time shift file
+	 */
+	bool m_bPaused;
+
+	/**
+	 * @brief m_bBuffering True while the jitter buffer is being filled
+	 */
+	bool m_bBuffering;
+
+	/**
+	 * @brief m_bConnected True while the connection delivers data
+	 */
+	bool m_bConnected;
+
+	/**
+	 * @brief m_uUnderruns The underrun counter
+	 */
+	quint64 m_uUnderruns;
+
+	/**
+	 * @brief m_MetaData The metadata of the audio played
+	 */
+	QVariantMap m_MetaData;
+
+	/**
+	 * @brief m_PendingMetaData The metadata received ahead of the audio played, with the position it applies at
+	 */
+	QList<QPair<quint64, QVariantMap>> m_PendingMetaData;
+
+	/**
+	 * @brief m_Buffer The data received but not yet read by the player
+	 */
+	RingBuffer m_Buffer;
+
+	/**
+	 * @brief m_TimeShift The audio the player fell behind the ring buffer, older than anything in the ring buffer
+	 */
+	TimeShiftFile m_TimeShift;
+
+	/**
+	 * @brief m_baSpill The batch moved from the ring buffer into the time shift file
+	 */
+	QByteArray m_baSpill;
+
+	/**
+	 * @brief m_pConnection Downloads the stream on the network thread
+	 */
+	StreamConnection* m_pConnection;
+
+	/**
+	 * @brief m_Thread The network thread
+	 */
+	QThread m_Thread;
+};
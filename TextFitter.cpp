@@ -0,0 +1,104 @@
+#include "TextFitter.h"
+
+#include <QFontMetrics>
+#include <QtMath>
+
+#include "Tracer.h"
+
+namespace
+{
+
+//the resolution of the binary search, in steps per point
+const int ciStepsPerPoint = 2;
+
+}
+
+TextFitter::TextFitter(int capacity, double minimumPointSize)
+	: m_dMinimumPointSize(minimumPointSize)
+	, m_uHits(0)
+	, m_uMisses(0)
+	, m_Cache(capacity)
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+TextFitter::Fit TextFitter::fit(const QString &text, const QFont &font, const QSize &size, double fraction)
+{
+	//nothing to measure, keep the current font
+	if((true == text.isEmpty()) || (true == size.isEmpty())) return Fit{font, text};
+
+	//we use only a fraction of the available width and height
+	const int width = fraction * size.width();
+	const int height = fraction * size.height();
+
+	//the size is not part of the key, the result is independent of the font size we start from
+	auto base = font;
+	base.setPointSizeF(m_dMinimumPointSize);
+
+	const auto key = text + QLatin1Char('\n') + base.toString() + QLatin1Char('\n') +
+									 QString::number(width) + QLatin1Char('x') + QString::number(height);
+
+	if(const auto cached = m_Cache.object(key))
+	{
+		++m_uHits;
+		return *cached;
+	}
+
+	++m_uMisses;
+
+	const auto result = measure(text, base, width, height);
+	m_Cache.insert(key, new Fit(result));
+
+	return result;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 TextFitter::hits() const
+{
+	return m_uHits;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 TextFitter::misses() const
+{
+	return m_uMisses;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+TextFitter::Fit TextFitter::measure(const QString &text, const QFont &font, int width, int height) const
+{
+	TRACE_SCOPE("TextFitter::measure", "text");
+
+	auto f = font;
+
+	auto fits = [&](int steps)
+	{
+		f.setPointSizeF((1.0 * steps) / ciStepsPerPoint);
+
+		QFontMetrics fm(f);
+		return (fm.width(text) <= width) && (fm.height() <= height);
+	};
+
+	//a point is never smaller than a pixel, so the height in pixels is a safe upper bound for the point size
+	int low = qCeil(m_dMinimumPointSize * ciStepsPerPoint);
+	int high = qMax(low, height * ciStepsPerPoint);
+
+	if(false == fits(low))
+	{
+		f.setPointSizeF((1.0 * low) / ciStepsPerPoint);
+		return Fit{f, QFontMetrics(f).elidedText(text, Qt::ElideRight, width)};
+	}
+
+	//find the largest size which fits, low always fits
+	while(low < high)
+	{
+		const int middle = low + (high - low + 1) / 2;
+
+		if(true == fits(middle)) low = middle;
+		else high = middle - 1;
+	}
+
+	f.setPointSizeF((1.0 * low) / ciStepsPerPoint);
+	return Fit{f, text};
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QCache>
+#include <QFont>
+#include <QSize>
+#include <QString>
+
+/**
+ * @brief The TextFitter class finds the largest font size for which a text fits into a rectangle
+ *
+ * The point size is found by a binary search against the real font metrics. Results are memoized by text, font and
+ * rectangle size in a bounded cache, so fitting a text which was seen recently costs a single lookup. If the text does
+ * not even fit at the minimum point size, it is elided.
+ */
+class TextFitter
+{
+public:
+
+	/**
+	 * @brief The Fit struct describes the result of a fit
+	 */
+	struct Fit
+	{
+		//! The font to use
+		QFont m_Font;
+
+		//! The text to display, elided if it did not fit at the minimum point size
+		QString m_strText;
+	};
+
+	/**
+	 * @brief TextFitter Default constructor
+	 * @param capacity The maximum number of memoized fits
+	 * @param minimumPointSize The smallest point size to use before the text is elided
+	 */
+	explicit TextFitter(int capacity = 256, double minimumPointSize = 6.0);
+
+	/**
+	 * @brief fit Find the largest font for a text
+	 * @param text The text to fit
+	 * @param font The font to start from, only the size is changed
+	 * @param size The size of the container
+	 * @param fraction The fraction of the container width and height the text may use
+	 * @return The font and the text to use
+	 */
+	Fit fit(const QString &text, const QFont &font, const QSize &size, double fraction = 0.9);
+
+	/**
+	 * @brief hits The number of fits served from the cache
+	 * @return The hit counter
+	 */
+	quint64 hits() const;
+
+	/**
+	 * @brief misses The number of fits which had to be measured
+	 * @return The miss counter
+	 */
+	quint64 misses() const;
+
+private:
+
+	/**
+	 * @brief measure Perform the binary search for a text
+	 * @param text The text to fit
+	 * @param font The font to start from
+	 * @param width The available width
+	 * @param height The available height
+	 * @return The font and the text to use
+	 */
+	Fit measure(const QString &text, const QFont &font, int width, int height) const;
+
+	/**
+	 * @brief m_dMinimumPointSize The smallest point size to use before the text is elided
+	 */
+	const double m_dMinimumPointSize;
+
+	/**
+	 * @brief m_uHits The hit counter
+	 */
+	quint64 m_uHits;
+
+	/**
+	 * @brief m_uMisses The miss counter
+	 */
+	quint64 m_uMisses;
+
+	/**
+	 * @brief m_Cache The memoized fits, the least recently used ones are dropped first
+	 */
+	QCache<QString, Fit> m_Cache;
+};
@@ -0,0 +1,135 @@
+#include "TimeShiftFile.h"
+
+#include <cstring>
+
+#include <QDir>
+#include <QStandardPaths>
+
+#include "Tracer.h"
+
+TimeShiftFile::TimeShiftFile()
+	: m_pFile(nullptr)
+	, m_pData(nullptr)
+	, m_iCapacity(0)
+	, m_iReadPosition(0)
+	, m_iWritePosition(0)
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+TimeShiftFile::~TimeShiftFile()
+{
+	close();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool TimeShiftFile::open(qint64 capacity)
+{
+	TRACE_SCOPE("openTimeShift", "stream");
+
+	close();
+
+	if(0 >= capacity) return false;
+
+	const QDir directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+	if(false == directory.mkpath(".")) return false;
+
+	m_pFile = new QTemporaryFile(directory.filePath("timeshift-XXXXXX.ring"));
+
+	//the full size is allocated once, so writing never grows the file
+	if((true == m_pFile->open()) && (true == m_pFile->resize(capacity))) m_pData = m_pFile->map(0, capacity);
+
+	if(nullptr == m_pData)
+	{
+		close();
+		return false;
+	}
+
+	m_iCapacity = capacity;
+
+	return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void TimeShiftFile::close()
+{
+	if(nullptr != m_pData) m_pFile->unmap(m_pData);
+
+	//the temporary file removes itself
+	delete m_pFile;
+
+	m_pFile = nullptr;
+	m_pData = nullptr;
+	m_iCapacity = 0;
+	m_iReadPosition = 0;
+	m_iWritePosition = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool TimeShiftFile::isOpen() const
+{
+	return nullptr != m_pData;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 TimeShiftFile::capacity() const
+{
+	return m_iCapacity;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 TimeShiftFile::size() const
+{
+	return m_iWritePosition - m_iReadPosition;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 TimeShiftFile::write(const char* data, qint64 length)
+{
+	if(nullptr == m_pData) return 0;
+
+	//only the newest data fits, there is no point in copying the rest
+	if(length > m_iCapacity)
+	{
+		data += length - m_iCapacity;
+		m_iWritePosition += length - m_iCapacity;
+		length = m_iCapacity;
+	}
+
+	const auto index = m_iWritePosition % m_iCapacity;
+	const auto first = qMin(length, m_iCapacity - index);
+
+	std::memcpy(m_pData + index, data, static_cast<size_t>(first));
+	std::memcpy(m_pData, data + first, static_cast<size_t>(length - first));
+
+	m_iWritePosition += length;
+
+	const auto overwritten = qMax<qint64>(0, size() - m_iCapacity);
+	m_iReadPosition += overwritten;
+
+	return overwritten;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 TimeShiftFile::read(char* data, qint64 length)
+{
+	const auto count = qMin(length, size());
+	if(0 >= count) return 0;
+
+	const auto index = m_iReadPosition % m_iCapacity;
+	const auto first = qMin(count, m_iCapacity - index);
+
+	std::memcpy(data, m_pData + index, static_cast<size_t>(first));
+	std::memcpy(data + first, m_pData, static_cast<size_t>(count - first));
+
+	m_iReadPosition += count;
+
+	return count;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void TimeShiftFile::clear()
+{
+	m_iReadPosition = m_iWritePosition;
+}
+//----------------------------------------------------------------------------------------------------------------------
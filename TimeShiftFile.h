@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QTemporaryFile>
+
+/**
+ * @brief The TimeShiftFile class is a ring buffer in a memory mapped temporary file
+ *
+ * It keeps the audio received while the playback is paused. The file is created with its full size when opened and
+ * written strictly sequentially, wrapping around at its end. When it is full, the oldest data is overwritten. Writing
+ * only copies into the mapping, the kernel writes the dirty pages back in large sequential chunks.
+ *
+ * @note Not thread safe, the file is used from the thread owning the StreamReader only
+ */
+class TimeShiftFile
+{
+public:
+
+	/**
+	 * @brief TimeShiftFile Default constructor, no file is opened
+	 */
+	TimeShiftFile();
+
+	/**
+	 * @brief ~TimeShiftFile Unmaps and removes the file
+	 */
+	~TimeShiftFile();
+
+	/**
+	 * @brief open Create and map the file, closes the previous file
+	 * @param capacity The size of the file in bytes
+	 * @return True if the file was created and mapped
+	 *
+	 * @note The file is created in the cache location, it is removed when closed
+	 */
+	bool open(qint64 capacity);
+
+	/**
+	 * @brief close Unmap and remove the file
+	 */
+	void close();
+
+	/**
+	 * @brief isOpen Check if the file is mapped
+	 * @return True if the file is mapped
+	 */
+	bool isOpen() const;
+
+	/**
+	 * @brief capacity The number of bytes the file holds at most
+	 * @return The capacity in bytes, 0 if no file is mapped
+	 */
+	qint64 capacity() const;
+
+	/**
+	 * @brief size The number of bytes written and not read yet
+	 * @return The fill level in bytes
+	 */
+	qint64 size() const;
+
+	/**
+	 * @brief write Append data, overwriting the oldest data if the file is full
+	 * @param data The data
+	 * @param length The number of bytes to append
+	 * @return The number of bytes of old data which were overwritten
+	 */
+	qint64 write(const char* data, qint64 length);
+
+	/**
+	 * @brief read Take data from the front
+	 * @param data Receives the data
+	 * @param length The maximum number of bytes to take
+	 * @return The number of bytes taken
+	 */
+	qint64 read(char* data, qint64 length);
+
+	/**
+	 * @brief clear Drop all data, the file stays mapped
+	 */
+	void clear();
+
+private:
+
+	/**
+	 * @brief m_pFile The temporary file, a new one is created for each open(), nullptr if no file is open
+	 */
+	QTemporaryFile* m_pFile;
+
+	/**
+	 * @brief m_pData The mapped file, nullptr if no file is mapped
+	 */
+	uchar* m_pData;
+
+	/**
+	 * @brief m_iCapacity The size of the file in bytes
+	 */
+	qint64 m_iCapacity;
+
+	/**
+	 * @brief m_iReadPosition The number of bytes read or overwritten so far
+	 */
+	qint64 m_iReadPosition;
+
+	/**
+	 * @brief m_iWritePosition The number of bytes written so far
+	 */
+	qint64 m_iWritePosition;
+};
@@ -0,0 +1,239 @@
+#include "Tracer.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+namespace
+{
+
+//the number of events kept, once reached each new event replaces the oldest one
+const int ciMaxEvents = 256 * 1024;
+
+/**
+ * @brief The TraceEvent struct holds a single recorded event
+ */
+struct TraceEvent
+{
+	char m_cPhase;
+	const char* m_pName;
+	const char* m_pCategory;
+	qint64 m_iTimestamp;
+	qint64 m_iDuration;
+	quint64 m_uId;
+	int m_iThread;
+	QString m_strDetail;
+};
+
+/**
+ * @brief The TraceState struct holds everything recorded while tracing
+ */
+struct TraceState
+{
+	QMutex m_Mutex;
+	QString m_strFile;
+	QElapsedTimer m_Clock;
+	QVector<TraceEvent> m_Events;
+	int m_iOldest;
+	quint64 m_uDropped;
+	QHash<Qt::HANDLE, int> m_Threads;
+	int m_iMainThread;
+};
+
+TraceState& State()
+{
+	static TraceState state;
+	return state;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+std::atomic<bool> Tracer::s_bEnabled(false);
+std::atomic<Tracer::ScopeEnter> Tracer::s_pScopeEnter(nullptr);
+std::atomic<Tracer::ScopeLeave> Tracer::s_pScopeLeave(nullptr);
+
+void Tracer::start(const QString &file)
+{
+	auto &state = State();
+
+	QMutexLocker lock(&state.m_Mutex);
+	state.m_strFile = file;
+	state.m_Events.clear();
+	state.m_Events.reserve(16 * 1024);
+	state.m_iOldest = 0;
+	state.m_uDropped = 0;
+	state.m_Threads.clear();
+	state.m_iMainThread = -1;
+	state.m_Clock.start();
+
+	s_bEnabled.store(true);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Tracer::stop()
+{
+	auto &state = State();
+
+	QMutexLocker lock(&state.m_Mutex);
+	if(false == s_bEnabled.exchange(false)) return false;
+
+	QJsonArray events;
+
+	for(auto it = state.m_Threads.cbegin(); it != state.m_Threads.cend(); ++it)
+	{
+		const auto isMain = (state.m_iMainThread == it.value());
+
+		QJsonObject args;
+		args.insert("name", (true == isMain) ? QStringLiteral("main") : QString("worker %1").arg(it.value()));
+
+		QJsonObject event;
+		event.insert("ph", "M");
+		event.insert("name", "thread_name");
+		event.insert("pid", static_cast<double>(QCoreApplication::applicationPid()));
+		event.insert("tid", it.value());
+		event.insert("args", args);
+
+		events.append(event);
+	}
+
+	//oldest first, once the buffer wrapped around the oldest event is not the first one
+	for(auto i = 0; i < state.m_Events.size(); ++i)
+	{
+		const auto &e = state.m_Events.at((state.m_iOldest + i) % state.m_Events.size());
+
+		QJsonObject event;
+		event.insert("ph", QString(QLatin1Char(e.m_cPhase)));
+		event.insert("name", QString::fromLatin1(e.m_pName));
+		event.insert("cat", QString::fromLatin1(e.m_pCategory));
+		event.insert("ts", static_cast<double>(e.m_iTimestamp));
+		event.insert("pid", static_cast<double>(QCoreApplication::applicationPid()));
+		event.insert("tid", e.m_iThread);
+
+		if('X' == e.m_cPhase) event.insert("dur", static_cast<double>(e.m_iDuration));
+		if(('b' == e.m_cPhase) || ('e' == e.m_cPhase)) event.insert("id", QString::number(e.m_uId, 16));
+		if('i' == e.m_cPhase) event.insert("s", "t");
+
+		if(false == e.m_strDetail.isEmpty())
+		{
+			QJsonObject args;
+			args.insert("detail", e.m_strDetail);
+			event.insert("args", args);
+		}
+
+		events.append(event);
+	}
+
+	state.m_Events.clear();
+
+	QJsonObject trace;
+	trace.insert("traceEvents", events);
+	trace.insert("displayTimeUnit", "ms");
+
+	if(0 < state.m_uDropped)
+	{
+		QJsonObject otherData;
+		otherData.insert("droppedEvents", static_cast<double>(state.m_uDropped));
+		trace.insert("otherData", otherData);
+	}
+
+	QFile f(state.m_strFile);
+	if(false == f.open(QFile::WriteOnly)) return false;
+
+	return (0 < f.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void Tracer::setScopeHooks(ScopeEnter enter, ScopeLeave leave)
+{
+	//a region running meanwhile may see the new enter hook, so the leave hook is set first and removed last
+	if(nullptr != enter) s_pScopeLeave.store(leave);
+	s_pScopeEnter.store(enter);
+	if(nullptr == enter) s_pScopeLeave.store(nullptr);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 Tracer::now()
+{
+	return State().m_Clock.nsecsElapsed() / 1000;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void Tracer::complete(const char* name, const char* category, qint64 start, const QString &detail)
+{
+	if(false == isEnabled()) return;
+
+	record('X', name, category, start, now() - start, 0, detail);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void Tracer::instant(const char* name, const char* category, const QString &detail)
+{
+	if(false == isEnabled()) return;
+
+	record('i', name, category, now(), 0, 0, detail);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void Tracer::asyncBegin(const char* name, const char* category, quint64 id, const QString &detail)
+{
+	if(false == isEnabled()) return;
+
+	record('b', name, category, now(), 0, id, detail);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void Tracer::asyncEnd(const char* name, const char* category, quint64 id)
+{
+	if(false == isEnabled()) return;
+
+	record('e', name, category, now(), 0, id, QString());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void Tracer::record(char phase, const char* name, const char* category, qint64 timestamp, qint64 duration, quint64 id,
+										const QString &detail)
+{
+	auto &state = State();
+
+	QMutexLocker lock(&state.m_Mutex);
+
+	//tracing may have been stopped while waiting for the lock
+	if(false == isEnabled()) return;
+
+	const auto handle = QThread::currentThreadId();
+	auto thread = state.m_Threads.find(handle);
+	if(state.m_Threads.end() == thread)
+	{
+		thread = state.m_Threads.insert(handle, state.m_Threads.size());
+
+		//a worker may record its first event before the gui thread does
+		const auto application = QCoreApplication::instance();
+		if((nullptr != application) && (application->thread() == QThread::currentThread()))
+		{
+			state.m_iMainThread = thread.value();
+		}
+	}
+
+	const TraceEvent event{phase, name, category, timestamp, duration, id, thread.value(), detail};
+
+	//long traces keep their most recent part instead of growing without bounds
+	if(ciMaxEvents > state.m_Events.size())
+	{
+		state.m_Events.append(event);
+		return;
+	}
+
+	state.m_Events[state.m_iOldest] = event;
+	state.m_iOldest = (state.m_iOldest + 1) % ciMaxEvents;
+	++state.m_uDropped;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+
+#include <QString>
+
+/**
+ * @brief The Tracer class records scoped spans and instant events and writes them in the Chrome trace event format
+ *
+ * The resulting file can be opened in chrome://tracing or ui.perfetto.dev. While tracing is disabled each trace point
+ * costs a single relaxed atomic load. The number of recorded events is limited, once the limit is reached the oldest
+ * events are dropped and their number is written to the trace as well.
+ *
+ * @note All functions are thread safe
+ */
+class Tracer
+{
+public:
+
+	/**
+	 * @brief ScopeEnter Called at the start of each TRACE_SCOPE region, see setScopeHooks()
+	 * @return True if the hook for the end of the region has to be called
+	 */
+	typedef bool (*ScopeEnter)(const char* name, const char* category);
+
+	/**
+	 * @brief ScopeLeave Called at the end of each TRACE_SCOPE region the enter hook returned true for
+	 */
+	typedef void (*ScopeLeave)();
+
+	/**
+	 * @brief start Enable tracing
+	 * @param file Where to write the trace when stop() is called
+	 */
+	static void start(const QString &file);
+
+	/**
+	 * @brief stop Disable tracing and write all recorded events
+	 * @return True if the trace was written
+	 */
+	static bool stop();
+
+	/**
+	 * @brief isEnabled Check if events are recorded
+	 * @return True while tracing
+	 */
+	static bool isEnabled()
+	{
+		return s_bEnabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief now The current trace time
+	 * @return The time since tracing was started in microseconds
+	 */
+	static qint64 now();
+
+	/**
+	 * @brief complete Record a span
+	 * @param name The span name, must be a string literal
+	 * @param category The category, must be a string literal
+	 * @param start The start time as returned by now()
+	 * @param detail Optional information displayed with the span
+	 */
+	static void complete(const char* name, const char* category, qint64 start, const QString &detail = QString());
+
+	/**
+	 * @brief instant Record an instant event
+	 * @param name The event name, must be a string literal
+	 * @param category The category, must be a string literal
+	 * @param detail Optional information displayed with the event
+	 */
+	static void instant(const char* name, const char* category, const QString &detail = QString());
+
+	/**
+	 * @brief asyncBegin Record the start of a span which may end on another call stack, e.g. a network request
+	 * @param name The span name, must be a string literal
+	 * @param category The category, must be a string literal
+	 * @param id Identifies the span, must be unique among the running spans of the same name
+	 * @param detail Optional information displayed with the span
+	 */
+	static void asyncBegin(const char* name, const char* category, quint64 id, const QString &detail = QString());
+
+	/**
+	 * @brief asyncEnd Record the end of a span started with asyncBegin()
+	 * @param name The span name, must be a string literal
+	 * @param category The category, must be a string literal
+	 * @param id The id passed to asyncBegin()
+	 */
+	static void asyncEnd(const char* name, const char* category, quint64 id);
+
+	/**
+	 * @brief setScopeHooks Let others follow the TRACE_SCOPE regions, independent of tracing, e.g. the StallWatchdog
+	 * @param enter Called at the start of each region, nullptr to remove the hooks
+	 * @param leave Called at the end of each region the enter hook returned true for
+	 */
+	static void setScopeHooks(ScopeEnter enter, ScopeLeave leave);
+
+	/**
+	 * @brief enterScope Call the enter hook, see setScopeHooks()
+	 * @param name The region name, must be a string literal
+	 * @param category The category, must be a string literal
+	 * @return True if leaveScope() has to be called at the end of the region
+	 */
+	static bool enterScope(const char* name, const char* category)
+	{
+		const auto enter = s_pScopeEnter.load(std::memory_order_relaxed);
+		return (nullptr != enter) && (true == enter(name, category));
+	}
+
+	/**
+	 * @brief leaveScope Call the leave hook, see setScopeHooks()
+	 */
+	static void leaveScope()
+	{
+		const auto leave = s_pScopeLeave.load(std::memory_order_relaxed);
+		if(nullptr != leave) leave();
+	}
+
+private:
+
+	/**
+	 * @brief record Store a single event
+	 * @param phase The trace event phase
+	 * @param name The event name
+	 * @param category The category
+	 * @param timestamp The start time in microseconds
+	 * @param duration The duration in microseconds, only used for complete events
+	 * @param id The async id, only used for async events
+	 * @param detail Optional information displayed with the event
+	 */
+	static void record(char phase, const char* name, const char* category, qint64 timestamp, qint64 duration, quint64 id,
+										 const QString &detail);
+
+	/**
+	 * @brief s_bEnabled True while tracing
+	 */
+	static std::atomic<bool> s_bEnabled;
+
+	/**
+	 * @brief s_pScopeEnter The hook called at the start of each region, nullptr if there is none
+	 */
+	static std::atomic<ScopeEnter> s_pScopeEnter;
+
+	/**
+	 * @brief s_pScopeLeave The hook called at the end of each region, nullptr if there is none
+	 */
+	static std::atomic<ScopeLeave> s_pScopeLeave;
+};
+
+/**
+ * @brief The TraceSpan class records a span covering its own lifetime
+ *
+ * The span is also reported to the scope hooks, see Tracer::setScopeHooks().
+ */
+class TraceSpan
+{
+public:
+
+	/**
+	 * @brief TraceSpan Start the span
+	 * @param name The span name, must be a string literal
+	 * @param category The category, must be a string literal
+	 */
+	TraceSpan(const char* name, const char* category)
+		: m_pName(name)
+		, m_pCategory(category)
+		, m_iStart(Tracer::isEnabled() ? Tracer::now() : -1)
+		, m_bHooked(Tracer::enterScope(name, category))
+	{
+	}
+
+	/**
+	 * @brief ~TraceSpan End the span
+	 */
+	~TraceSpan()
+	{
+		if((0 <= m_iStart) && (true == Tracer::isEnabled())) Tracer::complete(m_pName, m_pCategory, m_iStart);
+		if(true == m_bHooked) Tracer::leaveScope();
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+
+	//! The span name
+	const char* m_pName;
+
+	//! The category
+	const char* m_pCategory;
+
+	//! The start time, negative if tracing was disabled at the start
+	const qint64 m_iStart;
+
+	//! True if the leave hook has to be called
+	const bool m_bHooked;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+//! Record a span from this line to the end of the enclosing scope
+#define TRACE_SCOPE(name, category) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name, category)
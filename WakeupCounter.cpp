@@ -0,0 +1,72 @@
+#include "WakeupCounter.h"
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+
+//modes measured for less time are not reported, in milliseconds
+const qint64 ciMinimumElapsed = 1000;
+
+}
+
+WakeupCounter::WakeupCounter()
+	: m_Mode(Active)
+	, m_iLastWakeups(wakeups())
+	, m_Clock()
+	, m_Wakeups()
+	, m_Elapsed()
+{
+	m_Clock.start();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void WakeupCounter::setMode(Mode mode)
+{
+	if(mode == m_Mode) return;
+
+	sample();
+	m_Mode = mode;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+WakeupCounter::Mode WakeupCounter::mode() const
+{
+	return m_Mode;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void WakeupCounter::sample()
+{
+	const auto current = wakeups();
+
+	//the counts of all threads, including the finished ones, only grow
+	m_Wakeups[m_Mode] += qMax<qint64>(0, current - m_iLastWakeups);
+	m_Elapsed[m_Mode] += m_Clock.restart();
+
+	m_iLastWakeups = current;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+double WakeupCounter::wakeupsPerSecond(Mode mode) const
+{
+	if((0 > m_iLastWakeups) || (ciMinimumElapsed > m_Elapsed[mode])) return -1.0;
+
+	return m_Wakeups[mode] * 1000.0 / m_Elapsed[mode];
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+qint64 WakeupCounter::wakeups()
+{
+#if defined(Q_OS_UNIX)
+	struct rusage usage;
+	if(0 != getrusage(RUSAGE_SELF, &usage)) return -1;
+
+	return usage.ru_nvcsw;
+#else
+	return -1;
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+/**
+ * @brief The WakeupCounter class measures how often the process is woken, separately for the active and the idle mode
+ *
+ * A wakeup is counted for every voluntary context switch of any thread of the process, i.e. every time a thread
+ * blocked on a timer, a socket or a lock and was woken again. The counts are taken from the operating system when the
+ * mode changes and when sample() is called, nothing runs in between.
+ *
+ * @note Only available on unix systems, wakeupsPerSecond() reports -1 elsewhere
+ */
+class WakeupCounter
+{
+public:
+
+	/**
+	 * @brief The Mode enum lists the modes measured separately
+	 */
+	enum Mode
+	{
+		Active = 0,
+		Idle,
+		ModeCount
+	};
+
+	/**
+	 * @brief WakeupCounter Default constructor, the counter starts in the active mode
+	 */
+	WakeupCounter();
+
+	/**
+	 * @brief setMode Account the time since the last sample to the current mode and continue in another mode
+	 * @param mode The new mode
+	 */
+	void setMode(Mode mode);
+
+	/**
+	 * @brief mode The mode currently measured
+	 * @return The mode
+	 */
+	Mode mode() const;
+
+	/**
+	 * @brief sample Account the time since the last sample to the current mode
+	 */
+	void sample();
+
+	/**
+	 * @brief wakeupsPerSecond The average wakeup rate of a mode
+	 * @param mode The mode
+	 * @return The wakeups per second over all time spent in the mode, -1 if the mode was not measured yet
+	 */
+	double wakeupsPerSecond(Mode mode) const;
+
+private:
+
+	/**
+	 * @brief wakeups The number of voluntary context switches of the process so far
+	 * @return The number of switches, -1 if not available
+	 */
+	static qint64 wakeups();
+
+	/**
+	 * @brief m_Mode The mode currently measured
+	 */
+	Mode m_Mode;
+
+	/**
+	 * @brief m_iLastWakeups The number of switches at the last sample
+	 */
+	qint64 m_iLastWakeups;
+
+	/**
+	 * @brief m_Clock Measures the time since the last sample
+	 */
+	QElapsedTimer m_Clock;
+
+	/**
+	 * @brief m_Wakeups The switches counted in each mode
+	 */
+	qint64 m_Wakeups[ModeCount];
+
+	/**
+	 * @brief m_Elapsed The time spent in each mode, in milliseconds
+	 */
+	qint64 m_Elapsed[ModeCount];
+};
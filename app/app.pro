@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# The radio-ui application
+#
+#-------------------------------------------------
+
+include(../radio-ui.pri)
+
+TARGET = radio-ui
+TEMPLATE = app
+
+SOURCES *= \
+	../main.cpp
+
+# stations.json is compiled into a binary catalog next to the application, which maps it instead of parsing the json
+# file. The json file stays the source and the fallback, an outdated catalog is ignored at runtime. The compiler is
+# built before the application, see radio-ui.pro.
+CATALOG_COMPILER = $$OUT_PWD/../tools/catalog-compiler/catalog-compiler
+win32: CATALOG_COMPILER = $${CATALOG_COMPILER}.exe
+
+STATION_CATALOGS = $$PWD/../stations.json
+
+station_catalog.input = STATION_CATALOGS
+station_catalog.output = $$OUT_PWD/${QMAKE_FILE_BASE}.catalog
+station_catalog.commands = $$CATALOG_COMPILER ${QMAKE_FILE_NAME} ${QMAKE_FILE_OUT}
+station_catalog.depends = $$CATALOG_COMPILER
+station_catalog.CONFIG += no_link target_predeps
+
+QMAKE_EXTRA_COMPILERS += station_catalog
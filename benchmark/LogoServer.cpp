@@ -0,0 +1,79 @@
+#include "LogoServer.h"
+
+LogoServer::LogoServer(const QByteArray &logo, QObject* parent)
+	: QObject(parent)
+	, m_baLogo(logo)
+	, m_Server()
+	, m_Requests()
+	, m_uRequests(0)
+{
+	connect(&m_Server, &QTcpServer::newConnection, this, &LogoServer::onNewConnection);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool LogoServer::listen()
+{
+	return m_Server.listen(QHostAddress::LocalHost);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString LogoServer::url(int station) const
+{
+	return QString("http://127.0.0.1:%1/logo/%2.png").arg(m_Server.serverPort()).arg(station);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+quint64 LogoServer::requests() const
+{
+	return m_uRequests;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoServer::onNewConnection()
+{
+	while(true == m_Server.hasPendingConnections())
+	{
+		auto socket = m_Server.nextPendingConnection();
+		m_Requests.insert(socket, QByteArray());
+
+		connect(socket, &QTcpSocket::readyRead, this, [=]() { answer(socket); });
+		connect(socket, &QTcpSocket::disconnected, this, [=]()
+		{
+			m_Requests.remove(socket);
+			socket->deleteLater();
+		});
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogoServer::answer(QTcpSocket* socket)
+{
+	auto &request = m_Requests[socket];
+	request += socket->readAll();
+
+	//a client may send its next request before the previous answer arrived
+	for(auto end = request.indexOf("\r\n\r\n"); 0 <= end; end = request.indexOf("\r\n\r\n"))
+	{
+		const auto line = request.left(request.indexOf("\r\n")).split(' ');
+		request.remove(0, end + 4);
+		++m_uRequests;
+
+		const auto path = line.value(1);
+		const auto logo = (true == path.startsWith("/logo/")) && (true == path.endsWith(".png"));
+
+		if((QByteArray("GET") != line.value(0)) || (false == logo))
+		{
+			socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+			continue;
+		}
+
+		QByteArray header("HTTP/1.1 200 OK\r\n"
+											"Content-Type: image/png\r\n"
+											"Cache-Control: max-age=86400\r\n");
+		header += QString("Content-Length: %1\r\n\r\n").arg(m_baLogo.size()).toLatin1();
+
+		socket->write(header);
+		socket->write(m_baLogo);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QObject>
+
+#include <QByteArray>
+#include <QHash>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+/**
+ * @brief The LogoServer class is a local stand-in for the web servers hosting the station logos
+ *
+ * It answers GET requests for /logo/<station>.png with the same PNG image, over persistent HTTP/1.1 connections like
+ * a real web server. Any other path is answered with 404.
+ */
+class LogoServer : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief LogoServer Default constructor
+	 * @param logo The encoded image served for every station
+	 * @param parent
+	 */
+	explicit LogoServer(const QByteArray &logo, QObject* parent = nullptr);
+
+	/**
+	 * @brief listen Start listening on the loopback interface
+	 * @return True if the server is listening
+	 */
+	bool listen();
+
+	/**
+	 * @brief url The url of a logo
+	 * @param station The station number
+	 * @return The logo url
+	 */
+	QString url(int station) const;
+
+	/**
+	 * @brief requests The number of requests answered so far
+	 * @return The request counter
+	 */
+	quint64 requests() const;
+
+private slots:
+
+	/**
+	 * @brief onNewConnection Accept new clients
+	 */
+	void onNewConnection();
+
+private:
+
+	/**
+	 * @brief answer Answer all complete requests a client sent
+	 * @param socket The client
+	 */
+	void answer(QTcpSocket* socket);
+
+	/**
+	 * @brief m_baLogo The encoded image served for every station
+	 */
+	const QByteArray m_baLogo;
+
+	/**
+	 * @brief m_Server The listening socket
+	 */
+	QTcpServer m_Server;
+
+	/**
+	 * @brief m_Requests The incomplete request received so far, by client
+	 */
+	QHash<QTcpSocket*, QByteArray> m_Requests;
+
+	/**
+	 * @brief m_uRequests The request counter
+	 */
+	quint64 m_uRequests;
+};
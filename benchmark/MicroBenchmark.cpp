@@ -0,0 +1,374 @@
+#include "MicroBenchmark.h"
+
+#include "LogoDownloader.h"
+#include "LogoScaler.h"
+#include "StationCatalog.h"
+#include "StationReader.h"
+#include "TextFitter.h"
+
+#include <QBuffer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QPixmap>
+#include <QTimer>
+#include <QtTest>
+
+namespace
+{
+
+//the size of the synthetic logo, about the size of the logos in the shipped stations file
+const QSize cLogoSize(200, 80);
+
+//the logos of the catalogs are downscaled to this size, the default of the catalog compiler
+const QSize cCatalogLogoSize(320, 240);
+
+//the longest time to wait for the downloads of a single iteration, in milliseconds
+const int ciDownloadTimeout = 30000;
+
+/**
+ * @brief Titles Stream titles as sent by real stations
+ * @return The titles by a short description
+ */
+QList<QPair<QString, QString>> Titles()
+{
+	return QList<QPair<QString, QString>>()
+			<< qMakePair(QString("short"), QString("Adele - Hello"))
+			<< qMakePair(QString("typical"), QString("Depeche Mode - Enjoy the Silence (Single Version)"))
+			<< qMakePair(QString("long"), QString("Johann Sebastian Bach - Brandenburgisches Konzert Nr. 3 G-Dur BWV 1048: "
+																						"I. Allegro (Akademie für Alte Musik Berlin)"))
+			<< qMakePair(QString("accented"), QString::fromUtf8("Sigur Rós - Hoppípolla"))
+			<< qMakePair(QString("cyrillic"), QString::fromUtf8("Пётр Ильич Чайковский - Щелкунчик, соч. 71"));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief LabelSizes The sizes of the labels titles are fitted into
+ * @return The sizes
+ */
+QList<QSize> LabelSizes()
+{
+	return QList<QSize>() << QSize(460, 60) << QSize(760, 90);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief AddStationRows Add a row for every station count and logo kind
+ */
+void AddStationRows()
+{
+	QTest::addColumn<int>("count");
+	QTest::addColumn<QString>("logos");
+
+	for(const auto count : {10, 1000, 10000})
+	{
+		for(const auto &logos : {QString("embedded"), QString("file"), QString("url")})
+		{
+			QTest::newRow(QString("%1 %2").arg(count).arg(logos).toLatin1()) << count << logos;
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief AddTitleRows Add a row for every title and label size
+ */
+void AddTitleRows()
+{
+	QTest::addColumn<QString>("title");
+	QTest::addColumn<QSize>("size");
+
+	for(const auto &title : Titles())
+	{
+		for(const auto &size : LabelSizes())
+		{
+			const auto tag = QString("%1 %2x%3").arg(title.first).arg(size.width()).arg(size.height());
+			QTest::newRow(tag.toLatin1()) << title.second << size;
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+MicroBenchmark::MicroBenchmark(QObject* parent)
+	: QObject(parent)
+	, m_Directory()
+	, m_Logo()
+	, m_baLogo()
+	, m_LogoServer()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::initTestCase()
+{
+	QVERIFY(true == m_Directory.isValid());
+
+	//a gradient with some shapes compresses about as well as a real logo
+	m_Logo = QImage(cLogoSize, QImage::Format_ARGB32_Premultiplied);
+	m_Logo.fill(Qt::transparent);
+
+	QLinearGradient gradient(0, 0, cLogoSize.width(), cLogoSize.height());
+	gradient.setColorAt(0.0, QColor(72, 126, 176));
+	gradient.setColorAt(1.0, QColor(230, 120, 40));
+
+	QPainter painter(&m_Logo);
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.setBrush(gradient);
+	painter.setPen(QPen(Qt::white, 3));
+	painter.drawRoundedRect(m_Logo.rect().adjusted(2, 2, -2, -2), 12, 12);
+	painter.drawEllipse(QPoint(cLogoSize.height() / 2, cLogoSize.height() / 2), 28, 28);
+	painter.end();
+
+	QBuffer buffer(&m_baLogo);
+	buffer.open(QBuffer::WriteOnly);
+	QVERIFY(true == m_Logo.save(&buffer, "PNG"));
+
+	m_LogoServer.reset(new LogoServer(m_baLogo));
+	QVERIFY(true == m_LogoServer->listen());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::readStations_data()
+{
+	AddStationRows();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::readStations()
+{
+	QFETCH(int, count);
+	QFETCH(QString, logos);
+
+	const auto file = stationsFile(count, logos);
+
+	QList<StationInformation> stations;
+	QBENCHMARK
+	{
+		stations = StationReader::readFile(file);
+	}
+
+	QCOMPARE(stations.size(), count);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::readCatalog_data()
+{
+	AddStationRows();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::readCatalog()
+{
+	QFETCH(int, count);
+	QFETCH(QString, logos);
+
+	const auto file = catalogFile(count, logos);
+	QVERIFY(false == file.isEmpty());
+
+	QList<StationInformation> stations;
+	QBENCHMARK
+	{
+		StationCatalog catalog;
+		if(true == catalog.open(file)) stations = catalog.stations();
+	}
+
+	QCOMPARE(stations.size(), count);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::scaleLogo_data()
+{
+	QTest::addColumn<QImage>("logo");
+	QTest::addColumn<QSize>("size");
+	QTest::addColumn<double>("factor");
+
+	//the tile icons at single and double device pixel ratio and the logo on the playing page
+	const QList<QPair<QSize, double>> targets = {qMakePair(QSize(32, 32), 1.0), qMakePair(QSize(64, 64), 1.0),
+																							 qMakePair(cCatalogLogoSize, 0.8)};
+
+	for(const auto &source : {QSize(64, 64), cLogoSize, QSize(1024, 1024), QSize(2048, 820)})
+	{
+		const auto logo = m_Logo.scaled(source, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+		for(const auto &target : targets)
+		{
+			const auto tag = QString("%1x%2 to %3x%4").arg(source.width()).arg(source.height())
+																								.arg(target.first.width()).arg(target.first.height());
+			QTest::newRow(tag.toLatin1()) << logo << target.first << target.second;
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::scaleLogo()
+{
+	QFETCH(QImage, logo);
+	QFETCH(QSize, size);
+	QFETCH(double, factor);
+
+	QImage scaled;
+	QBENCHMARK
+	{
+		scaled = LogoScaler::scaleToRectangle(logo, size, factor);
+	}
+
+	QVERIFY(scaled.width() <= qMax(size.width(), logo.width()));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::fitText_data()
+{
+	AddTitleRows();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::fitText()
+{
+	QFETCH(QString, title);
+	QFETCH(QSize, size);
+
+	const QFont font;
+
+	TextFitter::Fit fit;
+	QBENCHMARK
+	{
+		//a new fitter has nothing memoized, so every iteration measures
+		TextFitter fitter;
+		fit = fitter.fit(title, font, size);
+	}
+
+	QVERIFY(false == fit.m_strText.isEmpty());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::fitTextCached_data()
+{
+	AddTitleRows();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::fitTextCached()
+{
+	QFETCH(QString, title);
+	QFETCH(QSize, size);
+
+	const QFont font;
+
+	TextFitter fitter;
+	fitter.fit(title, font, size);
+
+	TextFitter::Fit fit;
+	QBENCHMARK
+	{
+		fit = fitter.fit(title, font, size);
+	}
+
+	QVERIFY(false == fit.m_strText.isEmpty());
+	QCOMPARE(fitter.misses(), Q_UINT64_C(1));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::downloadLogos_data()
+{
+	QTest::addColumn<int>("count");
+
+	for(const auto count : {10, 100}) QTest::newRow(QString("%1 logos").arg(count).toLatin1()) << count;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void MicroBenchmark::downloadLogos()
+{
+	QFETCH(int, count);
+
+	auto received = 0;
+	auto failed = 0;
+
+	QBENCHMARK
+	{
+		received = 0;
+		failed = 0;
+
+		//an empty cache for every iteration, otherwise the logos would only be revalidated
+		QTemporaryDir cache;
+		LogoDownloader downloader(cache.path());
+
+		QEventLoop loop;
+		QTimer::singleShot(ciDownloadTimeout, &loop, &QEventLoop::quit);
+
+		for(auto i = 0; i < count; ++i)
+		{
+			downloader.downloadLogo(QUrl(m_LogoServer->url(i)), [&](QPixmap logo)
+			{
+				if(true == logo.isNull()) ++failed;
+				if(count == ++received) loop.quit();
+			});
+		}
+
+		if(received < count) loop.exec();
+	}
+
+	QCOMPARE(received, count);
+	QCOMPARE(failed, 0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString MicroBenchmark::stationsFile(int count, const QString &logos)
+{
+	const auto file = m_Directory.filePath(QString("stations-%1-%2.json").arg(count).arg(logos));
+	if(true == QFileInfo::exists(file)) return file;
+
+	const auto logoFile = m_Directory.filePath("logo.png");
+	if(false == QFileInfo::exists(logoFile)) m_Logo.save(logoFile, "PNG");
+
+	const QStringList names = {"Radio", "Hitradio", "Klassik", "Jazz FM", "Kultur", "Sputnik", "Info", "Country"};
+	const QStringList genres = {"Pop", "Rock", "Classical", "Jazz", "News", "Electronic", "Country"};
+	const auto embedded = QString::fromLatin1(m_baLogo.toBase64());
+
+	QJsonObject stations;
+	for(auto i = 0; i < count; ++i)
+	{
+		QJsonObject station;
+		station.insert("url", QString("http://127.0.0.1:1/stream/%1").arg(i));
+		station.insert("genre", genres.at(i % genres.size()));
+		station.insert("meta_key_1", QString("Title"));
+		station.insert("meta_key_2", QString("Genre"));
+		station.insert("background-color-normal", QColor::fromHsv(i % 360, 200, 120).name());
+
+		if(QString("embedded") == logos) station.insert("logo", embedded);
+		else if(QString("file") == logos) station.insert("logo-file", logoFile);
+		else station.insert("logo-url", m_LogoServer->url(i));
+
+		stations.insert(QString("%1 %2").arg(names.at(i % names.size())).arg(i), station);
+	}
+
+	QFile f(file);
+	if(true == f.open(QFile::WriteOnly)) f.write(QJsonDocument(stations).toJson(QJsonDocument::Compact));
+
+	return file;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString MicroBenchmark::catalogFile(int count, const QString &logos)
+{
+	const auto file = m_Directory.filePath(QString("stations-%1-%2.catalog").arg(count).arg(logos));
+	if(true == QFileInfo::exists(file)) return file;
+
+	const auto source = stationsFile(count, logos);
+
+	QString error;
+	if(false == StationCatalog::write(file, StationReader::readFile(source), StationCatalog::hash(source),
+																		cCatalogLogoSize, &error))
+	{
+		qWarning() << "Cannot compile" << source << ":" << error;
+		return QString();
+	}
+
+	return file;
+}
+//----------------------------------------------------------------------------------------------------------------------
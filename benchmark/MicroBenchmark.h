@@ -0,0 +1,138 @@
+#pragma once
+
+#include <memory>
+
+#include <QObject>
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <QTemporaryDir>
+
+#include "LogoServer.h"
+
+/**
+ * @brief The MicroBenchmark class times the hot paths of radio-ui in isolation with QBENCHMARK
+ *
+ * Covered are reading the stations from the json file and from the binary catalog, scaling logos, fitting titles into
+ * labels and downloading logos. The stations files are synthetic, with 10, 1000 or 10000 stations whose logos are
+ * embedded, logo files or urls. They are generated on first use in a temporary folder, the logo urls point to a local
+ * LogoServer.
+ */
+class MicroBenchmark : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief MicroBenchmark Default constructor
+	 * @param parent
+	 */
+	explicit MicroBenchmark(QObject* parent = nullptr);
+
+private slots:
+
+	/**
+	 * @brief initTestCase Draw the synthetic logo and start the logo server
+	 */
+	void initTestCase();
+
+	/**
+	 * @brief readStations_data The station counts and logo kinds
+	 */
+	void readStations_data();
+
+	/**
+	 * @brief readStations Parse a json stations file
+	 */
+	void readStations();
+
+	/**
+	 * @brief readCatalog_data The station counts and logo kinds
+	 */
+	void readCatalog_data();
+
+	/**
+	 * @brief readCatalog Map a compiled catalog and read its stations
+	 */
+	void readCatalog();
+
+	/**
+	 * @brief scaleLogo_data Logo sizes and the rectangles of the gui they are scaled for
+	 */
+	void scaleLogo_data();
+
+	/**
+	 * @brief scaleLogo Scale a logo into a rectangle
+	 */
+	void scaleLogo();
+
+	/**
+	 * @brief fitText_data Stream titles and the label sizes they are fitted into
+	 */
+	void fitText_data();
+
+	/**
+	 * @brief fitText Find the font for a title never fitted before
+	 */
+	void fitText();
+
+	/**
+	 * @brief fitTextCached_data Stream titles and the label sizes they are fitted into
+	 */
+	void fitTextCached_data();
+
+	/**
+	 * @brief fitTextCached Find the font for a title fitted before, as when switching back to a station
+	 */
+	void fitTextCached();
+
+	/**
+	 * @brief downloadLogos_data The number of logos
+	 */
+	void downloadLogos_data();
+
+	/**
+	 * @brief downloadLogos Download distinct logos with an empty cache
+	 */
+	void downloadLogos();
+
+private:
+
+	/**
+	 * @brief stationsFile Generate a synthetic stations file unless it exists already
+	 * @param count The number of stations
+	 * @param logos The logo kind, "embedded", "file" or "url"
+	 * @return The absolute path of the json file
+	 */
+	QString stationsFile(int count, const QString &logos);
+
+	/**
+	 * @brief catalogFile Compile a synthetic stations file into a catalog unless it exists already
+	 * @param count The number of stations
+	 * @param logos The logo kind, "embedded", "file" or "url"
+	 * @return The absolute path of the catalog, empty if it could not be written
+	 */
+	QString catalogFile(int count, const QString &logos);
+
+	/**
+	 * @brief m_Directory Holds the generated files
+	 */
+	QTemporaryDir m_Directory;
+
+	/**
+	 * @brief m_Logo The synthetic logo
+	 */
+	QImage m_Logo;
+
+	/**
+	 * @brief m_baLogo The synthetic logo as PNG
+	 */
+	QByteArray m_baLogo;
+
+	/**
+	 * @brief m_LogoServer Serves the synthetic logo for the url logos and the downloads
+	 */
+	std::unique_ptr<LogoServer> m_LogoServer;
+};
@@ -0,0 +1,201 @@
+#include "StreamServer.h"
+
+#include <QtGlobal>
+
+namespace
+{
+
+//the size of a 128 kbit/s, 44.1 kHz frame without padding
+const int ciFrameSize = 417;
+
+//the number of frames per second at 44.1 kHz
+const double cdFramesPerSecond = 44100.0 / 1152.0;
+
+//the interval between two metadata blocks in audio bytes
+const int ciMetadataInterval = 8192;
+
+//the audio sent immediately by the bursting variants, in seconds
+const double cdBurstSeconds = 2.0;
+
+//the pacing interval, in milliseconds
+const int ciTickInterval = 50;
+
+//data is not sent while the client has this much pending, in bytes
+const qint64 ciMaxPending = 64 * 1024;
+
+}
+
+StreamServer::StreamServer(QObject* parent)
+	: QObject(parent)
+	, m_Server()
+{
+	connect(&m_Server, &QTcpServer::newConnection, this, &StreamServer::onNewConnection);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StreamServer::listen()
+{
+	return m_Server.listen(QHostAddress::LocalHost);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QString StreamServer::url(const QString &variant, int station) const
+{
+	return QString("http://127.0.0.1:%1/%2/%3").arg(m_Server.serverPort()).arg(variant).arg(station);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QByteArray StreamServer::silentFrame()
+{
+	//MPEG-1, layer III, no crc, 128 kbit/s, 44.1 kHz, no padding, mono, original. All zero side information and main
+	//data decode to silence.
+	QByteArray frame(ciFrameSize, '\0');
+	frame[0] = static_cast<char>(0xFF);
+	frame[1] = static_cast<char>(0xFB);
+	frame[2] = static_cast<char>(0x90);
+	frame[3] = static_cast<char>(0xC4);
+
+	return frame;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamServer::onNewConnection()
+{
+	while(true == m_Server.hasPendingConnections())
+	{
+		new StreamServerConnection(m_Server.nextPendingConnection());
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+StreamServerConnection::StreamServerConnection(QTcpSocket* socket)
+	: QObject(nullptr)
+	, m_pSocket(socket)
+	, m_baRequest()
+	, m_strVariant()
+	, m_iStation(0)
+	, m_bMetadata(false)
+	, m_iUntilMetadata(ciMetadataInterval)
+	, m_iTitle(0)
+	, m_iFramesSent(0)
+	, m_iStalledUntil(0)
+	, m_Started()
+	, m_Timer()
+{
+	m_pSocket->setParent(this);
+
+	connect(m_pSocket, &QTcpSocket::readyRead, this, &StreamServerConnection::onReadyRead);
+	connect(m_pSocket, &QTcpSocket::disconnected, this, &StreamServerConnection::deleteLater);
+	connect(&m_Timer, &QTimer::timeout, this, &StreamServerConnection::onTick);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamServerConnection::onReadyRead()
+{
+	if(true == m_Timer.isActive())
+	{
+		//we do not care about anything sent after the request
+		m_pSocket->readAll();
+		return;
+	}
+
+	m_baRequest += m_pSocket->readAll();
+	if(false == m_baRequest.contains("\r\n\r\n")) return;
+
+	const auto lines = m_baRequest.split('\n');
+	const auto path = QString::fromLatin1(lines.first().split(' ').value(1)).split('/', QString::SkipEmptyParts);
+
+	m_strVariant = path.value(0);
+	m_iStation = path.value(1).toInt();
+	m_bMetadata = m_baRequest.toLower().contains("icy-metadata: 1");
+
+	if((QStringLiteral("steady") != m_strVariant) &&
+		 (QStringLiteral("throttled") != m_strVariant) &&
+		 (QStringLiteral("jittery") != m_strVariant))
+	{
+		m_pSocket->write("HTTP/1.0 404 Not Found\r\n\r\n");
+		m_pSocket->disconnectFromHost();
+		return;
+	}
+
+	QByteArray header("HTTP/1.0 200 OK\r\n"
+										"Content-Type: audio/mpeg\r\n"
+										"Cache-Control: no-cache\r\n");
+	header += QString("icy-name: Benchmark %1\r\n").arg(m_iStation).toLatin1();
+	header += "icy-br: 128\r\n";
+	if(true == m_bMetadata) header += QString("icy-metaint: %1\r\n").arg(ciMetadataInterval).toLatin1();
+	header += "\r\n";
+
+	m_pSocket->write(header);
+
+	m_Started.start();
+	m_Timer.start(ciTickInterval);
+
+	onTick();
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamServerConnection::onTick()
+{
+	const auto now = m_Started.elapsed();
+
+	if(QStringLiteral("jittery") == m_strVariant)
+	{
+		if(now < m_iStalledUntil) return;
+
+		//about once every two seconds the connection stalls
+		if(0 == (qrand() % 40)) m_iStalledUntil = now + 100 + (qrand() % 900);
+	}
+
+	if(ciMaxPending < m_pSocket->bytesToWrite()) return;
+
+	const auto burst = (QStringLiteral("throttled") == m_strVariant) ? 0.0 : cdBurstSeconds;
+	const auto framesDue = static_cast<qint64>((burst + now / 1000.0) * cdFramesPerSecond);
+
+	QByteArray data;
+	for(; m_iFramesSent < framesDue; ++m_iFramesSent) data += StreamServer::silentFrame();
+
+	if(false == data.isEmpty()) write(data);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamServerConnection::write(const QByteArray &data)
+{
+	if(false == m_bMetadata)
+	{
+		m_pSocket->write(data);
+		return;
+	}
+
+	int offset = 0;
+	while(offset < data.size())
+	{
+		const auto chunk = qMin(m_iUntilMetadata, data.size() - offset);
+
+		m_pSocket->write(data.constData() + offset, chunk);
+		offset += chunk;
+		m_iUntilMetadata -= chunk;
+
+		if(0 == m_iUntilMetadata)
+		{
+			m_pSocket->write(metadataBlock());
+			m_iUntilMetadata = ciMetadataInterval;
+		}
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QByteArray StreamServerConnection::metadataBlock()
+{
+	//the title changes every few blocks, the blocks in between are empty
+	if(0 != (m_iTitle++ % 8)) return QByteArray(1, '\0');
+
+	auto metadata = QString("StreamTitle='Benchmark %1 - Title %2';").arg(m_iStation).arg(m_iTitle / 8).toLatin1();
+
+	//the length byte counts blocks of 16 bytes
+	const auto blocks = (metadata.size() + 15) / 16;
+	metadata = metadata.leftJustified(blocks * 16, '\0');
+
+	return QByteArray(1, static_cast<char>(blocks)) + metadata;
+}
+//----------------------------------------------------------------------------------------------------------------------
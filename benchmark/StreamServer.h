@@ -0,0 +1,162 @@
+#pragma once
+
+#include <QObject>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+/**
+ * @brief The StreamServer class is a local stand-in for an internet radio server
+ *
+ * It serves an endless, silent MP3 stream with ICY title metadata on the urls /<variant>/<station>. The variant
+ * selects the delivery pattern:
+ * - steady: a few seconds of audio as initial burst, then real-time
+ * - throttled: strictly real-time without any burst
+ * - jittery: like steady, but with random stalls of up to a second followed by catch-up bursts
+ */
+class StreamServer : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief StreamServer Default constructor
+	 * @param parent
+	 */
+	explicit StreamServer(QObject* parent = nullptr);
+
+	/**
+	 * @brief listen Start listening on the loopback interface
+	 * @return True if the server is listening
+	 */
+	bool listen();
+
+	/**
+	 * @brief url The url of a stream
+	 * @param variant The delivery pattern
+	 * @param station The station number, used in the titles
+	 * @return The stream url
+	 */
+	QString url(const QString &variant, int station) const;
+
+	/**
+	 * @brief silentFrame A single silent MPEG-1 layer III frame, 128 kbit/s, 44.1 kHz, mono
+	 * @return The frame
+	 */
+	static QByteArray silentFrame();
+
+private slots:
+
+	/**
+	 * @brief onNewConnection Accept a new stream connection
+	 */
+	void onNewConnection();
+
+private:
+
+	/**
+	 * @brief m_Server The listening socket
+	 */
+	QTcpServer m_Server;
+};
+
+/**
+ * @brief The StreamServerConnection class feeds a single client of the StreamServer
+ */
+class StreamServerConnection : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief StreamServerConnection Default constructor, the connection deletes itself when the client disconnects
+	 * @param socket The client socket, the connection takes ownership
+	 */
+	explicit StreamServerConnection(QTcpSocket* socket);
+
+private slots:
+
+	/**
+	 * @brief onReadyRead Parse the request and send the response header
+	 */
+	void onReadyRead();
+
+	/**
+	 * @brief onTick Send the audio due since the last tick
+	 */
+	void onTick();
+
+private:
+
+	/**
+	 * @brief write Send audio data, inserting metadata blocks at the metadata interval
+	 * @param data The audio data
+	 */
+	void write(const QByteArray &data);
+
+	/**
+	 * @brief metadataBlock Build the next ICY metadata block
+	 * @return The block including its length byte
+	 */
+	QByteArray metadataBlock();
+
+	/**
+	 * @brief m_pSocket The client
+	 */
+	QTcpSocket* m_pSocket;
+
+	/**
+	 * @brief m_baRequest The request header received so far
+	 */
+	QByteArray m_baRequest;
+
+	/**
+	 * @brief m_strVariant The delivery pattern
+	 */
+	QString m_strVariant;
+
+	/**
+	 * @brief m_iStation The station number
+	 */
+	int m_iStation;
+
+	/**
+	 * @brief m_bMetadata True if the client asked for ICY metadata
+	 */
+	bool m_bMetadata;
+
+	/**
+	 * @brief m_iUntilMetadata The number of audio bytes until the next metadata block
+	 */
+	int m_iUntilMetadata;
+
+	/**
+	 * @brief m_iTitle The number of titles sent so far
+	 */
+	int m_iTitle;
+
+	/**
+	 * @brief m_iFramesSent The number of frames sent so far
+	 */
+	qint64 m_iFramesSent;
+
+	/**
+	 * @brief m_iStalledUntil No data is sent before this time, in milliseconds since the start
+	 */
+	qint64 m_iStalledUntil;
+
+	/**
+	 * @brief m_Started When the response was started
+	 */
+	QElapsedTimer m_Started;
+
+	/**
+	 * @brief m_Timer Paces the stream
+	 */
+	QTimer m_Timer;
+};
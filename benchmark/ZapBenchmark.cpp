@@ -0,0 +1,220 @@
+#include "ZapBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QBuffer>
+#include <QEventLoop>
+#include <QFile>
+#include <QImage>
+#include <QJsonDocument>
+#include <QPushButton>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include "RadioGui.h"
+
+namespace
+{
+
+//the number of source buttons on the select page
+const int ciStations = 6;
+
+//the milestones recorded for each station start
+const QStringList cMilestones = QStringList() << "first-buffer" << "buffered" << "playing" << "metadata";
+
+}
+
+ZapBenchmark::ZapBenchmark(const Options &options)
+	: QObject(nullptr)
+	, m_Options(options)
+	, m_Server()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QJsonObject ZapBenchmark::run()
+{
+	QJsonObject result;
+
+	if(false == m_Server.listen()) return result;
+
+	QJsonObject variants;
+
+	for(const auto &variant : m_Options.m_Variants)
+	{
+		const auto samples = measureVariant(variant);
+
+		QJsonObject milestones;
+		for(auto it = samples.cbegin(); it != samples.cend(); ++it)
+		{
+			if(true == it.key().endsWith("-missing"))
+			{
+				milestones.insert(it.key(), it.value().size());
+			}
+			else
+			{
+				milestones.insert(it.key(), summarize(it.value()));
+			}
+		}
+
+		variants.insert(variant, milestones);
+	}
+
+	result.insert("unit", "ms");
+	result.insert("switches", m_Options.m_iSwitches);
+	result.insert("standby-players", m_Options.m_iStandbyPlayers);
+	result.insert("variants", variants);
+
+	return result;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+ZapBenchmark::Samples ZapBenchmark::measureVariant(const QString &variant)
+{
+	Samples samples;
+
+	QTemporaryDir dir;
+	const auto stationsFile = dir.filePath("stations.json");
+	if(false == writeStations(variant, stationsFile)) return samples;
+
+	//start() plays the first station
+	QElapsedTimer clock;
+	clock.start();
+
+	auto gui = new RadioGui(stationsFile);
+	gui->setStandbyPlayers(m_Options.m_iStandbyPlayers);
+	gui->start();
+	gui->show();
+
+	measure(gui, clock, nullptr, "startup-", samples);
+
+	for(auto i = 0; i < m_Options.m_iSwitches; ++i)
+	{
+		auto button = gui->findChild<QPushButton*>(QString("btn%1").arg(2 + (i % (ciStations - 1))));
+		if(nullptr == button) break;
+
+		//a tap on the already selected station would not switch at all
+		if(true == button->isChecked()) button = gui->findChild<QPushButton*>("btn1");
+
+		clock.start();
+		measure(gui, clock, [=]() { button->click(); }, QString(), samples);
+	}
+
+	delete gui;
+
+	return samples;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void ZapBenchmark::measure(RadioGui* gui, const QElapsedTimer &clock, const std::function<void()> &start,
+													 const QString &prefix, Samples &samples)
+{
+	QMap<QString, qint64> reached;
+	QEventLoop loop;
+
+	auto record = [&](const QString &milestone)
+	{
+		if(true == reached.contains(milestone)) return;
+
+		reached.insert(milestone, clock.elapsed());
+		if(cMilestones.size() == reached.size()) loop.quit();
+	};
+
+	auto onStatus = [&](QMediaPlayer::MediaStatus status)
+	{
+		if((QMediaPlayer::BufferingMedia == status) || (QMediaPlayer::BufferedMedia == status)) record("first-buffer");
+		if(QMediaPlayer::BufferedMedia == status) record("buffered");
+	};
+
+	auto onState = [&](QMediaPlayer::State state)
+	{
+		if(QMediaPlayer::PlayingState == state) record("playing");
+	};
+
+	QList<QMetaObject::Connection> connections;
+	connections << connect(gui, &RadioGui::mediaStatusChanged, onStatus);
+	connections << connect(gui, &RadioGui::playerStateChanged, onState);
+	connections << connect(gui, &RadioGui::metadataDisplayed, [&]() { record("metadata"); });
+
+	if(nullptr != start)
+	{
+		start();
+	}
+	else
+	{
+		//everything that happened during construction was missed by the connections
+		onStatus(gui->mediaStatus());
+		onState(gui->playerState());
+	}
+
+	if(cMilestones.size() > reached.size())
+	{
+		QTimer::singleShot(m_Options.m_iTimeout, &loop, &QEventLoop::quit);
+		loop.exec();
+	}
+
+	for(const auto &connection : connections) disconnect(connection);
+
+	for(const auto &milestone : cMilestones)
+	{
+		if(true == reached.contains(milestone)) samples[prefix + milestone].append(reached.value(milestone));
+		else samples[prefix + milestone + "-missing"].append(0);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ZapBenchmark::writeStations(const QString &variant, const QString &path) const
+{
+	//a small embedded logo, so the logo decoding is part of the startup as well
+	QImage logo(64, 32, QImage::Format_ARGB32);
+	logo.fill(Qt::darkBlue);
+
+	QByteArray png;
+	QBuffer buffer(&png);
+	buffer.open(QIODevice::WriteOnly);
+	logo.save(&buffer, "PNG");
+
+	QJsonObject stations;
+	for(auto i = 1; i <= ciStations; ++i)
+	{
+		QJsonObject station;
+		station.insert("url", m_Server.url(variant, i));
+		station.insert("logo", QString::fromLatin1(png.toBase64()));
+		station.insert("meta_key_1", "Title");
+		station.insert("meta_key_2", "Publisher");
+
+		stations.insert(QString("Benchmark %1").arg(i), station);
+	}
+
+	QFile f(path);
+	if(false == f.open(QFile::WriteOnly)) return false;
+
+	return (0 < f.write(QJsonDocument(stations).toJson()));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+QJsonObject ZapBenchmark::summarize(QVector<qint64> samples)
+{
+	QJsonObject summary;
+	summary.insert("count", samples.size());
+	if(true == samples.isEmpty()) return summary;
+
+	std::sort(samples.begin(), samples.end());
+
+	//nearest rank percentile
+	auto percentile = [&](double p)
+	{
+		const auto rank = qMax(1, static_cast<int>(std::ceil(p / 100.0 * samples.size())));
+		return static_cast<double>(samples.at(rank - 1));
+	};
+
+	summary.insert("min", static_cast<double>(samples.first()));
+	summary.insert("p50", percentile(50));
+	summary.insert("p90", percentile(90));
+	summary.insert("p99", percentile(99));
+	summary.insert("max", static_cast<double>(samples.last()));
+
+	return summary;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <functional>
+
+#include <QObject>
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+
+#include "StreamServer.h"
+
+class RadioGui;
+
+/**
+ * @brief The ZapBenchmark class measures how fast radio-ui starts playing and switches between stations
+ *
+ * For each stream variant of the StreamServer a RadioGui is created with a generated stations file. The time from
+ * construction to the first playback and the time from each click on a source button to the first buffered data, the
+ * playing state and the first displayed metadata is recorded.
+ */
+class ZapBenchmark : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief The Options struct configures a benchmark run
+	 */
+	struct Options
+	{
+		//! The stream variants to measure
+		QStringList m_Variants = QStringList() << "steady" << "throttled" << "jittery";
+
+		//! The number of station switches per variant
+		int m_iSwitches = 20;
+
+		//! The number of standby players, 0 measures without zapping mode
+		int m_iStandbyPlayers = 0;
+
+		//! The time to wait for a milestone before it is recorded as missing, in milliseconds
+		int m_iTimeout = 10000;
+	};
+
+	/**
+	 * @brief ZapBenchmark Default constructor
+	 * @param options The configuration
+	 */
+	explicit ZapBenchmark(const Options &options);
+
+	/**
+	 * @brief run Perform all measurements
+	 * @return The percentiles of all measurements per variant
+	 */
+	QJsonObject run();
+
+private:
+
+	//! The recorded times of each milestone in milliseconds, keyed by milestone name
+	typedef QMap<QString, QVector<qint64>> Samples;
+
+	/**
+	 * @brief measureVariant Perform the measurements for a single stream variant
+	 * @param variant The variant
+	 * @return The recorded samples, the startup samples are prefixed with "startup-"
+	 */
+	Samples measureVariant(const QString &variant);
+
+	/**
+	 * @brief measure Record the milestones of a single station start
+	 * @param gui The gui under test
+	 * @param clock Started when the station start was requested
+	 * @param start Performs the switch, nullptr if playback was started during construction of the gui
+	 * @param prefix Prepended to the milestone names
+	 * @param samples Where to record the times, milestones not reached in time are counted as "<name>-missing"
+	 */
+	void measure(RadioGui* gui, const QElapsedTimer &clock, const std::function<void()> &start, const QString &prefix,
+							 Samples &samples);
+
+	/**
+	 * @brief writeStations Create a stations file for a variant
+	 * @param variant The variant
+	 * @param path Where to write the file
+	 * @return True if the file was written
+	 */
+	bool writeStations(const QString &variant, const QString &path) const;
+
+	/**
+	 * @brief summarize Calculate the percentiles of a set of samples
+	 * @param samples The samples
+	 * @return The count, minimum, maximum and the 50th, 90th and 99th percentile
+	 */
+	static QJsonObject summarize(QVector<qint64> samples);
+
+	/**
+	 * @brief m_Options The configuration
+	 */
+	const Options m_Options;
+
+	/**
+	 * @brief m_Server Serves the synthetic streams
+	 */
+	StreamServer m_Server;
+};
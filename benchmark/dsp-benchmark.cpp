@@ -0,0 +1,159 @@
+#include "AudioKernels.h"
+
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QVector>
+
+namespace
+{
+
+//the frames per measured call, about 93 ms at 44.1 kHz
+const int ciFrames = 4096;
+
+//the number of samples per spectrum, as used by the analyzer
+const int ciSpectrumSize = 512;
+
+//the sample rate the load is computed for
+const int ciSampleRate = 44100;
+
+//the number of channels the load is computed for
+const int ciChannels = 2;
+
+//the number of spectra per second, as computed by the analyzer
+const int ciSpectraPerSecond = 30;
+
+/**
+ * @brief Measure Time a kernel
+ * @param rounds The number of rounds, the fastest one counts
+ * @param calls The number of calls per round
+ * @param kernel The kernel
+ * @return The time per call in nanoseconds
+ */
+double Measure(int rounds, int calls, const std::function<void()> &kernel)
+{
+	auto fastest = std::numeric_limits<double>::max();
+
+	for(auto round = 0; round < rounds; ++round)
+	{
+		QElapsedTimer clock;
+		clock.start();
+
+		for(auto call = 0; call < calls; ++call) kernel();
+
+		fastest = qMin(fastest, static_cast<double>(clock.nsecsElapsed()) / calls);
+	}
+
+	return fastest;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	QCommandLineOption optRounds(QStringList() << "rounds", "Time each kernel <count> times, the fastest round counts.",
+															 "count", "20");
+	QCommandLineOption optBudget(QStringList() << "budget", "Fail if the analysis needs more than <percent> of one core.",
+															 "percent", "3");
+	QCommandLineOption optOutput(QStringList() << "o" << "output", "Write the results to <file> instead of stdout.",
+															 "file");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Times the scalar and the vectorized sample kernels of the level meter.");
+	parser.addOption(optRounds);
+	parser.addOption(optBudget);
+	parser.addOption(optOutput);
+	parser.addHelpOption();
+
+	parser.process(QCoreApplication::arguments());
+
+	const auto rounds = qMax(1, parser.value(optRounds).toInt());
+	const auto budget = parser.value(optBudget).toDouble();
+
+	//a loud two tone signal, the content does not change the timing
+	QVector<qint16> input(ciFrames * ciChannels);
+	for(auto i = 0; i < ciFrames; ++i)
+	{
+		const auto t = static_cast<double>(i) / ciSampleRate;
+		input[i * ciChannels] = static_cast<qint16>(16000.0 * std::sin(2.0 * 3.14159265 * 440.0 * t));
+		input[i * ciChannels + 1] = static_cast<qint16>(16000.0 * std::sin(2.0 * 3.14159265 * 3000.0 * t));
+	}
+
+	QVector<float> mono(ciFrames);
+	QVector<float> power(ciSpectrumSize / 2);
+	Spectrum spectrum(ciSpectrumSize);
+
+	//keeps the compiler from dropping the results
+	volatile float sink = 0.0f;
+
+	QJsonObject kernels;
+	QJsonObject load;
+
+	for(const auto vectorized : {false, true})
+	{
+		const auto key = (true == vectorized) ? QStringLiteral("vectorized") : QStringLiteral("scalar");
+
+		const auto mixDown = Measure(rounds, 100, [&]()
+		{
+			AudioKernels::mixDown(input.constData(), ciChannels, ciFrames, mono.data(), vectorized);
+			sink = sink + mono.at(ciFrames / 2);
+		}) / ciFrames;
+
+		const auto levels = Measure(rounds, 100, [&]()
+		{
+			auto sumOfSquares = 0.0f;
+			auto peak = 0.0f;
+			AudioKernels::levels(mono.constData(), ciFrames, sumOfSquares, peak, vectorized);
+			sink = sink + sumOfSquares + peak;
+		}) / ciFrames;
+
+		const auto fft = Measure(rounds, 100, [&]()
+		{
+			spectrum.power(mono.constData(), power.data(), vectorized);
+			sink = sink + power.at(10);
+		});
+
+		QJsonObject times;
+		times.insert("mix-down-ns-per-frame", mixDown);
+		times.insert("levels-ns-per-sample", levels);
+		times.insert("spectrum-ns", fft);
+		kernels.insert(key, times);
+
+		//the analyzer runs each kernel once per second of audio, apart from the spectra
+		const auto perSecond = (mixDown + levels) * ciSampleRate + fft * ciSpectraPerSecond;
+		load.insert(key, perSecond / 1.0e9 * 100.0);
+	}
+
+	QJsonObject json;
+	json.insert("instruction-set", QString(AudioKernels::instructionSet()));
+	json.insert("kernels", kernels);
+	json.insert("load-percent", load);
+	json.insert("budget-percent", budget);
+
+	const auto output = QJsonDocument(json).toJson();
+
+	if(true == parser.isSet(optOutput))
+	{
+		QFile f(parser.value(optOutput));
+		if(false == f.open(QFile::WriteOnly)) return 1;
+
+		f.write(output);
+	}
+	else
+	{
+		QTextStream(stdout) << output;
+	}
+
+	return (load.value("vectorized").toDouble() <= budget) ? 0 : 1;
+}
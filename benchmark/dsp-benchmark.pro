@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Measures the sample kernels of the level meter
+#
+#-------------------------------------------------
+
+QT += core
+QT -= gui
+
+CONFIG += c++11 console
+
+INCLUDEPATH *= ..
+
+TARGET = dsp-benchmark
+TEMPLATE = app
+
+include(benchmark.pri)
+
+SOURCES *= \
+	dsp-benchmark.cpp \
+	../AudioKernels.cpp
+
+HEADERS *= \
+	../AudioKernels.h
@@ -0,0 +1,104 @@
+#include "MicroBenchmark.h"
+
+#include <QApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QtTest>
+
+namespace
+{
+
+/**
+ * @brief CsvToJson Convert the CSV results of QtTest into JSON
+ * @param csv The results as written by the csv logger, one "function","tag","metric",value,total,iterations line per
+ * benchmark
+ * @return The results and when they were measured
+ */
+QJsonObject CsvToJson(const QByteArray &csv)
+{
+	QJsonArray results;
+
+	for(const auto &line : csv.split('\n'))
+	{
+		//the quoted fields contain no commas, the tags are chosen that way
+		const auto fields = QString::fromUtf8(line).split(QLatin1Char(','));
+		if(6 != fields.size()) continue;
+
+		auto unquote = [](QString field) { return field.remove(QLatin1Char('"')); };
+
+		QJsonObject result;
+		result.insert("function", unquote(fields.at(0)));
+		result.insert("tag", unquote(fields.at(1)));
+		result.insert("metric", unquote(fields.at(2)));
+		result.insert("value", fields.at(3).toDouble());
+		result.insert("total", fields.at(4).toDouble());
+		result.insert("iterations", fields.at(5).toInt());
+
+		results.append(result);
+	}
+
+	QJsonObject json;
+	json.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+	json.insert("qt", QString::fromLatin1(qVersion()));
+	json.insert("results", results);
+
+	return json;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+int main(int argc, char *argv[])
+{
+	//no display is needed, unless a platform is requested explicitly
+	if(false == qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+	{
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+
+	QApplication a(argc, argv);
+
+	//everything but --json <file> is passed on to QtTest, e.g. -o results.csv,csv or a list of functions to run
+	auto arguments = QCoreApplication::arguments();
+
+	const auto json = arguments.indexOf("--json");
+	QString jsonFile;
+	if((0 < json) && ((json + 1) < arguments.size()))
+	{
+		jsonFile = arguments.at(json + 1);
+		arguments.erase(arguments.begin() + json, arguments.begin() + json + 2);
+	}
+
+	QTemporaryDir directory;
+	const auto csvFile = directory.filePath("results.csv");
+
+	if(false == jsonFile.isEmpty())
+	{
+		//the results are still printed, one -o replaces the default output
+		if(false == arguments.contains("-o")) arguments << "-o" << "-,txt";
+		arguments << "-o" << QString("%1,csv").arg(csvFile);
+	}
+
+	MicroBenchmark benchmark;
+	const auto result = QTest::qExec(&benchmark, arguments);
+
+	if(false == jsonFile.isEmpty())
+	{
+		QFile csv(csvFile);
+		QFile f(jsonFile);
+		if((false == csv.open(QFile::ReadOnly)) || (false == f.open(QFile::WriteOnly)))
+		{
+			QTextStream(stderr) << "Cannot write " << jsonFile << endl;
+			return 1;
+		}
+
+		f.write(QJsonDocument(CsvToJson(csv.readAll())).toJson());
+	}
+
+	return result;
+}
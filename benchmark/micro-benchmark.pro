@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Times the catalog, logo, text fitting and download paths of radio-ui with QBENCHMARK
+#
+#-------------------------------------------------
+
+include(../radio-ui.pri)
+
+QT += testlib
+
+CONFIG += console
+
+TARGET = micro-benchmark
+TEMPLATE = app
+
+include(benchmark.pri)
+
+SOURCES *= \
+	micro-benchmark.cpp \
+	LogoServer.cpp \
+	MicroBenchmark.cpp
+
+HEADERS *= \
+	LogoServer.h \
+	MicroBenchmark.h
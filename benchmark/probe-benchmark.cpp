@@ -0,0 +1,146 @@
+#include "StationProber.h"
+#include "StreamServer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+
+namespace
+{
+
+/**
+ * @brief Summarize Reduce samples to their percentiles
+ * @param samples The samples in milliseconds
+ * @return The minimum, p50, p90, p99 and maximum
+ */
+QJsonObject Summarize(QVector<qint64> samples)
+{
+	QJsonObject summary;
+	summary.insert("count", samples.size());
+
+	if(true == samples.isEmpty()) return summary;
+
+	std::sort(samples.begin(), samples.end());
+
+	//nearest rank percentile
+	auto percentile = [&](double p)
+	{
+		const auto rank = qMax(1, static_cast<int>(std::ceil(p / 100.0 * samples.size())));
+		return static_cast<double>(samples.at(rank - 1));
+	};
+
+	summary.insert("min", static_cast<double>(samples.first()));
+	summary.insert("p50", percentile(50));
+	summary.insert("p90", percentile(90));
+	summary.insert("p99", percentile(99));
+	summary.insert("max", static_cast<double>(samples.last()));
+
+	return summary;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	QCommandLineOption optStations(QStringList() << "n" << "stations", "Probe <count> stations per stream variant.",
+																 "count", "10");
+	QCommandLineOption optRounds(QStringList() << "rounds", "Probe all stations <count> times.", "count", "3");
+	QCommandLineOption optConcurrency(QStringList() << "concurrency", "Run up to <count> probes at once.", "count", "4");
+	QCommandLineOption optOutput(QStringList() << "o" << "output", "Write the results to <file> instead of stdout.",
+															 "file");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Probes the streams of a local stand-in server and checks the verdicts.");
+	parser.addOption(optStations);
+	parser.addOption(optRounds);
+	parser.addOption(optConcurrency);
+	parser.addOption(optOutput);
+	parser.addHelpOption();
+
+	parser.process(QCoreApplication::arguments());
+
+	StreamServer server;
+	if(false == server.listen())
+	{
+		QTextStream(stderr) << "Cannot start the stream server" << endl;
+		return 1;
+	}
+
+	//the answering streams must be alive, an unknown path and a closed port must be dead
+	QMap<QString, bool> expected;
+	for(auto i = 0; i < parser.value(optStations).toInt(); ++i)
+	{
+		for(const auto &variant : {"steady", "throttled", "jittery"}) expected.insert(server.url(variant, i), true);
+
+		expected.insert(server.url("missing", i), false);
+	}
+	expected.insert(QStringLiteral("http://127.0.0.1:1/closed"), false);
+
+	//the results of the radio are not touched
+	QTemporaryDir directory;
+	StationProber prober(directory.filePath("station-health.json"));
+	prober.setConcurrency(parser.value(optConcurrency).toInt());
+
+	QMap<QString, QVector<qint64>> samples;
+	QStringList mismatches;
+
+	for(auto round = 0; round < parser.value(optRounds).toInt(); ++round)
+	{
+		QEventLoop loop;
+		QObject::connect(&prober, &StationProber::finished, &loop, &QEventLoop::quit);
+
+		prober.probe(expected.keys());
+		if(false == prober.isIdle()) loop.exec();
+
+		for(auto it = expected.cbegin(); it != expected.cend(); ++it)
+		{
+			const auto result = prober.result(it.key());
+
+			if(it.value() != result.isAlive())
+			{
+				mismatches << QString("%1: %2 %3").arg(it.key()).arg(result.m_iStatus).arg(result.m_strError);
+			}
+
+			if(false == result.isAlive()) continue;
+
+			samples["lookup"] << result.m_iLookupTime;
+			samples["connect"] << result.m_iConnectTime;
+			samples["first-byte"] << result.m_iFirstByteTime;
+			samples["latency"] << result.latency();
+		}
+	}
+
+	QJsonObject json;
+	for(auto it = samples.cbegin(); it != samples.cend(); ++it) json.insert(it.key(), Summarize(it.value()));
+	json.insert("mismatches", QJsonArray::fromStringList(mismatches));
+
+	const auto output = QJsonDocument(json).toJson();
+
+	if(true == parser.isSet(optOutput))
+	{
+		QFile f(parser.value(optOutput));
+		if(false == f.open(QFile::WriteOnly)) return 1;
+
+		f.write(output);
+	}
+	else
+	{
+		QTextStream(stdout) << output;
+	}
+
+	return (true == mismatches.isEmpty()) ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Measures the station prober against a local stream server
+#
+#-------------------------------------------------
+
+include(../radio-ui.pri)
+
+CONFIG += console
+
+TARGET = probe-benchmark
+TEMPLATE = app
+
+include(benchmark.pri)
+
+SOURCES *= \
+	probe-benchmark.cpp \
+	StreamServer.cpp
+
+HEADERS *= \
+	StreamServer.h
@@ -0,0 +1,61 @@
+#include "ZapBenchmark.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+	//no display is needed, unless a platform is requested explicitly
+	if(false == qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+	{
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+
+	QApplication a(argc, argv);
+
+	QCommandLineOption optSwitches(QStringList() << "n" << "switches", "Measure <count> station switches per variant.",
+																 "count", "20");
+	QCommandLineOption optVariants(QStringList() << "variants", "Comma separated stream variants to measure.",
+																 "variants", "steady,throttled,jittery");
+	QCommandLineOption optStandbyPlayers(QStringList() << "z" << "standby-players",
+																			 "Measure with <count> standby players.", "count", "0");
+	QCommandLineOption optTimeout(QStringList() << "timeout", "Wait at most <ms> for each milestone.", "ms", "10000");
+	QCommandLineOption optOutput(QStringList() << "o" << "output", "Write the results to <file> instead of stdout.",
+															 "file");
+
+	QCommandLineParser parser;
+	parser.addOption(optSwitches);
+	parser.addOption(optVariants);
+	parser.addOption(optStandbyPlayers);
+	parser.addOption(optTimeout);
+	parser.addOption(optOutput);
+	parser.addHelpOption();
+
+	parser.process(QCoreApplication::arguments());
+
+	ZapBenchmark::Options options;
+	options.m_Variants = parser.value(optVariants).split(',', QString::SkipEmptyParts);
+	options.m_iSwitches = parser.value(optSwitches).toInt();
+	options.m_iStandbyPlayers = parser.value(optStandbyPlayers).toInt();
+	options.m_iTimeout = parser.value(optTimeout).toInt();
+
+	ZapBenchmark benchmark(options);
+	const auto result = QJsonDocument(benchmark.run()).toJson();
+
+	if(true == parser.isSet(optOutput))
+	{
+		QFile f(parser.value(optOutput));
+		if(false == f.open(QFile::WriteOnly)) return 1;
+
+		f.write(result);
+	}
+	else
+	{
+		QTextStream(stdout) << result;
+	}
+
+	return 0;
+}
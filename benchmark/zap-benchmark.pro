@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Measures station switching and startup latency of radio-ui
+#
+#-------------------------------------------------
+
+include(../radio-ui.pri)
+
+CONFIG += console
+
+TARGET = zap-benchmark
+TEMPLATE = app
+
+include(benchmark.pri)
+
+SOURCES *= \
+	zap-benchmark.cpp \
+	StreamServer.cpp \
+	ZapBenchmark.cpp
+
+HEADERS *= \
+	StreamServer.h \
+	ZapBenchmark.h
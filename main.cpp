@@ -1,18 +1,70 @@
+#include "ControlServer.h"
+#include "PlaybackCore.h"
 #include "RadioGui.h"
+#include "StallWatchdog.h"
+#include "Tracer.h"
+
+#include <memory>
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QTextStream>
 
 int main(int argc, char *argv[])
 {
-	QApplication a(argc, argv);
+	//without a display no gui application may be created, so this option is looked at before the command line is parsed
+	auto headless = false;
+	for(auto i = 1; i < argc; ++i) headless |= (0 == qstrcmp(argv[i], "--headless"));
+
+	std::unique_ptr<QCoreApplication> a;
+	if(true == headless) a.reset(new WatchedApplication<QCoreApplication>(argc, argv));
+	else a.reset(new WatchedApplication<QApplication>(argc, argv));
 
 	QCommandLineOption optStations(QStringList() << "s" << "stations-file", "Read stations from file <file>.", "file");
 	QCommandLineOption optCursor(QStringList() << "c" << "cursor", "Display the cursor and do not hide it");
+	QCommandLineOption optStandbyPlayers(QStringList() << "z" << "standby-players",
+																			 "Keep up to <count> muted players connected to the likely next stations.", "count", "0");
+	QCommandLineOption optStandbyMemory(QStringList() << "standby-memory",
+																			"Limit the standby players to about <MiB> of memory.", "MiB", "0");
+	QCommandLineOption optLogoMemory(QStringList() << "logo-memory",
+																	 "Keep at most <MiB> of station logos in memory, 0 for no limit.", "MiB");
+	QCommandLineOption optStreamBuffer(QStringList() << "stream-buffer",
+																		 "Buffer <ms> of audio and reconnect broken streams transparently, 0 to disable.", "ms",
+																		 "2000");
+	QCommandLineOption optTimeShift(QStringList() << "time-shift",
+																	"Keep receiving up to <minutes> of a paused stream, 0 to stop it instead.", "minutes", "30");
+	QCommandLineOption optTimeShiftSize(QStringList() << "time-shift-size",
+																			"Limit the time shift file to <MiB>.", "MiB", "64");
+	QCommandLineOption optNoLevelMeter(QStringList() << "no-level-meter",
+																		 "Do not show the level meter and do not analyze the decoded audio.");
+	QCommandLineOption optIdleTimeout(QStringList() << "idle-timeout",
+																		"Stop updating the gui after <seconds> without input, 0 to never.", "seconds", "0");
+	QCommandLineOption optIdleFile(QStringList() << "idle-file", "Stop updating the gui while <file> exists.", "file");
+	QCommandLineOption optHeadless(QStringList() << "headless",
+																 "Play without a gui, controlled through the control socket only.");
+	QCommandLineOption optControlSocket(QStringList() << "control-socket",
+																			"Accept control commands on the local socket <path>, radio-ui.socket in the "
+																			"temporary folder if headless.", "path");
+	QCommandLineOption optStallThreshold(QStringList() << "stall-threshold",
+																			 "Report event deliveries taking longer than <ms>, 0 to disable.", "ms", "250");
+	QCommandLineOption optTrace(QStringList() << "trace", "Write a Chrome trace of the session to <file> on exit.", "file");
 
 	QCommandLineParser parser;
 	parser.addOption(optStations);
 	parser.addOption(optCursor);
+	parser.addOption(optStandbyPlayers);
+	parser.addOption(optStandbyMemory);
+	parser.addOption(optLogoMemory);
+	parser.addOption(optStreamBuffer);
+	parser.addOption(optTimeShift);
+	parser.addOption(optTimeShiftSize);
+	parser.addOption(optNoLevelMeter);
+	parser.addOption(optIdleTimeout);
+	parser.addOption(optIdleFile);
+	parser.addOption(optHeadless);
+	parser.addOption(optControlSocket);
+	parser.addOption(optStallThreshold);
+	parser.addOption(optTrace);
 	parser.addHelpOption();
 
 	parser.process(QCoreApplication::arguments());
@@ -23,13 +75,91 @@ int main(int argc, char *argv[])
 		stationsFileName = parser.value(optStations);
 	}
 
-	if(false == parser.isSet(optCursor))
+	if(true == parser.isSet(optTrace))
 	{
-		QApplication::setOverrideCursor(Qt::BlankCursor);
+		Tracer::start(parser.value(optTrace));
+	}
+
+	//a threshold of 0 is rejected, so it disables the watchdog
+	StallWatchdog::start(parser.value(optStallThreshold).toInt());
+
+	const auto streamBuffer = parser.value(optStreamBuffer).toInt();
+	const auto timeShift = parser.value(optTimeShift).toInt() * 60;
+	const auto timeShiftSize = parser.value(optTimeShiftSize).toLongLong() * 1024 * 1024;
+	const auto standbyPlayers = parser.value(optStandbyPlayers).toInt();
+	const auto standbyMemory = parser.value(optStandbyMemory).toLongLong() * 1024 * 1024;
+
+	//the gui and the control socket are both clients of the same playback core
+	std::unique_ptr<PlaybackCore> core;
+	std::unique_ptr<RadioGui> w;
+
+	if(true == headless)
+	{
+		core.reset(new PlaybackCore(stationsFileName));
+		core->setStreamBuffer(streamBuffer);
+		core->setTimeShift(timeShift, timeShiftSize);
+		core->setStandbyPlayers(standbyPlayers, standbyMemory);
+		core->start();
+	}
+	else
+	{
+		if(false == parser.isSet(optCursor))
+		{
+			QApplication::setOverrideCursor(Qt::BlankCursor);
+		}
+
+		w.reset(new RadioGui(stationsFileName));
+		w->setStreamBuffer(streamBuffer);
+		w->setTimeShift(timeShift, timeShiftSize);
+		w->setStandbyPlayers(standbyPlayers, standbyMemory);
+		w->setLevelMeter(false == parser.isSet(optNoLevelMeter));
+		w->setIdleTimeout(parser.value(optIdleTimeout).toInt());
+		w->setIdleFile(parser.value(optIdleFile));
+
+		if(true == parser.isSet(optLogoMemory))
+		{
+			w->setLogoMemoryBudget(parser.value(optLogoMemory).toLongLong() * 1024 * 1024);
+		}
+
+		//like the headless core, the gui starts playing only after it was configured
+		w->start();
 	}
 
-	RadioGui w(stationsFileName);
-	w.show();
+	auto &playback = (true == headless) ? *core : w->core();
+
+	std::unique_ptr<ControlServer> server;
+	if((true == headless) || (true == parser.isSet(optControlSocket)))
+	{
+		const auto socket = (true == parser.isSet(optControlSocket)) ? parser.value(optControlSocket) :
+																																		QString("radio-ui.socket");
+
+		server.reset(new ControlServer(playback));
+		if(false == server->listen(socket))
+		{
+			QTextStream(stderr) << "Cannot listen on " << socket << ": " << server->errorString() << endl;
+			return 1;
+		}
+	}
+
+	if(true == headless)
+	{
+		//play first station, the gui does this itself on startup
+		if(0 < playback.stations().rowCount()) playback.play(playback.stations().id(0));
+	}
+	else
+	{
+		w->show();
+	}
+
+	const auto result = a->exec();
+
+	//the clients go first, they hold on to the core
+	server.reset();
+	w.reset();
+	core.reset();
+
+	StallWatchdog::stop();
+	Tracer::stop();
 
-	return a.exec();
+	return result;
 }
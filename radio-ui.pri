@@ -0,0 +1,75 @@
+# The radio-ui sources shared by the application and the benchmarks
+
+QT += core gui multimedia network svg
+
+CONFIG += c++11
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+INCLUDEPATH *= $$PWD
+
+SOURCES *= \
+	$$PWD/RadioGui.cpp \
+	$$PWD/AudioAnalyzer.cpp \
+	$$PWD/AudioKernels.cpp \
+	$$PWD/ControlServer.cpp \
+	$$PWD/IcyDemuxer.cpp \
+	$$PWD/LevelMeter.cpp \
+	$$PWD/LogoCache.cpp \
+	$$PWD/LogoDecoder.cpp \
+	$$PWD/LogoDownloader.cpp \
+	$$PWD/LogoScaler.cpp \
+	$$PWD/PlaybackCore.cpp \
+	$$PWD/RingBuffer.cpp \
+	$$PWD/StallWatchdog.cpp \
+	$$PWD/StandbyPlayers.cpp \
+	$$PWD/StationCatalog.cpp \
+	$$PWD/StationModel.cpp \
+	$$PWD/StationProber.cpp \
+	$$PWD/StationReader.cpp \
+	$$PWD/StationRegistry.cpp \
+	$$PWD/StationSearch.cpp \
+	$$PWD/StationTile.cpp \
+	$$PWD/StreamConnection.cpp \
+	$$PWD/StreamReader.cpp \
+	$$PWD/TextFitter.cpp \
+	$$PWD/TimeShiftFile.cpp \
+	$$PWD/Tracer.cpp \
+	$$PWD/WakeupCounter.cpp
+
+HEADERS *= \
+	$$PWD/RadioGui.h \
+	$$PWD/AudioAnalyzer.h \
+	$$PWD/AudioKernels.h \
+	$$PWD/ControlServer.h \
+	$$PWD/IcyDemuxer.h \
+	$$PWD/LevelMeter.h \
+	$$PWD/LogoCache.h \
+	$$PWD/LogoDecoder.h \
+	$$PWD/LogoDownloader.h \
+	$$PWD/LogoScaler.h \
+	$$PWD/PlaybackCore.h \
+	$$PWD/PoolTask.h \
+	$$PWD/RingBuffer.h \
+	$$PWD/StallWatchdog.h \
+	$$PWD/StandbyPlayers.h \
+	$$PWD/StationCatalog.h \
+	$$PWD/StationInformation.h \
+	$$PWD/StationModel.h \
+	$$PWD/StationProber.h \
+	$$PWD/StationReader.h \
+	$$PWD/StationRegistry.h \
+	$$PWD/StationSearch.h \
+	$$PWD/StationTile.h \
+	$$PWD/StreamConnection.h \
+	$$PWD/StreamReader.h \
+	$$PWD/TextFitter.h \
+	$$PWD/TimeShiftFile.h \
+	$$PWD/Tracer.h \
+	$$PWD/WakeupCounter.h
+
+FORMS *= \
+	$$PWD/RadioGui.ui
+
+RESOURCES *= \
+	$$PWD/RadioGui.qrc
@@ -4,26 +4,31 @@
 #
 #-------------------------------------------------
 
-QT += core gui multimedia svg
-
-CONFIG += c++11
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-TARGET = radio-ui
-TEMPLATE = app
-
-SOURCES *= \
-	main.cpp \
-	RadioGui.cpp \
-	LogoDownloader.cpp
-
-HEADERS *= \
-	RadioGui.h \
-	LogoDownloader.h
-
-FORMS *= \
-	RadioGui.ui
-
-RESOURCES *= \
-	RadioGui.qrc
+# The application, the catalog compiler it compiles stations.json with, the benchmarks and the tests. Each can also
+# be built on its own from its folder.
+TEMPLATE = subdirs
+
+SUBDIRS = \
+	catalog_compiler \
+	app \
+	zap_benchmark \
+	probe_benchmark \
+	dsp_benchmark \
+	micro_benchmark \
+	icy_test \
+	stream_test
+
+catalog_compiler.subdir = tools/catalog-compiler
+
+app.subdir = app
+app.depends = catalog_compiler
+
+# the benchmarks share their folder, each keeps its intermediate files apart, see benchmark.pri
+zap_benchmark.file = benchmark/zap-benchmark.pro
+probe_benchmark.file = benchmark/probe-benchmark.pro
+dsp_benchmark.file = benchmark/dsp-benchmark.pro
+micro_benchmark.file = benchmark/micro-benchmark.pro
+
+# the tests share their folder as well, see tests.pri
+icy_test.file = tests/icy-test.pro
+stream_test.file = tests/stream-test.pro
@@ -0,0 +1,231 @@
+#include "IcyTest.h"
+
+#include "IcyDemuxer.h"
+#include "StreamReader.h"
+#include "StreamServer.h"
+
+#include <QStringList>
+#include <QUrl>
+#include <QtTest>
+
+namespace
+{
+
+//the number of audio bytes between two metadata blocks of the synthetic streams
+const int ciInterval = 16;
+
+//the jitter buffer of the stream reader, in milliseconds
+const int ciJitterBuffer = 500;
+
+//the longest time to wait for the metadata of the stream server, in milliseconds
+const int ciStreamTimeout = 10000;
+
+/**
+ * @brief Block Build a metadata block as sent by an ICY server
+ * @param text The metadata
+ * @return The block including its length byte, padded with zeros to a multiple of 16 bytes
+ */
+QByteArray Block(const QByteArray &text)
+{
+	const auto units = (text.size() + 15) / 16;
+	return QByteArray(1, static_cast<char>(units)) + text.leftJustified(units * 16, '\0');
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Audio Build a span of audio data
+ * @param c The byte the span is filled with, so misplaced spans are noticed
+ * @param size The size of the span in bytes
+ * @return The span
+ */
+QByteArray Audio(char c, int size = ciInterval)
+{
+	return QByteArray(size, c);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Demux Feed a stream to a demuxer in chunks
+ * @param stream The stream
+ * @param interval The number of audio bytes between two metadata blocks
+ * @param chunkSize The size of the chunks
+ * @param titles Receives the titles of the metadata blocks which are reported, nullptr if not needed
+ * @param blocks Receives the number of metadata blocks which are reported, nullptr if not needed
+ * @return The audio data passed on
+ */
+QByteArray Demux(const QByteArray &stream, int interval, int chunkSize, QStringList* titles, int* blocks = nullptr)
+{
+	IcyDemuxer demuxer;
+	demuxer.reset(interval);
+
+	QByteArray audio;
+	for(auto offset = 0; offset < stream.size(); offset += chunkSize)
+	{
+		demuxer.feed(stream.constData() + offset, qMin(chunkSize, stream.size() - offset),
+								 [&](const char* data, qint64 length) { audio.append(data, static_cast<int>(length)); },
+								 [&](QVariantMap metadata)
+		{
+			if(nullptr != titles) *titles << metadata.value("title").toString();
+			if(nullptr != blocks) ++*blocks;
+		});
+	}
+
+	return audio;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+}
+
+IcyTest::IcyTest(QObject* parent)
+	: QObject(parent)
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::feedSplit_data()
+{
+	QTest::addColumn<int>("chunkSize");
+
+	//single bytes split every length byte off its block, 17 and 23 bytes move the splits through the blocks
+	for(const auto chunkSize : {1, 2, 7, 16, 17, 23, 1024}) QTest::newRow(QByteArray::number(chunkSize)) << chunkSize;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::feedSplit()
+{
+	QFETCH(int, chunkSize);
+
+	const auto stream = Audio('a') + Block("StreamTitle='First';") +
+											Audio('b') + QByteArray(1, '\0') +
+											Audio('c') + Block("StreamTitle='Artist - Second';StreamUrl='';") +
+											Audio('d', 5);
+
+	QStringList titles;
+	const auto audio = Demux(stream, ciInterval, chunkSize, &titles);
+
+	QCOMPARE(audio, Audio('a') + Audio('b') + Audio('c') + Audio('d', 5));
+	QCOMPARE(titles, QStringList() << "First" << "Artist - Second");
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::feedEmptyBlocks()
+{
+	//a zero length byte, a block of padding only and a block without any key
+	const auto stream = Audio('a') + QByteArray(1, '\0') +
+											Audio('b') + QByteArray(1, '\1') + QByteArray(16, '\0') +
+											Audio('c') + Block("nothing here") +
+											Audio('d') + QByteArray(1, '\0');
+
+	for(const auto chunkSize : {1, stream.size()})
+	{
+		auto blocks = 0;
+		const auto audio = Demux(stream, ciInterval, chunkSize, nullptr, &blocks);
+
+		QCOMPARE(audio, Audio('a') + Audio('b') + Audio('c') + Audio('d'));
+		QCOMPARE(blocks, 0);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::feedWithoutInterval()
+{
+	//without an interval, bytes which would be length bytes are audio as well
+	const auto stream = Audio('a') + Block("StreamTitle='Not Metadata';");
+
+	QStringList titles;
+	QCOMPARE(Demux(stream, 0, 7, &titles), stream);
+	QVERIFY(true == titles.isEmpty());
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::decode_data()
+{
+	QTest::addColumn<QByteArray>("text");
+	QTest::addColumn<QString>("title");
+
+	const auto accented = QString::fromUtf8("Sigur Rós - Hoppípolla");
+	const auto cyrillic = QString::fromUtf8("Пётр Ильич Чайковский - Щелкунчик");
+
+	QTest::newRow("ascii") << QByteArray("Adele - Hello") << QString("Adele - Hello");
+	QTest::newRow("utf-8") << accented.toUtf8() << accented;
+	QTest::newRow("latin-1") << accented.toLatin1() << accented;
+	QTest::newRow("utf-8 cyrillic") << cyrillic.toUtf8() << cyrillic;
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::decode()
+{
+	QFETCH(QByteArray, text);
+	QFETCH(QString, title);
+
+	QCOMPARE(IcyDemuxer::decode(text), title);
+
+	QStringList titles;
+	Demux(Audio('a') + Block("StreamTitle='" + text + "';"), ciInterval, 3, &titles);
+	QCOMPARE(titles, QStringList() << title);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::parseMetadata_data()
+{
+	QTest::addColumn<QByteArray>("block");
+	QTest::addColumn<QString>("title");
+
+	QTest::newRow("plain") << QByteArray("StreamTitle='Artist - Title';") << QString("Artist - Title");
+	QTest::newRow("quotes") << QByteArray("StreamTitle='Guns N' Roses - Sweet Child O' Mine';StreamUrl='';")
+													<< QString("Guns N' Roses - Sweet Child O' Mine");
+	QTest::newRow("semicolons") << QByteArray("StreamTitle='Tom; Jerry - Part 1;2';StreamUrl='http://example.com/';")
+															<< QString("Tom; Jerry - Part 1;2");
+	QTest::newRow("quote before semicolon") << QByteArray("StreamTitle='Rock 'n; Roll';")
+																					<< QString("Rock 'n; Roll");
+	QTest::newRow("padded") << QByteArray("StreamTitle='Artist - Title';").leftJustified(48, '\0')
+													<< QString("Artist - Title");
+	QTest::newRow("unterminated") << QByteArray("StreamTitle='Artist - Title'") << QString("Artist - Title");
+	QTest::newRow("url first") << QByteArray("StreamUrl='';StreamTitle='Artist - Title';") << QString("Artist - Title");
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::parseMetadata()
+{
+	QFETCH(QByteArray, block);
+	QFETCH(QString, title);
+
+	const auto metadata = IcyDemuxer::parseMetadata(block);
+
+	QCOMPARE(metadata.value("title").toString(), title);
+	QCOMPARE(metadata.value("streamtitle").toString(), title);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::parseHeader()
+{
+	QVariantMap metadata;
+	IcyDemuxer::parseHeader("icy-name", " Benchmark 7 ", metadata);
+	IcyDemuxer::parseHeader("ICY-Genre", "Jazz", metadata);
+	IcyDemuxer::parseHeader("Content-Type", "audio/mpeg", metadata);
+
+	QCOMPARE(metadata.value("publisher").toString(), QString("Benchmark 7"));
+	QCOMPARE(metadata.value("icy-name").toString(), QString("Benchmark 7"));
+	QCOMPARE(metadata.value("genre").toString(), QString("Jazz"));
+	QVERIFY(false == metadata.contains("content-type"));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void IcyTest::streamReader()
+{
+	StreamServer server;
+	QVERIFY(true == server.listen());
+
+	StreamReader reader(QUrl(server.url("steady", 7)), ciJitterBuffer);
+
+	//the metadata is published once the audio it was sent with is read, like a player would
+	connect(&reader, &StreamReader::readyRead, &reader, [&]() { reader.readAll(); });
+
+	QVERIFY(true == reader.open(QIODevice::ReadOnly));
+
+	QTRY_COMPARE_WITH_TIMEOUT(reader.metaData("title").toString(), QString("Benchmark 7 - Title 0"), ciStreamTimeout);
+	QCOMPARE(reader.metaData("publisher").toString(), QString("Benchmark 7"));
+
+	reader.close();
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QObject>
+
+/**
+ * @brief The IcyTest class checks the ICY metadata handling of radio-ui
+ *
+ * The IcyDemuxer is fed synthetic streams in chunks of various sizes, the StreamReader reads a stream of the local
+ * StreamServer of the benchmarks.
+ */
+class IcyTest : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief IcyTest Default constructor
+	 * @param parent
+	 */
+	explicit IcyTest(QObject* parent = nullptr);
+
+private slots:
+
+	/**
+	 * @brief feedSplit_data The chunk sizes the stream is fed in
+	 */
+	void feedSplit_data();
+
+	/**
+	 * @brief feedSplit Demux a stream whose metadata blocks and length bytes are split across chunks
+	 */
+	void feedSplit();
+
+	/**
+	 * @brief feedEmptyBlocks Demux a stream with zero-length and zero-padded metadata blocks
+	 */
+	void feedEmptyBlocks();
+
+	/**
+	 * @brief feedWithoutInterval Pass a stream without metadata on as it is
+	 */
+	void feedWithoutInterval();
+
+	/**
+	 * @brief decode_data Titles in UTF-8 and in Latin-1
+	 */
+	void decode_data();
+
+	/**
+	 * @brief decode Decode a title sent in either encoding
+	 */
+	void decode();
+
+	/**
+	 * @brief parseMetadata_data Metadata blocks and the titles they contain
+	 */
+	void parseMetadata_data();
+
+	/**
+	 * @brief parseMetadata Parse a metadata block
+	 */
+	void parseMetadata();
+
+	/**
+	 * @brief parseHeader Convert the response headers of an ICY server
+	 */
+	void parseHeader();
+
+	/**
+	 * @brief streamReader Read a stream of the StreamServer and check the published metadata
+	 */
+	void streamReader();
+};
@@ -0,0 +1,82 @@
+#include "StreamTest.h"
+
+#include "RingBuffer.h"
+#include "StreamConnection.h"
+
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrl>
+#include <QtTest>
+
+namespace
+{
+
+//the size of the ring buffer, far less than the server sends
+const qint64 ciBufferSize = 4096;
+
+//the stream data the server sends before it goes silent, in bytes
+const int ciStreamSize = 64 * 1024;
+
+//the stall timeout of the connection, in milliseconds
+const int ciStallTimeout = 200;
+
+//the longest time to wait for the connection, in milliseconds
+const int ciTimeout = 5000;
+
+}
+
+StreamTest::StreamTest(QObject* parent)
+	: QObject(parent)
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void StreamTest::stallAfterFullBuffer()
+{
+	//answers every request with a fixed amount of audio and then keeps the connection open without sending anything
+	QTcpServer server;
+	QVERIFY(true == server.listen(QHostAddress::LocalHost));
+
+	connect(&server, &QTcpServer::newConnection, &server, [&]()
+	{
+		while(true == server.hasPendingConnections())
+		{
+			const auto socket = server.nextPendingConnection();
+			socket->write("HTTP/1.0 200 OK\r\nContent-Type: audio/mpeg\r\n\r\n");
+			socket->write(QByteArray(ciStreamSize, '\0'));
+		}
+	});
+
+	RingBuffer buffer(ciBufferSize);
+	StreamConnection connection(QUrl(QString("http://127.0.0.1:%1/stream").arg(server.serverPort())), &buffer);
+	connection.setStallTimeout(ciStallTimeout);
+
+	QSignalSpy disconnected(&connection, &StreamConnection::disconnected);
+
+	connection.start();
+
+	//the connection stops reading once the ring buffer is full
+	QTRY_VERIFY_WITH_TIMEOUT(true == connection.isWaiting(), ciTimeout);
+	QCOMPARE(disconnected.count(), 0);
+
+	//the consumer reads everything the server sent, asking for more whenever it made room
+	char data[ciBufferSize];
+	qint64 drained = 0;
+	const auto drain = [&]()
+	{
+		drained += buffer.read(data, sizeof(data));
+		connection.drain();
+
+		return ciStreamSize == drained;
+	};
+
+	QTRY_VERIFY_WITH_TIMEOUT(true == drain(), ciTimeout);
+	QVERIFY(false == connection.isWaiting());
+
+	//the server is silent now, which must be taken for a broken connection
+	QTRY_VERIFY_WITH_TIMEOUT(0 < disconnected.count(), ciTimeout);
+
+	connection.stop();
+}
+//----------------------------------------------------------------------------------------------------------------------
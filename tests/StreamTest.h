@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QObject>
+
+/**
+ * @brief The StreamTest class checks how the StreamConnection copes with a full ring buffer and a silent server
+ */
+class StreamTest : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief StreamTest Default constructor
+	 * @param parent
+	 */
+	explicit StreamTest(QObject* parent = nullptr);
+
+private slots:
+
+	/**
+	 * @brief stallAfterFullBuffer Fill the ring buffer, drain it and let the server go silent, the stall must be noticed
+	 */
+	void stallAfterFullBuffer();
+};
@@ -0,0 +1,5 @@
+#include "IcyTest.h"
+
+#include <QtTest>
+
+QTEST_GUILESS_MAIN(IcyTest)
@@ -0,0 +1,27 @@
+#-------------------------------------------------
+#
+# Tests the ICY metadata demuxing and parsing of radio-ui, against synthetic streams and the local stream server
+#
+#-------------------------------------------------
+
+include(../radio-ui.pri)
+
+QT += testlib
+
+CONFIG += console testcase
+
+INCLUDEPATH *= ../benchmark
+
+TARGET = icy-test
+TEMPLATE = app
+
+include(tests.pri)
+
+SOURCES *= \
+	icy-test.cpp \
+	IcyTest.cpp \
+	../benchmark/StreamServer.cpp
+
+HEADERS *= \
+	IcyTest.h \
+	../benchmark/StreamServer.h
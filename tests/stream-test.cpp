@@ -0,0 +1,5 @@
+#include "StreamTest.h"
+
+#include <QtTest>
+
+QTEST_GUILESS_MAIN(StreamTest)
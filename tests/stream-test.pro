@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Tests the stall detection of the stream connection against a local server which goes silent
+#
+#-------------------------------------------------
+
+include(../radio-ui.pri)
+
+QT += testlib
+
+CONFIG += console testcase
+
+TARGET = stream-test
+TEMPLATE = app
+
+include(tests.pri)
+
+SOURCES *= \
+	stream-test.cpp \
+	StreamTest.cpp
+
+HEADERS *= \
+	StreamTest.h
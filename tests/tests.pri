@@ -0,0 +1,7 @@
+# The tests share this folder, so each keeps its intermediate files in a folder named after its target. Included after
+# TARGET is set.
+
+OBJECTS_DIR = .build/$$TARGET
+MOC_DIR = .build/$$TARGET
+RCC_DIR = .build/$$TARGET
+UI_DIR = .build/$$TARGET
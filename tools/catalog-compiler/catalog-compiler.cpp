@@ -0,0 +1,55 @@
+#include "StationCatalog.h"
+#include "StationReader.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	QCommandLineOption optLogoSize(QStringList() << "logo-size",
+																 "Downscale the logos to fit into <width>x<height> device pixels.", "size", "320x240");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Compiles a json stations file into a binary station catalog.");
+	parser.addOption(optLogoSize);
+	parser.addPositionalArgument("stations", "The json stations file to compile.");
+	parser.addPositionalArgument("catalog", "The catalog file to write.");
+	parser.addHelpOption();
+
+	parser.process(QCoreApplication::arguments());
+
+	const auto arguments = parser.positionalArguments();
+	if(2 != arguments.size()) parser.showHelp(1);
+
+	const auto size = parser.value(optLogoSize).split('x');
+	const auto logoSize = (2 == size.size()) ? QSize(size.at(0).toInt(), size.at(1).toInt()) : QSize();
+	if(false == logoSize.isValid()) parser.showHelp(1);
+
+	const auto stationsFile = QFileInfo(arguments.at(0)).absoluteFilePath();
+	const auto catalogFile = QFileInfo(arguments.at(1)).absoluteFilePath();
+
+	bool valid = false;
+	const auto stations = StationReader::readFile(stationsFile, &valid);
+	if(false == valid)
+	{
+		QTextStream(stderr) << "Cannot read " << stationsFile << ": not a valid stations file" << endl;
+		return 1;
+	}
+
+	//relative logo files are resolved like by a radio started next to its stations file
+	QDir::setCurrent(QFileInfo(stationsFile).absolutePath());
+
+	QString error;
+	if(false == StationCatalog::write(catalogFile, stations, StationCatalog::hash(stationsFile), logoSize, &error))
+	{
+		QTextStream(stderr) << "Cannot write " << catalogFile << ": " << error << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,28 @@
+#-------------------------------------------------
+#
+# Compiles a json stations file into a binary station catalog
+#
+#-------------------------------------------------
+
+QT += core gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+INCLUDEPATH *= $$PWD/../..
+
+TARGET = catalog-compiler
+TEMPLATE = app
+
+SOURCES *= \
+	catalog-compiler.cpp \
+	$$PWD/../../StationCatalog.cpp \
+	$$PWD/../../StationReader.cpp \
+	$$PWD/../../Tracer.cpp
+
+HEADERS *= \
+	$$PWD/../../PoolTask.h \
+	$$PWD/../../StationCatalog.h \
+	$$PWD/../../StationInformation.h \
+	$$PWD/../../StationReader.h \
+	$$PWD/../../Tracer.h